@@ -0,0 +1,154 @@
+// Channel scaling benchmark
+//
+// Runs PluginProcessor from stereo up to 64 channels (7th order ambisonics),
+// once with every channel group on the audio thread and once with the groups
+// spread over the worker threads, and prints the cost of each run as JSON
+//
+// usage: ChannelScalingBenchmark [--seconds=<audio seconds per run>] [--output=<file.json>]
+//
+// build with: cmake -DBUILD_BENCHMARKS=ON ...
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <iostream>
+#include <vector>
+
+#include <juce_audio_processors/juce_audio_processors.h>
+#include <juce_events/juce_events.h>
+
+#include "../src/parameters/StateManager.h"
+#include "../src/plugin/PluginProcessor.h"
+
+namespace {
+
+constexpr double SAMPLE_RATE = 48000.0;
+const std::vector<int> CHANNEL_COUNTS{2, 4, 8, 16, 32, 64};
+const std::vector<int> BLOCK_SIZES{64, 256, 1024};
+// values of the OVERSAMPLING property: 1x, and 4x for a heavier per-channel load
+const std::vector<int> OVERSAMPLING_STAGES{0, 2};
+
+constexpr int MIN_CALLBACKS = 200;
+constexpr int WARMUP_CALLBACKS = 32;
+
+struct Config {
+  int num_channels;
+  int block_size;
+  int oversampling_stages;
+  bool parallel;
+};
+
+struct Result {
+  juce::var json;
+  double mean_ns;
+};
+
+//==============================================================================
+Result run(PluginProcessor &processor, const Config &config, double seconds) {
+  // prepareToPlay picks up the factor from the state
+  processor.state->set_parameter(PARAM::OVERSAMPLING, float(config.oversampling_stages));
+  processor.parallel_channel_groups.store(config.parallel);
+  processor.setPlayConfigDetails(config.num_channels, config.num_channels, SAMPLE_RATE,
+                                 config.block_size);
+  processor.prepareToPlay(SAMPLE_RATE, config.block_size);
+  processor.reset();
+
+  juce::AudioBuffer<float> input(config.num_channels, config.block_size);
+  juce::Random noise(42);
+  for (int ch = 0; ch < config.num_channels; ++ch)
+    for (int i = 0; i < config.block_size; ++i)
+      input.setSample(ch, i, noise.nextFloat() * 2.0f - 1.0f);
+
+  juce::AudioBuffer<float> buffer(config.num_channels, config.block_size);
+  juce::MidiBuffer midi;
+
+  const int num_callbacks =
+      std::max(MIN_CALLBACKS, int(std::ceil(seconds * SAMPLE_RATE / config.block_size)));
+  std::vector<double> callback_ns;
+  callback_ns.reserve(size_t(num_callbacks));
+
+  using clock = std::chrono::steady_clock;
+  for (int callback = -WARMUP_CALLBACKS; callback < num_callbacks; ++callback) {
+    for (int ch = 0; ch < config.num_channels; ++ch)
+      buffer.copyFrom(ch, 0, input, ch, 0, config.block_size);
+
+    const auto start = clock::now();
+    processor.processBlock(buffer, midi);
+    const auto end = clock::now();
+
+    if (callback >= 0)
+      callback_ns.push_back(std::chrono::duration<double, std::nano>(end - start).count());
+  }
+  processor.releaseResources();
+
+  double total_ns = 0.0;
+  for (auto ns : callback_ns)
+    total_ns += ns;
+  const double mean_ns = total_ns / double(callback_ns.size());
+  const double max_ns = *std::max_element(callback_ns.begin(), callback_ns.end());
+  auto p99 = callback_ns.begin() + std::ptrdiff_t(double(callback_ns.size() - 1) * 0.99);
+  std::nth_element(callback_ns.begin(), p99, callback_ns.end());
+
+  auto *result = new juce::DynamicObject();
+  result->setProperty("channels", config.num_channels);
+  result->setProperty("block_size", config.block_size);
+  result->setProperty("oversampling", 1 << config.oversampling_stages);
+  result->setProperty("parallel", config.parallel);
+  result->setProperty("callbacks", num_callbacks);
+  // per sample, per channel
+  result->setProperty("ns_per_sample",
+                      total_ns / (double(num_callbacks) * config.block_size * config.num_channels));
+  result->setProperty("mean_ns", mean_ns);
+  result->setProperty("p99_ns", *p99);
+  result->setProperty("max_ns", max_ns);
+  result->setProperty("realtime_load", mean_ns * 1.0e-9 * SAMPLE_RATE / config.block_size);
+  return {juce::var(result), mean_ns};
+}
+
+} // namespace
+
+//==============================================================================
+int main(int argc, char *argv[]) {
+  juce::ArgumentList args(argc, argv);
+  const double seconds =
+      args.containsOption("--seconds") ? args.getValueForOption("--seconds").getDoubleValue() : 1.0;
+  const juce::String output_path = args.getValueForOption("--output");
+
+  // the processor expects a message manager, like it would have inside a host.
+  // this runs on the message thread, so the OVERSAMPLING property is set right away
+  juce::ScopedJuceInitialiser_GUI juce_initialiser;
+
+  juce::Array<juce::var> results;
+  {
+    PluginProcessor processor;
+    for (auto stages : OVERSAMPLING_STAGES)
+      for (auto block_size : BLOCK_SIZES)
+        for (auto num_channels : CHANNEL_COUNTS) {
+          const auto serial = run(processor, {num_channels, block_size, stages, false}, seconds);
+          const auto parallel = run(processor, {num_channels, block_size, stages, true}, seconds);
+          // how much faster the worker threads made the average callback
+          parallel.json.getDynamicObject()->setProperty("speedup",
+                                                        serial.mean_ns / parallel.mean_ns);
+          results.add(serial.json);
+          results.add(parallel.json);
+        }
+  }
+
+  auto *report = new juce::DynamicObject();
+  report->setProperty("plugin", JucePlugin_Name);
+  report->setProperty("version", JucePlugin_VersionString);
+  report->setProperty("seconds_per_run", seconds);
+  report->setProperty("cpus", juce::SystemStats::getNumCpus());
+  report->setProperty("results", results);
+  const auto json = juce::JSON::toString(juce::var(report));
+
+  if (output_path.isNotEmpty()) {
+    if (!juce::File::getCurrentWorkingDirectory().getChildFile(output_path).replaceWithText(json)) {
+      std::cerr << "could not write " << output_path << std::endl;
+      return 1;
+    }
+  } else {
+    std::cout << json << std::endl;
+  }
+  return 0;
+}
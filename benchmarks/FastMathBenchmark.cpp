@@ -0,0 +1,283 @@
+// Fast math benchmark
+//
+// Compares the FastMath.h approximations (through math_kernels, at every
+// instruction set this cpu supports) and LookupTable with libm: the largest
+// error over a sweep of each function's documented range, as a share of its
+// bound in fast_math_bounds, and the cost per value. every path is also fed nan,
+// infinities and the extremes of float, which must give the scalar path's
+// (finite) value. prints the results as JSON
+//
+// usage: FastMathBenchmark [--seconds=<seconds per timing>] [--output=<file.json>]
+// exits with code 3 if any path is outside its documented bound, or gives
+// another value than scalar (or a non finite one) for a special input
+//
+// build with: cmake -DBUILD_BENCHMARKS=ON ...
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <iostream>
+#include <limits>
+#include <vector>
+
+#include <juce_core/juce_core.h>
+
+#include "../src/Util/CpuFeatures.h"
+#include "../src/Util/FastMath.h"
+#include "../src/Util/LookupTable.h"
+#include "../src/Util/MathKernels.h"
+
+namespace {
+
+// values per call, about what one block of per-sample gains would be
+constexpr int BLOCK_SIZE = 1024;
+// points in each accuracy sweep
+constexpr int SWEEP_POINTS = 1 << 22;
+constexpr float POW_EXPONENT = 2.5f;
+constexpr int TABLE_SIZE = 4096;
+
+using KernelFn = void (*)(const math_kernels::Kernels &kernels, const float *input, float *output,
+                          int numSamples);
+
+struct Function {
+  const char *name;
+  // the sweep, log spaced for the functions of positive values
+  float min;
+  float max;
+  bool log_spaced;
+  nthn_utils::FastMathBound bound;
+  double (*reference)(double x);
+  float (*libm)(float x);
+  KernelFn kernel;
+};
+
+const std::vector<Function> FUNCTIONS{
+    {"exp", -87.0f, 87.0f, false, nthn_utils::fast_math_bounds::EXP,
+     [](double x) { return std::exp(x); }, [](float x) { return std::exp(x); },
+     [](const math_kernels::Kernels &k, const float *in, float *out, int n) {
+       k.exp(in, out, n);
+     }},
+    {"log", 1.2e-38f, 3.0e38f, true, nthn_utils::fast_math_bounds::LOG,
+     [](double x) { return std::log(x); }, [](float x) { return std::log(x); },
+     [](const math_kernels::Kernels &k, const float *in, float *out, int n) {
+       k.log(in, out, n);
+     }},
+    // the pow bound grows with |y * log2(x)|, which is at most 2.5 * 20 = 50 here
+    {"pow", 1.0e-6f, 1.0e6f, true,
+     {0.0, 2.0e-7 + 7.0e-8 * double(POW_EXPONENT) * 20.0},
+     [](double x) { return std::pow(x, double(POW_EXPONENT)); },
+     [](float x) { return std::pow(x, POW_EXPONENT); },
+     [](const math_kernels::Kernels &k, const float *in, float *out, int n) {
+       k.pow(in, POW_EXPONENT, out, n);
+     }},
+    {"tanh", -20.0f, 20.0f, false, nthn_utils::fast_math_bounds::TANH,
+     [](double x) { return std::tanh(x); }, [](float x) { return std::tanh(x); },
+     [](const math_kernels::Kernels &k, const float *in, float *out, int n) {
+       k.tanh(in, out, n);
+     }},
+    {"db_to_gain", -150.0f, 50.0f, false, nthn_utils::fast_math_bounds::DB_TO_GAIN,
+     [](double x) { return std::pow(10.0, x / 20.0); },
+     [](float x) { return std::pow(10.0f, x / 20.0f); },
+     [](const math_kernels::Kernels &k, const float *in, float *out, int n) {
+       k.db_to_gain(in, out, n);
+     }},
+    {"gain_to_db", 1.2e-38f, 3.0e38f, true, nthn_utils::fast_math_bounds::GAIN_TO_DB,
+     [](double x) { return 20.0 * std::log10(x); },
+     [](float x) { return 20.0f * std::log10(x); },
+     [](const math_kernels::Kernels &k, const float *in, float *out, int n) {
+       k.gain_to_db(in, out, n);
+     }},
+};
+
+std::vector<float> sweep(float min, float max, bool log_spaced, int num_points) {
+  std::vector<float> points(static_cast<size_t>(num_points));
+  for (int i = 0; i < num_points; ++i) {
+    const double t = double(i) / double(num_points - 1);
+    points[size_t(i)] = log_spaced ? float(double(min) * std::pow(double(max) / min, t))
+                                   : float(min + (max - min) * t);
+  }
+  return points;
+}
+
+// largest |error| / (absolute + relative * |exact|) over the points
+double worst_error(const std::vector<float> &input, const std::vector<float> &output,
+                   double (*reference)(double), nthn_utils::FastMathBound bound) {
+  double worst = 0.0;
+  for (size_t i = 0; i < input.size(); ++i) {
+    const double exact = reference(double(input[i]));
+    const double error = std::abs(double(output[i]) - exact);
+    worst = std::max(worst, error / (bound.absolute + bound.relative * std::abs(exact)));
+  }
+  return worst;
+}
+
+// inputs outside every documented range, which the clamps have to catch
+std::vector<float> special_values() {
+  using limits = std::numeric_limits<float>;
+  return {limits::quiet_NaN(), -limits::quiet_NaN(), limits::infinity(), -limits::infinity(),
+          limits::max(),       -limits::max(),       limits::denorm_min(), 0.0f,
+          -0.0f,               -1.0f};
+}
+
+// number of special values where kernel gives a non finite value, or one that is
+// further than the function's bound from the scalar path's
+int count_special_mismatches(const Function &function, const math_kernels::Kernels &kernels) {
+  const auto input = special_values();
+  std::vector<float> expected(input.size()), actual(input.size());
+  function.kernel(math_kernels::scalar(), input.data(), expected.data(), int(input.size()));
+  function.kernel(kernels, input.data(), actual.data(), int(input.size()));
+  int mismatches = 0;
+  for (size_t i = 0; i < input.size(); ++i) {
+    const double error = std::abs(double(actual[i]) - double(expected[i]));
+    const double bound =
+        function.bound.absolute + function.bound.relative * std::abs(double(expected[i]));
+    if (!std::isfinite(expected[i]) || !std::isfinite(actual[i]) || error > bound)
+      ++mismatches;
+  }
+  return mismatches;
+}
+
+// nanoseconds per value of fn(input, output), over BLOCK_SIZE values at a time
+template <typename Fn>
+double time_per_value(Fn &&fn, const std::vector<float> &values, double seconds) {
+  std::vector<float> input(values.begin(), values.begin() + BLOCK_SIZE);
+  std::vector<float> output(BLOCK_SIZE);
+  using clock = std::chrono::steady_clock;
+  for (int i = 0; i < 100; ++i) // warm up
+    fn(input.data(), output.data());
+  long long calls = 0;
+  const auto start = clock::now();
+  auto now = start;
+  do {
+    for (int i = 0; i < 100; ++i)
+      fn(input.data(), output.data());
+    calls += 100;
+    now = clock::now();
+  } while (std::chrono::duration<double>(now - start).count() < seconds);
+  // keep the results alive
+  volatile float sink = output[BLOCK_SIZE / 2];
+  juce::ignoreUnused(sink);
+  return std::chrono::duration<double, std::nano>(now - start).count() /
+         (double(calls) * BLOCK_SIZE);
+}
+
+} // namespace
+
+//==============================================================================
+int main(int argc, char *argv[]) {
+  juce::ArgumentList args(argc, argv);
+  const double seconds =
+      args.containsOption("--seconds") ? args.getValueForOption("--seconds").getDoubleValue() : 0.2;
+  const juce::String output_path = args.getValueForOption("--output");
+
+  std::vector<const math_kernels::Kernels *> kernel_sets;
+  for (int level = 0; level <= int(nthn_utils::detect_simd_level()); ++level) {
+    const auto &kernels = math_kernels::for_level(nthn_utils::SimdLevel(level));
+    // levels that are not compiled in fall back to an earlier path
+    if (kernels.level == nthn_utils::SimdLevel(level))
+      kernel_sets.push_back(&kernels);
+  }
+
+  juce::Array<juce::var> results;
+  double worst = 0.0;
+  int special_mismatches = 0;
+  for (const auto &function : FUNCTIONS) {
+    const auto input = sweep(function.min, function.max, function.log_spaced, SWEEP_POINTS);
+    std::vector<float> output(input.size());
+
+    // libm in float, the baseline
+    for (size_t i = 0; i < input.size(); ++i)
+      output[i] = function.libm(input[i]);
+    const double libm_error = worst_error(input, output, function.reference, function.bound);
+    const double libm_ns = time_per_value(
+        [&](const float *in, float *out) {
+          for (int i = 0; i < BLOCK_SIZE; ++i)
+            out[i] = function.libm(in[i]);
+        },
+        input, seconds);
+    auto *libm_result = new juce::DynamicObject();
+    libm_result->setProperty("function", function.name);
+    libm_result->setProperty("path", "libm");
+    libm_result->setProperty("error_over_bound", libm_error);
+    libm_result->setProperty("ns_per_value", libm_ns);
+    results.add(juce::var(libm_result));
+
+    for (const auto *kernels : kernel_sets) {
+      function.kernel(*kernels, input.data(), output.data(), int(input.size()));
+      const double error = worst_error(input, output, function.reference, function.bound);
+      worst = std::max(worst, error);
+      const int path_special_mismatches = count_special_mismatches(function, *kernels);
+      special_mismatches += path_special_mismatches;
+      const double ns = time_per_value(
+          [&](const float *in, float *out) { function.kernel(*kernels, in, out, BLOCK_SIZE); },
+          input, seconds);
+
+      auto *result = new juce::DynamicObject();
+      result->setProperty("function", function.name);
+      result->setProperty("path", nthn_utils::simd_level_name(kernels->level));
+      // 1.0 = exactly at the documented bound
+      result->setProperty("error_over_bound", error);
+      result->setProperty("special_value_mismatches", path_special_mismatches);
+      result->setProperty("ns_per_value", ns);
+      result->setProperty("speedup_over_libm", libm_ns / ns);
+      results.add(juce::var(result));
+    }
+  }
+
+  // the table-driven versions, with their largest error itself: it depends on
+  // the table size, so there is no fixed bound to check
+  auto add_table = [&](const char *name, const auto &table, double (*reference)(double),
+                       bool relative) {
+    const auto input = sweep(table.get_min(), table.get_max(), false, SWEEP_POINTS);
+    std::vector<float> output(input.size());
+    table.process(input.data(), output.data(), int(input.size()));
+    const double error =
+        worst_error(input, output, reference, relative ? nthn_utils::FastMathBound{0.0, 1.0}
+                                                       : nthn_utils::FastMathBound{1.0, 0.0});
+    auto *result = new juce::DynamicObject();
+    result->setProperty("function", name);
+    result->setProperty("path", juce::String("table_") + juce::String(TABLE_SIZE));
+    result->setProperty(relative ? "max_relative_error" : "max_absolute_error", error);
+    result->setProperty(
+        "ns_per_value",
+        time_per_value([&](const float *in, float *out) { table.process(in, out, BLOCK_SIZE); },
+                       input, seconds));
+    results.add(juce::var(result));
+  };
+  const nthn_utils::LookupTable<TABLE_SIZE> tanh_table([](double x) { return std::tanh(x); },
+                                                       -9.0f, 9.0f);
+  add_table("tanh", tanh_table, [](double x) { return std::tanh(x); }, false);
+  const nthn_utils::LookupTable<TABLE_SIZE> gain_table(
+      [](double db) { return std::pow(10.0, db / 20.0); }, -150.0f, 50.0f);
+  add_table("db_to_gain", gain_table, [](double db) { return std::pow(10.0, db / 20.0); }, true);
+
+  auto *report = new juce::DynamicObject();
+  report->setProperty("simd_level", nthn_utils::simd_level_name(nthn_utils::detect_simd_level()));
+  report->setProperty("block_size", BLOCK_SIZE);
+  report->setProperty("sweep_points", SWEEP_POINTS);
+  report->setProperty("worst_error_over_bound", worst);
+  report->setProperty("special_value_mismatches", special_mismatches);
+  report->setProperty("results", results);
+  const auto json = juce::JSON::toString(juce::var(report));
+
+  if (output_path.isNotEmpty()) {
+    if (!juce::File::getCurrentWorkingDirectory().getChildFile(output_path).replaceWithText(json)) {
+      std::cerr << "could not write " << output_path << std::endl;
+      return 1;
+    }
+  } else {
+    std::cout << json << std::endl;
+  }
+
+  if (worst > 1.0) {
+    std::cerr << "a fast math path is " << worst << " times its documented error bound"
+              << std::endl;
+    return 3;
+  }
+  if (special_mismatches > 0) {
+    std::cerr << special_mismatches << " special values give a wrong or non finite value"
+              << std::endl;
+    return 3;
+  }
+  return 0;
+}
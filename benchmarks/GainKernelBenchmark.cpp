@@ -0,0 +1,204 @@
+// Gain kernel benchmark
+//
+// Checks that the SSE2, AVX2 and AVX-512 gain kernels (every one this cpu
+// supports, for float and double) give bit exact results against the scalar
+// path, over every length up to a few registers, unaligned starts and odd
+// values (zeros, denormals, infinities). then times each path, and prints the
+// results as JSON
+//
+// usage: GainKernelBenchmark [--seconds=<seconds per timing>] [--output=<file.json>]
+// exits with code 3 if any path differs from scalar
+//
+// build with: cmake -DBUILD_BENCHMARKS=ON ...
+
+#include <chrono>
+#include <cstring>
+#include <iostream>
+#include <iterator>
+#include <limits>
+#include <vector>
+
+#include <juce_core/juce_core.h>
+
+#include "../src/Util/CpuFeatures.h"
+#include "../src/audio/GainKernels.h"
+
+namespace {
+
+// samples per call in the timings
+constexpr int BLOCK_SIZE = 1024;
+// every length from 0 to MAX_CHECKED_LENGTH is checked, at every start offset
+// below MAX_OFFSET, which covers the tails and the unaligned loads of each path
+constexpr int MAX_CHECKED_LENGTH = 80;
+constexpr int MAX_OFFSET = 8;
+
+enum class Kernel { Ramp, Constant, RampStereo };
+
+const char *kernel_name(Kernel kernel) {
+  switch (kernel) {
+  case Kernel::Ramp:
+    return "apply_ramp";
+  case Kernel::Constant:
+    return "apply_constant";
+  case Kernel::RampStereo:
+    return "apply_ramp_stereo";
+  }
+  return "";
+}
+
+template <typename SampleType> const char *type_name();
+template <> const char *type_name<float>() { return "float"; }
+template <> const char *type_name<double>() { return "double"; }
+
+// noise with some odd values mixed in
+template <typename SampleType> std::vector<SampleType> make_samples(int size, juce::Random &rng) {
+  using limits = std::numeric_limits<SampleType>;
+  const SampleType odd[] = {SampleType(0),      -SampleType(0),   limits::denorm_min(),
+                            -limits::min(),     limits::max(),    limits::infinity(),
+                            -limits::infinity(), SampleType(1e-30)};
+  std::vector<SampleType> samples(static_cast<size_t>(size));
+  for (int i = 0; i < size; ++i)
+    samples[size_t(i)] = rng.nextInt(16) == 0 ? odd[rng.nextInt(int(std::size(odd)))]
+                                               : SampleType(rng.nextDouble() * 2.0 - 1.0);
+  return samples;
+}
+
+template <typename SampleType>
+void run(const gain_kernels::Kernels<SampleType> &kernels, Kernel kernel, SampleType *left,
+         SampleType *right, const float *ramp, float scale, SampleType gain, int numSamples) {
+  switch (kernel) {
+  case Kernel::Ramp:
+    kernels.apply_ramp(left, ramp, scale, numSamples);
+    break;
+  case Kernel::Constant:
+    kernels.apply_constant(left, gain, numSamples);
+    break;
+  case Kernel::RampStereo:
+    kernels.apply_ramp_stereo(left, right, ramp, scale, numSamples);
+    break;
+  }
+}
+
+// number of lengths and offsets where kernels differ from the scalar path,
+// bit for bit, in the processed samples or around them
+template <typename SampleType>
+int count_mismatches(const gain_kernels::Kernels<SampleType> &kernels, Kernel kernel,
+                     juce::Random &rng) {
+  const auto &scalar = gain_kernels::scalar<SampleType>();
+  const int size = MAX_CHECKED_LENGTH + 2 * MAX_OFFSET;
+  int mismatches = 0;
+  for (int length = 0; length <= MAX_CHECKED_LENGTH; ++length) {
+    for (int offset = 0; offset < MAX_OFFSET; ++offset) {
+      const auto left = make_samples<SampleType>(size, rng);
+      const auto right = make_samples<SampleType>(size, rng);
+      std::vector<float> ramp(static_cast<size_t>(size));
+      for (auto &gain : ramp)
+        gain = rng.nextFloat() * 100.0f;
+      const float scale = 0.01f;
+      const auto gain = SampleType(rng.nextFloat() * 2.0f);
+
+      auto expected_left = left, expected_right = right;
+      auto actual_left = left, actual_right = right;
+      run(scalar, kernel, expected_left.data() + offset, expected_right.data() + offset,
+          ramp.data() + offset, scale, gain, length);
+      run(kernels, kernel, actual_left.data() + offset, actual_right.data() + offset,
+          ramp.data() + offset, scale, gain, length);
+      const auto bytes = sizeof(SampleType) * size_t(size);
+      if (std::memcmp(expected_left.data(), actual_left.data(), bytes) != 0 ||
+          std::memcmp(expected_right.data(), actual_right.data(), bytes) != 0)
+        ++mismatches;
+    }
+  }
+  return mismatches;
+}
+
+// nanoseconds per sample (per channel) over BLOCK_SIZE samples at a time
+template <typename SampleType>
+double time_per_sample(const gain_kernels::Kernels<SampleType> &kernels, Kernel kernel,
+                       double seconds) {
+  // gains close to 1, so repeated calls don't run into denormals or infinities
+  std::vector<SampleType> left(BLOCK_SIZE, SampleType(0.5)), right = left;
+  std::vector<float> ramp(BLOCK_SIZE, 100.0f);
+  const float scale = 0.01f;
+  using clock = std::chrono::steady_clock;
+  long long calls = 0;
+  const auto start = clock::now();
+  auto now = start;
+  do {
+    for (int i = 0; i < 100; ++i)
+      run(kernels, kernel, left.data(), right.data(), ramp.data(), scale, SampleType(1),
+          BLOCK_SIZE);
+    calls += 100;
+    now = clock::now();
+  } while (std::chrono::duration<double>(now - start).count() < seconds);
+  volatile SampleType sink = left[BLOCK_SIZE / 2] + right[BLOCK_SIZE / 2];
+  juce::ignoreUnused(sink);
+  return std::chrono::duration<double, std::nano>(now - start).count() /
+         (double(calls) * BLOCK_SIZE);
+}
+
+template <typename SampleType>
+int add_results(juce::Array<juce::var> &results, double seconds) {
+  juce::Random rng(1234);
+  int mismatches = 0;
+  for (auto kernel : {Kernel::Ramp, Kernel::Constant, Kernel::RampStereo}) {
+    const double scalar_ns = time_per_sample(gain_kernels::scalar<SampleType>(), kernel, seconds);
+    for (int level = 0; level <= int(nthn_utils::detect_simd_level()); ++level) {
+      const auto &kernels = gain_kernels::for_level<SampleType>(nthn_utils::SimdLevel(level));
+      // levels that are not compiled in fall back to an earlier path
+      if (kernels.level != nthn_utils::SimdLevel(level))
+        continue;
+      const int path_mismatches = count_mismatches(kernels, kernel, rng);
+      mismatches += path_mismatches;
+      const double ns = time_per_sample(kernels, kernel, seconds);
+
+      auto *result = new juce::DynamicObject();
+      result->setProperty("kernel", kernel_name(kernel));
+      result->setProperty("type", type_name<SampleType>());
+      result->setProperty("path", nthn_utils::simd_level_name(kernels.level));
+      result->setProperty("mismatches", path_mismatches);
+      result->setProperty("ns_per_sample", ns);
+      result->setProperty("speedup_over_scalar", scalar_ns / ns);
+      results.add(juce::var(result));
+    }
+  }
+  return mismatches;
+}
+
+} // namespace
+
+//==============================================================================
+int main(int argc, char *argv[]) {
+  juce::ArgumentList args(argc, argv);
+  const double seconds =
+      args.containsOption("--seconds") ? args.getValueForOption("--seconds").getDoubleValue() : 0.1;
+  const juce::String output_path = args.getValueForOption("--output");
+
+  juce::Array<juce::var> results;
+  const int mismatches =
+      add_results<float>(results, seconds) + add_results<double>(results, seconds);
+
+  auto *report = new juce::DynamicObject();
+  report->setProperty("simd_level", nthn_utils::simd_level_name(nthn_utils::detect_simd_level()));
+  report->setProperty("block_size", BLOCK_SIZE);
+  report->setProperty("checked_lengths", MAX_CHECKED_LENGTH + 1);
+  report->setProperty("checked_offsets", MAX_OFFSET);
+  report->setProperty("mismatches", mismatches);
+  report->setProperty("results", results);
+  const auto json = juce::JSON::toString(juce::var(report));
+
+  if (output_path.isNotEmpty()) {
+    if (!juce::File::getCurrentWorkingDirectory().getChildFile(output_path).replaceWithText(json)) {
+      std::cerr << "could not write " << output_path << std::endl;
+      return 1;
+    }
+  } else {
+    std::cout << json << std::endl;
+  }
+
+  if (mismatches > 0) {
+    std::cerr << mismatches << " gain kernel runs differ from the scalar path" << std::endl;
+    return 3;
+  }
+  return 0;
+}
@@ -0,0 +1,198 @@
+// Meter kernel benchmark
+//
+// Checks the SSE2, AVX2 and AVX-512 meter kernels (every one this cpu
+// supports, for float and double) against a reference computed at higher
+// precision (double for float samples, long double for double samples), over
+// every length up to a few registers, unaligned starts and a few block sizes.
+// min and max must match exactly, the sum of squares must be within the error
+// bound of a float (or double) sum of that many terms, which the simd paths add
+// in a different order than scalar. then times each path, and prints the
+// results as JSON
+//
+// usage: MeterKernelBenchmark [--seconds=<seconds per timing>] [--output=<file.json>]
+// exits with code 3 if any path is off the reference
+//
+// build with: cmake -DBUILD_BENCHMARKS=ON ...
+
+#include <chrono>
+#include <cmath>
+#include <iostream>
+#include <limits>
+#include <vector>
+
+#include <juce_core/juce_core.h>
+
+#include "../src/Util/CpuFeatures.h"
+#include "../src/audio/MeterKernels.h"
+
+namespace {
+
+// samples per call in the timings
+constexpr int BLOCK_SIZE = 1024;
+// every length from 0 to MAX_CHECKED_LENGTH is checked, at every start offset
+// below MAX_OFFSET, which covers the tails and the unaligned loads of each path
+constexpr int MAX_CHECKED_LENGTH = 80;
+constexpr int MAX_OFFSET = 8;
+// and a few whole frames and blocks
+constexpr int LONG_LENGTHS[] = {192, 1024, 4096};
+
+template <typename SampleType> const char *type_name();
+template <> const char *type_name<float>() { return "float"; }
+template <> const char *type_name<double>() { return "double"; }
+
+// the reference is summed at this precision
+template <typename SampleType> struct Reference;
+template <> struct Reference<float> {
+  using Type = double;
+};
+template <> struct Reference<double> {
+  using Type = long double;
+};
+
+// noise, with some zeros and denormals mixed in if odd_values
+template <typename SampleType>
+std::vector<SampleType> make_samples(int size, juce::Random &rng, bool odd_values = true) {
+  using limits = std::numeric_limits<SampleType>;
+  const SampleType odd[] = {SampleType(0), -SampleType(0), limits::denorm_min(),
+                            -limits::denorm_min(), SampleType(1), SampleType(-1)};
+  std::vector<SampleType> samples(static_cast<size_t>(size));
+  for (int i = 0; i < size; ++i)
+    samples[size_t(i)] = odd_values && rng.nextInt(16) == 0
+                             ? odd[rng.nextInt(6)]
+                             : SampleType(rng.nextDouble() * 2.0 - 1.0);
+  return samples;
+}
+
+// true if kernels fold samples into the running values the way the reference does
+template <typename SampleType>
+bool matches_reference(const meter_kernels::Kernels<SampleType> &kernels,
+                       const SampleType *samples, int length, juce::Random &rng) {
+  using R = typename Reference<SampleType>::Type;
+  // running values of a frame that already has some samples in it
+  const auto start_min = SampleType(rng.nextDouble());
+  const auto start_max = -SampleType(rng.nextDouble());
+  const auto start_sum = SampleType(rng.nextDouble());
+
+  SampleType expected_min = start_min, expected_max = start_max;
+  R expected_sum = R(start_sum);
+  for (int i = 0; i < length; ++i) {
+    const SampleType x = samples[i];
+    expected_min = x < expected_min ? x : expected_min;
+    expected_max = x > expected_max ? x : expected_max;
+    expected_sum += R(x) * R(x);
+  }
+
+  SampleType min = start_min, max = start_max, sum = start_sum;
+  kernels.accumulate(samples, length, min, max, sum);
+  // each square and each of the (at most length + lanes) additions rounds once,
+  // and every term is positive
+  const R bound =
+      R(length + 32) * R(std::numeric_limits<SampleType>::epsilon()) * expected_sum;
+  return min == expected_min && max == expected_max &&
+         std::abs(R(sum) - expected_sum) <= bound;
+}
+
+// number of lengths and offsets where kernels are off the reference
+template <typename SampleType>
+int count_mismatches(const meter_kernels::Kernels<SampleType> &kernels, juce::Random &rng) {
+  int mismatches = 0;
+  for (int length = 0; length <= MAX_CHECKED_LENGTH; ++length) {
+    for (int offset = 0; offset < MAX_OFFSET; ++offset) {
+      const auto samples = make_samples<SampleType>(length + offset, rng);
+      if (!matches_reference(kernels, samples.data() + offset, length, rng))
+        ++mismatches;
+    }
+  }
+  for (int length : LONG_LENGTHS) {
+    const auto samples = make_samples<SampleType>(length + 1, rng);
+    if (!matches_reference(kernels, samples.data() + 1, length, rng))
+      ++mismatches;
+  }
+  return mismatches;
+}
+
+// nanoseconds per sample over BLOCK_SIZE samples at a time
+template <typename SampleType>
+double time_per_sample(const meter_kernels::Kernels<SampleType> &kernels, double seconds) {
+  // no denormals, which the plugin flushes to zero while processing
+  juce::Random rng(1234);
+  const auto samples = make_samples<SampleType>(BLOCK_SIZE, rng, false);
+  SampleType min = 0, max = 0, sum = 0;
+  using clock = std::chrono::steady_clock;
+  long long calls = 0;
+  const auto start = clock::now();
+  auto now = start;
+  do {
+    for (int i = 0; i < 100; ++i)
+      kernels.accumulate(samples.data(), BLOCK_SIZE, min, max, sum);
+    calls += 100;
+    now = clock::now();
+  } while (std::chrono::duration<double>(now - start).count() < seconds);
+  volatile SampleType sink = min + max + sum;
+  juce::ignoreUnused(sink);
+  return std::chrono::duration<double, std::nano>(now - start).count() /
+         (double(calls) * BLOCK_SIZE);
+}
+
+template <typename SampleType>
+int add_results(juce::Array<juce::var> &results, double seconds) {
+  juce::Random rng(1234);
+  int mismatches = 0;
+  const double scalar_ns = time_per_sample(meter_kernels::scalar<SampleType>(), seconds);
+  for (int level = 0; level <= int(nthn_utils::detect_simd_level()); ++level) {
+    const auto &kernels = meter_kernels::for_level<SampleType>(nthn_utils::SimdLevel(level));
+    // levels that are not compiled in fall back to an earlier path
+    if (kernels.level != nthn_utils::SimdLevel(level))
+      continue;
+    const int path_mismatches = count_mismatches(kernels, rng);
+    mismatches += path_mismatches;
+    const double ns = time_per_sample(kernels, seconds);
+
+    auto *result = new juce::DynamicObject();
+    result->setProperty("type", type_name<SampleType>());
+    result->setProperty("path", nthn_utils::simd_level_name(kernels.level));
+    result->setProperty("mismatches", path_mismatches);
+    result->setProperty("ns_per_sample", ns);
+    result->setProperty("speedup_over_scalar", scalar_ns / ns);
+    results.add(juce::var(result));
+  }
+  return mismatches;
+}
+
+} // namespace
+
+//==============================================================================
+int main(int argc, char *argv[]) {
+  juce::ArgumentList args(argc, argv);
+  const double seconds =
+      args.containsOption("--seconds") ? args.getValueForOption("--seconds").getDoubleValue() : 0.1;
+  const juce::String output_path = args.getValueForOption("--output");
+
+  juce::Array<juce::var> results;
+  const int mismatches =
+      add_results<float>(results, seconds) + add_results<double>(results, seconds);
+
+  auto *report = new juce::DynamicObject();
+  report->setProperty("simd_level", nthn_utils::simd_level_name(nthn_utils::detect_simd_level()));
+  report->setProperty("block_size", BLOCK_SIZE);
+  report->setProperty("checked_lengths", MAX_CHECKED_LENGTH + 1);
+  report->setProperty("checked_offsets", MAX_OFFSET);
+  report->setProperty("mismatches", mismatches);
+  report->setProperty("results", results);
+  const auto json = juce::JSON::toString(juce::var(report));
+
+  if (output_path.isNotEmpty()) {
+    if (!juce::File::getCurrentWorkingDirectory().getChildFile(output_path).replaceWithText(json)) {
+      std::cerr << "could not write " << output_path << std::endl;
+      return 1;
+    }
+  } else {
+    std::cout << json << std::endl;
+  }
+
+  if (mismatches > 0) {
+    std::cerr << mismatches << " meter kernel runs are off the reference" << std::endl;
+    return 3;
+  }
+  return 0;
+}
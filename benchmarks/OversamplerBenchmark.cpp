@@ -0,0 +1,122 @@
+// Oversampler benchmark
+//
+// Measures the cost of the Oversampler round trip (up, then straight back down)
+// for every factor and quality, with the scalar and the best simd kernels,
+// and prints the results as JSON
+//
+// usage: OversamplerBenchmark [--seconds=<audio seconds per run>] [--output=<file.json>]
+//
+// build with: cmake -DBUILD_BENCHMARKS=ON ...
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <iostream>
+#include <vector>
+
+#include <juce_audio_basics/juce_audio_basics.h>
+
+#include "../src/Util/CpuFeatures.h"
+#include "../src/audio/FirKernels.h"
+#include "../src/audio/Oversampler.h"
+
+namespace {
+
+constexpr double SAMPLE_RATE = 48000.0;
+constexpr int NUM_CHANNELS = 2;
+const std::vector<int> BLOCK_SIZES{32, 128, 512, 2048};
+using Quality = Oversampler<float>::Quality;
+const std::vector<Quality> QUALITIES{Quality::LOW, Quality::NORMAL, Quality::HIGH};
+const std::vector<const char *> QUALITY_NAMES{"low", "normal", "high"};
+
+constexpr int MIN_CALLBACKS = 200;
+constexpr int WARMUP_CALLBACKS = 32;
+
+juce::var run(int num_stages, Quality quality, int block_size,
+              const fir_kernels::Kernels<float> &kernels, double seconds) {
+  Oversampler<float> oversampler;
+  oversampler.setKernels(kernels);
+  oversampler.prepare(block_size, NUM_CHANNELS);
+  oversampler.configure(num_stages, quality);
+
+  juce::AudioBuffer<float> buffer(NUM_CHANNELS, block_size);
+  juce::Random noise(42);
+  const int num_callbacks =
+      std::max(MIN_CALLBACKS, int(std::ceil(seconds * SAMPLE_RATE / block_size)));
+  std::vector<double> callback_ns;
+  callback_ns.reserve(size_t(num_callbacks));
+
+  using clock = std::chrono::steady_clock;
+  for (int callback = -WARMUP_CALLBACKS; callback < num_callbacks; ++callback) {
+    for (int ch = 0; ch < NUM_CHANNELS; ++ch)
+      for (int i = 0; i < block_size; ++i)
+        buffer.setSample(ch, i, noise.nextFloat() * 2.0f - 1.0f);
+
+    const auto start = clock::now();
+    oversampler.process(buffer.getArrayOfWritePointers(), 0, block_size, NUM_CHANNELS,
+                        [](float *const *, int) {});
+    const auto end = clock::now();
+
+    if (callback >= 0)
+      callback_ns.push_back(std::chrono::duration<double, std::nano>(end - start).count());
+  }
+
+  double total_ns = 0.0;
+  for (auto ns : callback_ns)
+    total_ns += ns;
+  const double max_ns = *std::max_element(callback_ns.begin(), callback_ns.end());
+  auto p99 = callback_ns.begin() + std::ptrdiff_t(double(callback_ns.size() - 1) * 0.99);
+  std::nth_element(callback_ns.begin(), p99, callback_ns.end());
+
+  auto *result = new juce::DynamicObject();
+  result->setProperty("factor", oversampler.get_factor());
+  result->setProperty("quality", QUALITY_NAMES[size_t(quality)]);
+  result->setProperty("kernels", nthn_utils::simd_level_name(kernels.level));
+  result->setProperty("block_size", block_size);
+  result->setProperty("channels", NUM_CHANNELS);
+  result->setProperty("latency_samples", oversampler.get_latency());
+  // per host rate sample, per channel
+  result->setProperty("ns_per_sample",
+                      total_ns / (double(num_callbacks) * block_size * NUM_CHANNELS));
+  result->setProperty("mean_ns", total_ns / double(num_callbacks));
+  result->setProperty("p99_ns", *p99);
+  result->setProperty("max_ns", max_ns);
+  return juce::var(result);
+}
+
+} // namespace
+
+//==============================================================================
+int main(int argc, char *argv[]) {
+  juce::ArgumentList args(argc, argv);
+  const double seconds =
+      args.containsOption("--seconds") ? args.getValueForOption("--seconds").getDoubleValue() : 1.0;
+  const juce::String output_path = args.getValueForOption("--output");
+
+  std::vector<const fir_kernels::Kernels<float> *> kernel_sets{&fir_kernels::scalar<float>()};
+  if (fir_kernels::best<float>().level != nthn_utils::SimdLevel::Scalar)
+    kernel_sets.push_back(&fir_kernels::best<float>());
+
+  juce::Array<juce::var> results;
+  for (const auto *kernels : kernel_sets)
+    for (int num_stages = 0; num_stages <= Oversampler<float>::MAX_STAGES; ++num_stages)
+      for (auto quality : QUALITIES)
+        for (auto block_size : BLOCK_SIZES)
+          results.add(run(num_stages, quality, block_size, *kernels, seconds));
+
+  auto *report = new juce::DynamicObject();
+  report->setProperty("sample_rate", SAMPLE_RATE);
+  report->setProperty("seconds_per_run", seconds);
+  report->setProperty("results", results);
+  const auto json = juce::JSON::toString(juce::var(report));
+
+  if (output_path.isNotEmpty()) {
+    if (!juce::File::getCurrentWorkingDirectory().getChildFile(output_path).replaceWithText(json)) {
+      std::cerr << "could not write " << output_path << std::endl;
+      return 1;
+    }
+  } else {
+    std::cout << json << std::endl;
+  }
+  return 0;
+}
@@ -0,0 +1,125 @@
+// param_value benchmark
+//
+// Times StateManager::param_value(), which the audio thread calls for every
+// parameter it reads, against the layout it replaced: a table of pointers to
+// atomics allocated one by one (like the APVTS's raw values), where each read
+// is a pointer load followed by an atomic load. both are read in parameter
+// order and in a random order, and the cost per read is printed as JSON
+//
+// usage: ParamValueBenchmark [--seconds=<seconds per timing>] [--output=<file.json>]
+//
+// build with: cmake -DBUILD_BENCHMARKS=ON ...
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <iostream>
+#include <memory>
+#include <utility>
+#include <vector>
+
+#include <juce_audio_processors/juce_audio_processors.h>
+#include <juce_events/juce_events.h>
+
+#include "../src/parameters/StateManager.h"
+#include "../src/plugin/PluginProcessor.h"
+
+namespace {
+
+// parameter ids read per timed pass
+constexpr int READS_PER_PASS = 4096;
+
+// the previous layout: one pointer per PARAM, to atomics allocated separately
+struct PointerTable {
+  explicit PointerTable(const StateManager &state) {
+    for (size_t p_id = 0; p_id < TOTAL_NUMBER_PARAMETERS; ++p_id) {
+      values.push_back(std::make_unique<std::atomic<float>>(state.param_value(p_id)));
+      pointers[p_id] = values.back().get();
+    }
+  }
+  float param_value(size_t param_id) const { return pointers[param_id]->load(); }
+
+  std::vector<std::unique_ptr<std::atomic<float>>> values;
+  alignas(64) std::array<std::atomic<float> *, TOTAL_NUMBER_PARAMETERS> pointers{};
+};
+
+// nanoseconds per read(param_id), over the ids in order
+template <typename ReadFn>
+double time_per_read(ReadFn &&read, const std::vector<size_t> &ids, double seconds) {
+  using clock = std::chrono::steady_clock;
+  float sum = 0.0f;
+  long long passes = 0;
+  const auto start = clock::now();
+  auto now = start;
+  do {
+    for (int pass = 0; pass < 100; ++pass)
+      for (auto p_id : ids)
+        sum += read(p_id);
+    passes += 100;
+    now = clock::now();
+  } while (std::chrono::duration<double>(now - start).count() < seconds);
+  // keep the reads alive
+  volatile float sink = sum;
+  juce::ignoreUnused(sink);
+  return std::chrono::duration<double, std::nano>(now - start).count() /
+         (double(passes) * double(ids.size()));
+}
+
+} // namespace
+
+//==============================================================================
+int main(int argc, char *argv[]) {
+  juce::ArgumentList args(argc, argv);
+  const double seconds =
+      args.containsOption("--seconds") ? args.getValueForOption("--seconds").getDoubleValue() : 0.2;
+  const juce::String output_path = args.getValueForOption("--output");
+
+  // the processor expects a message manager, like it would have inside a host
+  juce::ScopedJuceInitialiser_GUI juce_initialiser;
+  PluginProcessor processor;
+  const StateManager &state = *processor.state;
+  const PointerTable pointer_table(state);
+
+  std::vector<size_t> in_order(READS_PER_PASS), random_order(READS_PER_PASS);
+  juce::Random rng(1234);
+  for (int i = 0; i < READS_PER_PASS; ++i) {
+    in_order[size_t(i)] = size_t(i) % TOTAL_NUMBER_PARAMETERS;
+    random_order[size_t(i)] = size_t(rng.nextInt(int(TOTAL_NUMBER_PARAMETERS)));
+  }
+
+  juce::Array<juce::var> results;
+  const std::pair<const char *, const std::vector<size_t> *> orders[] = {
+      {"in_order", &in_order}, {"random", &random_order}};
+  for (const auto &[order, order_ids] : orders) {
+    const auto &ids = *order_ids;
+    const double ns = time_per_read([&](size_t p_id) { return state.param_value(p_id); }, ids,
+                                    seconds);
+    const double pointer_ns = time_per_read(
+        [&](size_t p_id) { return pointer_table.param_value(p_id); }, ids, seconds);
+
+    auto *result = new juce::DynamicObject();
+    result->setProperty("order", order);
+    result->setProperty("ns_per_read", ns);
+    result->setProperty("pointer_table_ns_per_read", pointer_ns);
+    result->setProperty("speedup", pointer_ns / ns);
+    results.add(juce::var(result));
+  }
+
+  auto *report = new juce::DynamicObject();
+  report->setProperty("plugin", JucePlugin_Name);
+  report->setProperty("parameters", int(TOTAL_NUMBER_PARAMETERS));
+  report->setProperty("reads_per_pass", READS_PER_PASS);
+  report->setProperty("seconds_per_run", seconds);
+  report->setProperty("results", results);
+  const auto json = juce::JSON::toString(juce::var(report));
+
+  if (output_path.isNotEmpty()) {
+    if (!juce::File::getCurrentWorkingDirectory().getChildFile(output_path).replaceWithText(json)) {
+      std::cerr << "could not write " << output_path << std::endl;
+      return 1;
+    }
+  } else {
+    std::cout << json << std::endl;
+  }
+  return 0;
+}
@@ -0,0 +1,106 @@
+// Parameter set mailbox stress test
+//
+// Hammers the ParameterSetMailbox that StateManager::set_parameters() uses to
+// hand a whole set of values to the audio thread: one thread publishes sets
+// as fast as it can, every value of set i being i, while another reads the
+// latest set in a loop. every set read must hold a single value (not torn
+// between two publishes) and never be older than the one read before it.
+// prints the counts and rates as JSON
+//
+// usage: ParameterSetBenchmark [--sets=<sets published>] [--output=<file.json>]
+// exits with code 3 if any torn or out of order set was read
+//
+// build with: cmake -DBUILD_BENCHMARKS=ON ...
+// to check the memory ordering as well, add -DCMAKE_CXX_FLAGS=-fsanitize=thread
+// (and -DCMAKE_EXE_LINKER_FLAGS=-fsanitize=thread) and run it: ThreadSanitizer
+// reports any unsynchronised access to the buffers
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <iostream>
+#include <memory>
+#include <thread>
+
+#include <juce_core/juce_core.h>
+
+#include "../src/parameters/AutomationEvents.h"
+
+namespace {
+// sets are numbered with floats, which count exactly up to 2^24
+constexpr int MAX_SETS = 1 << 24;
+} // namespace
+
+//==============================================================================
+int main(int argc, char *argv[]) {
+  juce::ArgumentList args(argc, argv);
+  const int num_sets =
+      args.containsOption("--sets")
+          ? juce::jlimit(1, MAX_SETS, args.getValueForOption("--sets").getIntValue())
+          : 2000000;
+  const juce::String output_path = args.getValueForOption("--output");
+
+  // too big for the stack with many parameters
+  auto mailbox = std::make_unique<ParameterSetMailbox>();
+  std::atomic<bool> writer_done{false};
+
+  using clock = std::chrono::steady_clock;
+  const auto start = clock::now();
+  // the message thread's side
+  std::thread writer([&] {
+    for (int i = 1; i <= num_sets; ++i) {
+      mailbox->write_buffer().fill(float(i));
+      mailbox->publish();
+    }
+    writer_done.store(true);
+  });
+
+  // the audio thread's side
+  long long reads = 0, sets_seen = 0, torn = 0, out_of_order = 0;
+  float last = 0.0f;
+  for (bool done = false; !done;) {
+    // one more read after the writer finishes, which must see the last set
+    done = writer_done.load();
+    const auto &values = mailbox->latest();
+    ++reads;
+    const float first = values[0];
+    if (!std::all_of(values.begin(), values.end(), [&](float v) { return v == first; }))
+      ++torn;
+    if (first < last)
+      ++out_of_order;
+    else if (first > last)
+      ++sets_seen;
+    last = std::max(last, first);
+  }
+  writer.join();
+  const double seconds = std::chrono::duration<double>(clock::now() - start).count();
+  const bool saw_last_set = last == float(num_sets);
+
+  auto *report = new juce::DynamicObject();
+  report->setProperty("parameters", int(TOTAL_NUMBER_PARAMETERS));
+  report->setProperty("sets_published", num_sets);
+  report->setProperty("reads", reads);
+  report->setProperty("sets_seen", sets_seen);
+  report->setProperty("torn", torn);
+  report->setProperty("out_of_order", out_of_order);
+  report->setProperty("saw_last_set", saw_last_set);
+  report->setProperty("publishes_per_second", double(num_sets) / seconds);
+  report->setProperty("reads_per_second", double(reads) / seconds);
+  const auto json = juce::JSON::toString(juce::var(report));
+
+  if (output_path.isNotEmpty()) {
+    if (!juce::File::getCurrentWorkingDirectory().getChildFile(output_path).replaceWithText(json)) {
+      std::cerr << "could not write " << output_path << std::endl;
+      return 1;
+    }
+  } else {
+    std::cout << json << std::endl;
+  }
+
+  if (torn > 0 || out_of_order > 0 || !saw_last_set) {
+    std::cerr << torn << " torn and " << out_of_order << " out of order sets read"
+              << (saw_last_set ? "" : ", and the last set was never read") << std::endl;
+    return 3;
+  }
+  return 0;
+}
@@ -0,0 +1,193 @@
+// ParameterSlider paint benchmark
+//
+// Paints a grid of ParameterSliders into a software image, like a full editor
+// repainting during automation playback, and prints the paint time per knob as
+// JSON. each scenario is also painted the way ParameterSlider did before its
+// static layer was cached, as a baseline
+//
+// usage: ParameterSliderBenchmark [--seconds=<seconds per run>] [--knobs=<number of knobs>]
+//                                 [--output=<file.json>]
+//
+// build with: cmake -DBUILD_BENCHMARKS=ON ...
+
+#include <chrono>
+#include <iostream>
+#include <memory>
+#include <vector>
+
+#include <juce_events/juce_events.h>
+#include <juce_gui_basics/juce_gui_basics.h>
+
+#include "../src/interface/ParameterSlider.h"
+#include "../src/parameters/StateManager.h"
+#include "../src/plugin/PluginProcessor.h"
+
+namespace {
+
+constexpr int KNOB_SIZE = 90;
+const std::vector<float> SCALES{1.0f, 2.0f};
+
+enum class Scenario { Static, Automated, Resized };
+
+const char *scenario_name(Scenario scenario) {
+  switch (scenario) {
+  case Scenario::Static:
+    return "static"; // nothing changes between frames
+  case Scenario::Automated:
+    return "automated"; // every parameter changes before every frame
+  case Scenario::Resized:
+    return "resized"; // every knob is resized before every frame
+  }
+  return "";
+}
+
+// ParameterSlider::paint before the static layer was cached: everything is
+// drawn, and the text formatted, on every frame
+void paint_uncached(juce::Graphics &g, ParameterSlider &knob, StateManager &state,
+                    size_t param_id) {
+  g.fillAll(knob.findColour(ParameterSlider::backgroundColourId, true));
+
+  const float slider_pos =
+      parameter_objects::range(param_id).convertTo0to1(state.param_value(param_id));
+  const float width = 0.5f * float(knob.getWidth());
+  const float height = 0.5f * float(knob.getHeight());
+  const float x_ = 0.25f * float(knob.getWidth());
+  const float y_ = 0.25f * float(knob.getWidth());
+  const float start_angle = -3.0f * juce::MathConstants<float>::pi / 4.0f;
+  const float end_angle = 3.0f * juce::MathConstants<float>::pi / 4.0f;
+  const float radius = std::min(width / 2, height / 2) - 2.0f;
+  const float rw = radius * 2.0f;
+  const float angle = start_angle + slider_pos * (end_angle - start_angle);
+  juce::Path p;
+  p.addEllipse(-0.5f * rw, -0.5f * rw, rw, rw);
+  juce::PathStrokeType(rw * 0.05f).createStrokedPath(p, p);
+  p.addLineSegment(juce::Line<float>(0.0f, 0.0f, 0.0f, -radius), rw * 0.05f);
+  g.setColour(knob.findColour(ParameterSlider::sliderColourId));
+  g.fillPath(p, juce::AffineTransform::rotation(angle).translated(x_ + width * 0.5f,
+                                                                  y_ + height * 0.5f));
+
+  g.setColour(juce::Colour(0xff000000));
+  g.drawText(parameter_objects::nickname(param_id), 0, 0, knob.getWidth(),
+             knob.proportionOfHeight(0.25f), juce::Justification::centred, true);
+  g.drawText(state.get_parameter_text(param_id), 0, knob.proportionOfHeight(0.75f),
+             knob.getWidth(), knob.proportionOfHeight(0.25f), juce::Justification::centred, true);
+  g.drawRect(knob.getLocalBounds());
+}
+
+struct Knob {
+  std::unique_ptr<ParameterSlider> slider;
+  size_t param_id;
+};
+
+// microseconds per knob painted, over seconds of repeated frames
+template <typename PaintFn, typename BeforeFrameFn>
+double time_per_knob(std::vector<Knob> &knobs, float scale, double seconds, PaintFn &&paint,
+                     BeforeFrameFn &&before_frame) {
+  // every knob paints over the same area, the cost is in the drawing
+  juce::Image image(juce::Image::RGB, juce::roundToInt(KNOB_SIZE * scale),
+                    juce::roundToInt(KNOB_SIZE * scale), true, juce::SoftwareImageType());
+  using clock = std::chrono::steady_clock;
+  double paint_seconds = 0.0;
+  long long painted = 0;
+  for (int frame = 0; paint_seconds < seconds || frame < 4; ++frame) {
+    // changes between frames are not timed
+    before_frame(frame);
+    const auto start = clock::now();
+    {
+      juce::Graphics g(image);
+      g.addTransform(juce::AffineTransform::scale(scale));
+      for (auto &knob : knobs) {
+        juce::Graphics::ScopedSaveState save_state(g);
+        paint(g, knob);
+      }
+    }
+    // the first frames fill the caches
+    if (frame >= 2) {
+      paint_seconds += std::chrono::duration<double>(clock::now() - start).count();
+      painted += juce::int64(knobs.size());
+    }
+  }
+  return 1.0e6 * paint_seconds / double(painted);
+}
+
+} // namespace
+
+//==============================================================================
+int main(int argc, char *argv[]) {
+  juce::ArgumentList args(argc, argv);
+  const double seconds =
+      args.containsOption("--seconds") ? args.getValueForOption("--seconds").getDoubleValue() : 0.5;
+  const int num_knobs =
+      args.containsOption("--knobs") ? args.getValueForOption("--knobs").getIntValue() : 128;
+  const juce::String output_path = args.getValueForOption("--output");
+
+  juce::ScopedJuceInitialiser_GUI juce_initialiser;
+  PluginProcessor processor;
+  auto &state = *processor.state;
+
+  // the knobs take their background colour from their parent, like in the editor
+  juce::Component parent;
+  parent.setColour(0, juce::Colour(0xff00ffa1));
+  parent.setSize(KNOB_SIZE, KNOB_SIZE);
+  std::vector<Knob> knobs;
+  for (int k = 0; k < num_knobs; ++k) {
+    const auto param_id = size_t(k) % TOTAL_NUMBER_PARAMETERS;
+    knobs.push_back({std::make_unique<ParameterSlider>(&state, param_id), param_id});
+    parent.addAndMakeVisible(*knobs.back().slider);
+    knobs.back().slider->setBounds(0, 0, KNOB_SIZE, KNOB_SIZE);
+  }
+
+  juce::Random rng(1234);
+  auto before_frame = [&](Scenario scenario, int frame) {
+    if (scenario == Scenario::Automated) {
+      for (size_t p_id = 0; p_id < TOTAL_NUMBER_PARAMETERS; ++p_id)
+        state.set_parameter_normalized(p_id, rng.nextFloat());
+    } else if (scenario == Scenario::Resized) {
+      for (auto &knob : knobs)
+        knob.slider->setSize(KNOB_SIZE - (frame & 1), KNOB_SIZE - (frame & 1));
+    }
+  };
+
+  juce::Array<juce::var> results;
+  for (auto scenario : {Scenario::Static, Scenario::Automated, Scenario::Resized}) {
+    for (auto scale : SCALES) {
+      const double cached_us = time_per_knob(
+          knobs, scale, seconds, [](juce::Graphics &g, Knob &knob) { knob.slider->paint(g); },
+          [&](int frame) { before_frame(scenario, frame); });
+      const double uncached_us = time_per_knob(
+          knobs, scale, seconds,
+          [&](juce::Graphics &g, Knob &knob) {
+            paint_uncached(g, *knob.slider, state, knob.param_id);
+          },
+          [&](int frame) { before_frame(scenario, frame); });
+
+      auto *result = new juce::DynamicObject();
+      result->setProperty("scenario", scenario_name(scenario));
+      result->setProperty("scale", scale);
+      result->setProperty("knobs", num_knobs);
+      result->setProperty("us_per_knob", cached_us);
+      result->setProperty("uncached_us_per_knob", uncached_us);
+      result->setProperty("speedup", uncached_us / cached_us);
+      results.add(juce::var(result));
+    }
+  }
+  for (auto &knob : knobs)
+    parent.removeChildComponent(knob.slider.get());
+
+  auto *report = new juce::DynamicObject();
+  report->setProperty("plugin", JucePlugin_Name);
+  report->setProperty("knob_size", KNOB_SIZE);
+  report->setProperty("seconds_per_run", seconds);
+  report->setProperty("results", results);
+  const auto json = juce::JSON::toString(juce::var(report));
+
+  if (output_path.isNotEmpty()) {
+    if (!juce::File::getCurrentWorkingDirectory().getChildFile(output_path).replaceWithText(json)) {
+      std::cerr << "could not write " << output_path << std::endl;
+      return 1;
+    }
+  } else {
+    std::cout << json << std::endl;
+  }
+  return 0;
+}
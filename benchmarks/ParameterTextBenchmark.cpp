@@ -0,0 +1,188 @@
+// Parameter text benchmark
+//
+// Checks that ParameterText gives the same text as the formatter it replaced
+// (std::ostringstream with std::fixed and std::setprecision(2), then " " and
+// the suffix, cut with substring()) for every parameter, over
+// VALUES_PER_PARAMETER values each: every value on its grain, an even sweep
+// and random values across its range, values exactly between two hundredths
+// (ties, which round to even), and nan, infinities, signed zeros and huge
+// values. then times to_text() against the old formatter on new values, on a
+// repeated value and on values of the grain, and prints the results as JSON
+//
+// usage: ParameterTextBenchmark [--seconds=<seconds per timing>] [--output=<file.json>]
+// exits with code 3 if any text differs from the old formatter's
+//
+// build with: cmake -DBUILD_BENCHMARKS=ON ...
+
+#include <chrono>
+#include <cmath>
+#include <iomanip>
+#include <iostream>
+#include <limits>
+#include <sstream>
+#include <vector>
+
+#include <juce_core/juce_core.h>
+
+#include "../src/parameters/ParameterObjects.h"
+#include "../src/parameters/ParameterText.h"
+
+namespace {
+
+constexpr int VALUES_PER_PARAMETER = 300000;
+// texts are checked whole and cut to this length, like a host with little room
+constexpr int SHORT_LENGTH = 5;
+// values per timed pass
+constexpr int VALUES_PER_PASS = 1024;
+
+// the formatter ParameterText replaced
+juce::String old_to_text(size_t p_id, float value, int maximum_length) {
+  const auto to_string_size = PARAMETER_TO_STRING_ARRS[p_id].size();
+  juce::String res;
+  if (to_string_size > 0 && (unsigned int)value < to_string_size) {
+    const auto &name = PARAMETER_TO_STRING_ARRS[p_id][(unsigned long)(value)];
+    res = juce::String::fromUTF8(name.data(), int(name.size()));
+  } else {
+    std::stringstream ss;
+    ss << std::fixed << std::setprecision(2) << value;
+    res = juce::String(ss.str());
+  }
+  const auto &suffix = PARAMETER_SUFFIXES[p_id];
+  auto output = res + " " + juce::String::fromUTF8(suffix.data(), int(suffix.size()));
+  return maximum_length > 0 ? output.substring(0, maximum_length) : output;
+}
+
+// the values checked for a parameter. the old formatter cast to unsigned, which
+// is undefined outside [0, 2^32), so parameters with names only get values
+// inside their range, like the host sends
+std::vector<float> values_to_check(size_t p_id, juce::Random &rng) {
+  const auto &range = PARAMETER_RANGES[p_id];
+  const bool named = !PARAMETER_TO_STRING_ARRS[p_id].empty();
+  std::vector<float> values;
+  values.reserve(VALUES_PER_PARAMETER);
+
+  if (range.interval > 0.0f) {
+    const int num_steps = int(std::floor((range.end - range.start) / range.interval + 0.5f)) + 1;
+    for (int i = 0; i < num_steps && i < VALUES_PER_PARAMETER / 4; ++i)
+      values.push_back(range.start + range.interval * float(i));
+  }
+  if (!named) {
+    using limits = std::numeric_limits<float>;
+    for (float special : {limits::quiet_NaN(), -limits::quiet_NaN(), limits::infinity(),
+                          -limits::infinity(), 0.0f, -0.0f, -0.001f, 0.005f, -0.005f, 1.0e20f,
+                          -1.0e20f, limits::max(), limits::denorm_min()})
+      values.push_back(special);
+    // multiples of 1/1024 are exact in a float, and every 8th one (x.125,
+    // x.375...) is a tie at two decimals
+    for (float v = std::floor(range.start); v <= range.end && values.size() < 100000;
+         v += 1.0f / 1024.0f)
+      values.push_back(v);
+  }
+  const auto remaining = (VALUES_PER_PARAMETER - int(values.size())) / 2;
+  for (int i = 0; i < remaining; ++i)
+    values.push_back(range.start + (range.end - range.start) * float(i) / float(remaining - 1));
+  while (int(values.size()) < VALUES_PER_PARAMETER)
+    values.push_back(range.start + (range.end - range.start) * rng.nextFloat());
+  return values;
+}
+
+// nanoseconds per call of text(value), over the values
+template <typename TextFn>
+double time_per_call(TextFn &&text, const std::vector<float> &values, double seconds) {
+  using clock = std::chrono::steady_clock;
+  int total_length = 0;
+  long long calls = 0;
+  const auto start = clock::now();
+  auto now = start;
+  do {
+    for (float value : values)
+      total_length += text(value).length();
+    calls += static_cast<long long>(values.size());
+    now = clock::now();
+  } while (std::chrono::duration<double>(now - start).count() < seconds);
+  volatile int sink = total_length;
+  juce::ignoreUnused(sink);
+  return std::chrono::duration<double, std::nano>(now - start).count() / double(calls);
+}
+
+} // namespace
+
+//==============================================================================
+int main(int argc, char *argv[]) {
+  juce::ArgumentList args(argc, argv);
+  const double seconds =
+      args.containsOption("--seconds") ? args.getValueForOption("--seconds").getDoubleValue() : 0.2;
+  const juce::String output_path = args.getValueForOption("--output");
+
+  ParameterText parameter_text;
+  juce::Random rng(1234);
+
+  long long checked = 0, mismatches = 0;
+  for (size_t p_id = 0; p_id < TOTAL_NUMBER_PARAMETERS; ++p_id) {
+    for (float value : values_to_check(p_id, rng)) {
+      for (int maximum_length : {0, SHORT_LENGTH}) {
+        const auto expected = old_to_text(p_id, value, maximum_length);
+        const auto actual = parameter_text.to_text(p_id, value, maximum_length);
+        ++checked;
+        if (actual != expected && ++mismatches <= 10)
+          std::cerr << PARAMETER_NAMES[p_id] << " " << std::setprecision(9) << value << ": \""
+                    << actual << "\" instead of \"" << expected << "\"" << std::endl;
+      }
+    }
+  }
+
+  juce::Array<juce::var> results;
+  for (size_t p_id = 0; p_id < TOTAL_NUMBER_PARAMETERS; ++p_id) {
+    const auto &range = PARAMETER_RANGES[p_id];
+    std::vector<float> new_values(VALUES_PER_PASS), grain_values(VALUES_PER_PASS);
+    for (int i = 0; i < VALUES_PER_PASS; ++i) {
+      // more distinct values than the recent texts hold
+      new_values[size_t(i)] = range.start + (range.end - range.start) * rng.nextFloat();
+      grain_values[size_t(i)] = range.interval > 0.0f
+                                    ? parameter_objects::range(p_id).snapToLegalValue(
+                                          new_values[size_t(i)])
+                                    : new_values[size_t(i)];
+    }
+    const std::vector<float> repeated_values(VALUES_PER_PASS, new_values[0]);
+
+    auto *result = new juce::DynamicObject();
+    result->setProperty("parameter", juce::String(PARAMETER_NAMES[p_id].data(),
+                                                  PARAMETER_NAMES[p_id].size()));
+    auto add_timing = [&](const char *name, const std::vector<float> &values) {
+      const double ns = time_per_call(
+          [&](float value) { return parameter_text.to_text(p_id, value); }, values, seconds);
+      const double old_ns = time_per_call(
+          [&](float value) { return old_to_text(p_id, value, 0); }, values, seconds);
+      result->setProperty(juce::String(name) + "_ns", ns);
+      result->setProperty(juce::String(name) + "_old_ns", old_ns);
+      result->setProperty(juce::String(name) + "_speedup", old_ns / ns);
+    };
+    add_timing("new_value", new_values);
+    add_timing("repeated_value", repeated_values);
+    add_timing("grain_value", grain_values);
+    results.add(juce::var(result));
+  }
+
+  auto *report = new juce::DynamicObject();
+  report->setProperty("parameters", int(TOTAL_NUMBER_PARAMETERS));
+  report->setProperty("texts_checked", checked);
+  report->setProperty("mismatches", mismatches);
+  report->setProperty("seconds_per_run", seconds);
+  report->setProperty("results", results);
+  const auto json = juce::JSON::toString(juce::var(report));
+
+  if (output_path.isNotEmpty()) {
+    if (!juce::File::getCurrentWorkingDirectory().getChildFile(output_path).replaceWithText(json)) {
+      std::cerr << "could not write " << output_path << std::endl;
+      return 1;
+    }
+  } else {
+    std::cout << json << std::endl;
+  }
+
+  if (mismatches > 0) {
+    std::cerr << mismatches << " texts differ from the old formatter's" << std::endl;
+    return 3;
+  }
+  return 0;
+}
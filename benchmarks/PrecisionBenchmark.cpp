@@ -0,0 +1,216 @@
+// Sample precision benchmark
+//
+// Runs PluginProcessor three ways, and prints the cost of each as JSON:
+//   float             single precision, as before
+//   double_converted  a 64-bit host buffer converted to float and back around the
+//                     float processBlock, which is what hosts do for plugins
+//                     without double precision support
+//   double            the native double precision processBlock
+// and checks that the float and double outputs match within TOLERANCE. both
+// precisions run the gain through the fastest simd kernels this cpu has, which
+// the report names (see ../src/audio/GainKernels.h)
+//
+// usage: PrecisionBenchmark [--seconds=<audio seconds per run>] [--output=<file.json>]
+// exits with code 3 if the outputs differ by more than the tolerance
+//
+// build with: cmake -DBUILD_BENCHMARKS=ON ...
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <iostream>
+#include <vector>
+
+#include <juce_audio_processors/juce_audio_processors.h>
+#include <juce_events/juce_events.h>
+
+#include "../src/audio/GainKernels.h"
+#include "../src/parameters/StateManager.h"
+#include "../src/plugin/PluginProcessor.h"
+
+namespace {
+
+constexpr double SAMPLE_RATE = 48000.0;
+constexpr int NUM_CHANNELS = 2;
+const std::vector<int> BLOCK_SIZES{32, 128, 512, 2048};
+// values of the OVERSAMPLING property: 1x, and 4x to include the filters
+const std::vector<int> OVERSAMPLING_STAGES{0, 2};
+// largest difference allowed between the float and double outputs, for input in [-1, 1]
+constexpr double TOLERANCE = 1.0e-4;
+
+constexpr int MIN_CALLBACKS = 200;
+constexpr int WARMUP_CALLBACKS = 32;
+
+enum class Mode { Float, DoubleConverted, Double };
+
+const char *mode_name(Mode mode) {
+  switch (mode) {
+  case Mode::Float:
+    return "float";
+  case Mode::DoubleConverted:
+    return "double_converted";
+  case Mode::Double:
+    return "double";
+  }
+  return "";
+}
+
+struct Run {
+  juce::var json;
+  // every output sample of the run, for the accuracy check
+  std::vector<double> output;
+};
+
+//==============================================================================
+Run run(PluginProcessor &processor, Mode mode, int block_size, int oversampling_stages,
+        double seconds) {
+  processor.state->set_parameter(PARAM::OVERSAMPLING, float(oversampling_stages));
+  processor.setProcessingPrecision(mode == Mode::Double ? juce::AudioProcessor::doublePrecision
+                                                        : juce::AudioProcessor::singlePrecision);
+  processor.setPlayConfigDetails(NUM_CHANNELS, NUM_CHANNELS, SAMPLE_RATE, block_size);
+  processor.prepareToPlay(SAMPLE_RATE, block_size);
+  processor.reset();
+
+  const int num_callbacks =
+      std::max(MIN_CALLBACKS, int(std::ceil(seconds * SAMPLE_RATE / block_size)));
+  // the same noise for every mode, generated in double and rounded for the float run
+  juce::Random noise(42);
+  juce::AudioBuffer<double> input(NUM_CHANNELS, block_size * (WARMUP_CALLBACKS + num_callbacks));
+  for (int ch = 0; ch < NUM_CHANNELS; ++ch)
+    for (int i = 0; i < input.getNumSamples(); ++i)
+      input.setSample(ch, i, double(noise.nextFloat() * 2.0f - 1.0f));
+
+  juce::AudioBuffer<float> float_buffer(NUM_CHANNELS, block_size);
+  juce::AudioBuffer<double> double_buffer(NUM_CHANNELS, block_size);
+  juce::MidiBuffer midi;
+
+  Run result;
+  result.output.reserve(size_t(num_callbacks * block_size * NUM_CHANNELS));
+  std::vector<double> callback_ns;
+  callback_ns.reserve(size_t(num_callbacks));
+
+  using clock = std::chrono::steady_clock;
+  for (int callback = -WARMUP_CALLBACKS; callback < num_callbacks; ++callback) {
+    const int offset = (callback + WARMUP_CALLBACKS) * block_size;
+    for (int ch = 0; ch < NUM_CHANNELS; ++ch) {
+      const double *source = input.getReadPointer(ch, offset);
+      if (mode == Mode::Float)
+        for (int i = 0; i < block_size; ++i)
+          float_buffer.setSample(ch, i, float(source[i]));
+      else
+        double_buffer.copyFrom(ch, 0, source, block_size);
+    }
+
+    const auto start = clock::now();
+    if (mode == Mode::Float) {
+      processor.processBlock(float_buffer, midi);
+    } else if (mode == Mode::DoubleConverted) {
+      float_buffer.makeCopyOf(double_buffer, true);
+      processor.processBlock(float_buffer, midi);
+      double_buffer.makeCopyOf(float_buffer, true);
+    } else {
+      processor.processBlock(double_buffer, midi);
+    }
+    const auto end = clock::now();
+
+    if (callback >= 0) {
+      callback_ns.push_back(std::chrono::duration<double, std::nano>(end - start).count());
+      for (int ch = 0; ch < NUM_CHANNELS; ++ch)
+        for (int i = 0; i < block_size; ++i)
+          result.output.push_back(mode == Mode::Float ? double(float_buffer.getSample(ch, i))
+                                                      : double_buffer.getSample(ch, i));
+    }
+  }
+  processor.releaseResources();
+
+  double total_ns = 0.0;
+  for (auto ns : callback_ns)
+    total_ns += ns;
+  const double mean_ns = total_ns / double(callback_ns.size());
+  auto p99 = callback_ns.begin() + std::ptrdiff_t(double(callback_ns.size() - 1) * 0.99);
+  std::nth_element(callback_ns.begin(), p99, callback_ns.end());
+
+  auto *json = new juce::DynamicObject();
+  json->setProperty("mode", mode_name(mode));
+  json->setProperty("block_size", block_size);
+  json->setProperty("channels", NUM_CHANNELS);
+  json->setProperty("oversampling", 1 << oversampling_stages);
+  json->setProperty("callbacks", num_callbacks);
+  json->setProperty("ns_per_sample", total_ns / (double(num_callbacks) * block_size));
+  json->setProperty("mean_ns", mean_ns);
+  json->setProperty("p99_ns", *p99);
+  result.json = juce::var(json);
+  return result;
+}
+
+double max_difference(const std::vector<double> &a, const std::vector<double> &b) {
+  double difference = 0.0;
+  for (size_t i = 0; i < std::min(a.size(), b.size()); ++i)
+    difference = std::max(difference, std::abs(a[i] - b[i]));
+  return difference;
+}
+
+} // namespace
+
+//==============================================================================
+int main(int argc, char *argv[]) {
+  juce::ArgumentList args(argc, argv);
+  const double seconds =
+      args.containsOption("--seconds") ? args.getValueForOption("--seconds").getDoubleValue() : 1.0;
+  const juce::String output_path = args.getValueForOption("--output");
+
+  // the processor expects a message manager, like it would have inside a host.
+  // this runs on the message thread, so the OVERSAMPLING property is set right away
+  juce::ScopedJuceInitialiser_GUI juce_initialiser;
+
+  juce::Array<juce::var> results;
+  double worst_difference = 0.0;
+  {
+    PluginProcessor processor;
+    for (auto stages : OVERSAMPLING_STAGES)
+      for (auto block_size : BLOCK_SIZES) {
+        const auto single = run(processor, Mode::Float, block_size, stages, seconds);
+        const auto converted = run(processor, Mode::DoubleConverted, block_size, stages, seconds);
+        const auto native = run(processor, Mode::Double, block_size, stages, seconds);
+
+        const double difference = max_difference(single.output, native.output);
+        worst_difference = std::max(worst_difference, difference);
+        auto *native_json = native.json.getDynamicObject();
+        native_json->setProperty("max_difference_from_float", difference);
+        // how much the native path saves over converting around the float one
+        native_json->setProperty("speedup_over_converted",
+                                 double(converted.json["mean_ns"]) / double(native.json["mean_ns"]));
+        results.add(single.json);
+        results.add(converted.json);
+        results.add(native.json);
+      }
+  }
+
+  auto *report = new juce::DynamicObject();
+  report->setProperty("plugin", JucePlugin_Name);
+  report->setProperty("version", JucePlugin_VersionString);
+  report->setProperty("seconds_per_run", seconds);
+  report->setProperty("gain_kernels_float",
+                      nthn_utils::simd_level_name(gain_kernels::best<float>().level));
+  report->setProperty("gain_kernels_double",
+                      nthn_utils::simd_level_name(gain_kernels::best<double>().level));
+  report->setProperty("tolerance", TOLERANCE);
+  report->setProperty("max_difference", worst_difference);
+  report->setProperty("results", results);
+  const auto json = juce::JSON::toString(juce::var(report));
+
+  if (output_path.isNotEmpty()) {
+    if (!juce::File::getCurrentWorkingDirectory().getChildFile(output_path).replaceWithText(json)) {
+      std::cerr << "could not write " << output_path << std::endl;
+      return 1;
+    }
+  } else {
+    std::cout << json << std::endl;
+  }
+
+  if (worst_difference > TOLERANCE) {
+    std::cerr << "float and double outputs differ by " << worst_difference << std::endl;
+    return 3;
+  }
+  return 0;
+}
@@ -0,0 +1,224 @@
+// Headless processBlock benchmark
+//
+// Runs PluginProcessor without an editor over a grid of sample rates, block
+// sizes and channel counts, and prints the cost of each configuration as JSON
+//
+// usage: ProcessBlockBenchmark [--seconds=<audio seconds per run>] [--output=<file.json>]
+//                              [--meter]
+// --meter turns on the output metering, as if the editor were open
+//
+// build with: cmake -DBUILD_BENCHMARKS=ON ...
+// with -DRT_SAFETY_CHECKS=ON as well, the benchmark also fails (exit code 2) if
+// processBlock allocates or locks
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <iostream>
+#include <thread>
+#include <vector>
+
+#include <juce_audio_processors/juce_audio_processors.h>
+#include <juce_events/juce_events.h>
+
+#include "../src/Util/RealtimeSafety.h"
+#include "../src/audio/AudioMeter.h"
+#include "../src/plugin/PluginProcessor.h"
+
+namespace {
+
+const std::vector<double> SAMPLE_RATES{44100.0, 48000.0, 96000.0, 192000.0};
+const std::vector<int> BLOCK_SIZES{1, 16, 32, 64, 128, 256, 512, 1024, 2048, 4096};
+const std::vector<int> CHANNEL_COUNTS{1, 2};
+
+// every run processes at least this many callbacks, so tiny runs still have a p99
+constexpr int MIN_CALLBACKS = 200;
+// callbacks processed before timing starts, to settle caches and smoothing
+constexpr int WARMUP_CALLBACKS = 32;
+
+enum class Scenario { Static, Automated, Random, Silent };
+
+const char *scenario_name(Scenario scenario) {
+  switch (scenario) {
+  case Scenario::Static:
+    return "static";
+  case Scenario::Automated:
+    return "automated";
+  case Scenario::Random:
+    return "random";
+  case Scenario::Silent:
+    return "silent";
+  }
+  return "";
+}
+
+struct Config {
+  Scenario scenario;
+  double sample_rate;
+  int block_size;
+  int num_channels;
+};
+
+//==============================================================================
+// host-side parameter changes before each callback, like a DAW playing back
+// automation. these arrive on the audio thread, so they are applied at the
+// start of the block
+//==============================================================================
+class ParameterDriver {
+public:
+  explicit ParameterDriver(juce::AudioProcessor &processor) : rng(1234) {
+    for (auto *param : processor.getParameters())
+      if (param->isAutomatable())
+        params.push_back(param);
+  }
+
+  void reset_to_defaults() {
+    for (auto *param : params)
+      param->setValueNotifyingHost(param->getDefaultValue());
+  }
+
+  void before_callback(Scenario scenario, int callback, const Config &config) {
+    if (scenario == Scenario::Automated) {
+      // a slow sine sweep on every parameter, out of phase with each other
+      const double seconds = double(callback) * config.block_size / config.sample_rate;
+      for (size_t p = 0; p < params.size(); ++p) {
+        const double phase = juce::MathConstants<double>::twoPi * (0.5 * seconds + 0.1 * double(p));
+        params[p]->setValueNotifyingHost(float(0.5 + 0.5 * std::sin(phase)));
+      }
+    } else if (scenario == Scenario::Random && !params.empty()) {
+      // a few jumps to random values on random parameters
+      const int num_changes = rng.nextInt(4);
+      for (int c = 0; c < num_changes; ++c)
+        params[size_t(rng.nextInt(int(params.size())))]->setValueNotifyingHost(rng.nextFloat());
+    }
+  }
+
+private:
+  std::vector<juce::AudioProcessorParameter *> params;
+  juce::Random rng;
+};
+
+//==============================================================================
+juce::var run(PluginProcessor &processor, const Config &config, double seconds) {
+  processor.setPlayConfigDetails(config.num_channels, config.num_channels, config.sample_rate,
+                                 config.block_size);
+  processor.prepareToPlay(config.sample_rate, config.block_size);
+  processor.reset();
+
+  ParameterDriver driver(processor);
+  driver.reset_to_defaults();
+
+  // the input is refilled from here before every callback, outside the timed region
+  juce::AudioBuffer<float> input(config.num_channels, config.block_size);
+  // silent input lets the processor skip its dsp once the tails have played out
+  juce::Random noise(42);
+  input.clear();
+  if (config.scenario != Scenario::Silent)
+    for (int ch = 0; ch < config.num_channels; ++ch)
+      for (int i = 0; i < config.block_size; ++i)
+        input.setSample(ch, i, noise.nextFloat() * 2.0f - 1.0f);
+
+  juce::AudioBuffer<float> buffer(config.num_channels, config.block_size);
+  juce::MidiBuffer midi;
+
+  const int num_callbacks =
+      std::max(MIN_CALLBACKS, int(std::ceil(seconds * config.sample_rate / config.block_size)));
+  std::vector<double> callback_ns;
+  callback_ns.reserve(size_t(num_callbacks));
+
+  using clock = std::chrono::steady_clock;
+  for (int callback = -WARMUP_CALLBACKS; callback < num_callbacks; ++callback) {
+    for (int ch = 0; ch < config.num_channels; ++ch)
+      buffer.copyFrom(ch, 0, input, ch, 0, config.block_size);
+    driver.before_callback(config.scenario, callback, config);
+
+    const auto start = clock::now();
+    processor.processBlock(buffer, midi);
+    const auto end = clock::now();
+
+    if (callback >= 0)
+      callback_ns.push_back(std::chrono::duration<double, std::nano>(end - start).count());
+  }
+  processor.releaseResources();
+
+  double total_ns = 0.0;
+  for (auto ns : callback_ns)
+    total_ns += ns;
+  const double mean_ns = total_ns / double(callback_ns.size());
+  const double max_ns = *std::max_element(callback_ns.begin(), callback_ns.end());
+  auto p99 = callback_ns.begin() + std::ptrdiff_t(double(callback_ns.size() - 1) * 0.99);
+  std::nth_element(callback_ns.begin(), p99, callback_ns.end());
+
+  auto *result = new juce::DynamicObject();
+  result->setProperty("scenario", scenario_name(config.scenario));
+  result->setProperty("sample_rate", config.sample_rate);
+  result->setProperty("block_size", config.block_size);
+  result->setProperty("channels", config.num_channels);
+  result->setProperty("callbacks", num_callbacks);
+  result->setProperty("ns_per_sample", total_ns / (double(num_callbacks) * config.block_size));
+  result->setProperty("mean_ns", mean_ns);
+  result->setProperty("p99_ns", *p99);
+  result->setProperty("max_ns", max_ns);
+  // share of the real-time budget used by the average callback
+  result->setProperty("realtime_load", mean_ns * 1.0e-9 * config.sample_rate / config.block_size);
+  return juce::var(result);
+}
+
+} // namespace
+
+//==============================================================================
+int main(int argc, char *argv[]) {
+  juce::ArgumentList args(argc, argv);
+  const double seconds =
+      args.containsOption("--seconds") ? args.getValueForOption("--seconds").getDoubleValue() : 1.0;
+  const juce::String output_path = args.getValueForOption("--output");
+  const bool meter = args.containsOption("--meter");
+
+  // the processor expects a message manager, like it would have inside a host
+  juce::ScopedJuceInitialiser_GUI juce_initialiser;
+
+  juce::Array<juce::var> results;
+  // process on a separate thread, so parameter changes look like host automation
+  // rather than UI edits from the message thread
+  std::thread audio_thread([&] {
+    PluginProcessor processor;
+    // nothing drains the frames here, so once the ring is full they are
+    // dropped, which costs the audio thread the same as pushing them
+    processor.audio_meter->set_enabled(meter);
+    for (auto scenario :
+         {Scenario::Static, Scenario::Automated, Scenario::Random, Scenario::Silent})
+      for (auto sample_rate : SAMPLE_RATES)
+        for (auto block_size : BLOCK_SIZES)
+          for (auto num_channels : CHANNEL_COUNTS)
+            results.add(run(processor, {scenario, sample_rate, block_size, num_channels}, seconds));
+  });
+  audio_thread.join();
+
+  rt_safety::dump_violations();
+  const auto num_violations = rt_safety::total_violations();
+
+  auto *report = new juce::DynamicObject();
+  report->setProperty("plugin", JucePlugin_Name);
+  report->setProperty("version", JucePlugin_VersionString);
+  report->setProperty("seconds_per_run", seconds);
+  report->setProperty("metering", meter);
+  report->setProperty("rt_safety_checks", bool(NTHN_RT_SAFETY_CHECKS));
+  report->setProperty("rt_safety_violations", juce::int64(num_violations));
+  report->setProperty("results", results);
+  const auto json = juce::JSON::toString(juce::var(report));
+
+  if (output_path.isNotEmpty()) {
+    if (!juce::File::getCurrentWorkingDirectory().getChildFile(output_path).replaceWithText(json)) {
+      std::cerr << "could not write " << output_path << std::endl;
+      return 1;
+    }
+  } else {
+    std::cout << json << std::endl;
+  }
+
+  if (num_violations > 0) {
+    std::cerr << num_violations << " real-time safety violations in processBlock" << std::endl;
+    return 2;
+  }
+  return 0;
+}
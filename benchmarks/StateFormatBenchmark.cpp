@@ -0,0 +1,150 @@
+// State format benchmark
+//
+// Compares saving and loading the plugin state in the binary format from
+// StateFormat.h with the XML it replaced (ValueTree -> XmlElement ->
+// copyXmlToBinary, and back through getXmlFromBinary). for each format it
+// times:
+//   save   serializing the current state, after an edit
+//   parse  turning the saved data back into a STATE ValueTree
+//   load   setStateInformation() with the saved data, the whole host round trip
+// and prints the time per call and the size of the data as JSON. the cached
+// save (getStateInformation() with no edit since the last one) is timed too
+//
+// usage: StateFormatBenchmark [--seconds=<seconds per timing>] [--output=<file.json>]
+//
+// build with: cmake -DBUILD_BENCHMARKS=ON ...
+
+#include <chrono>
+#include <iostream>
+#include <memory>
+
+#include <juce_audio_processors/juce_audio_processors.h>
+#include <juce_events/juce_events.h>
+
+#include "../src/parameters/StateFormat.h"
+#include "../src/parameters/StateManager.h"
+#include "../src/plugin/PluginProcessor.h"
+
+namespace {
+
+// microseconds per call of fn(), over seconds of calls. before_call() runs
+// before every call and is not timed
+template <typename Fn, typename BeforeCallFn>
+double time_per_call(Fn &&fn, BeforeCallFn &&before_call, double seconds) {
+  using clock = std::chrono::steady_clock;
+  double total_seconds = 0.0;
+  long long calls = 0;
+  for (int i = 0; i < 8; ++i) // warm up
+    fn();
+  while (total_seconds < seconds || calls < 16) {
+    before_call();
+    const auto start = clock::now();
+    fn();
+    total_seconds += std::chrono::duration<double>(clock::now() - start).count();
+    ++calls;
+  }
+  return 1.0e6 * total_seconds / double(calls);
+}
+
+// the state as the plugin saved it before the binary format
+void write_xml(const juce::ValueTree &tree, juce::MemoryBlock &dest_data) {
+  std::unique_ptr<juce::XmlElement> xml(tree.createXml());
+  juce::AudioProcessor::copyXmlToBinary(*xml, dest_data);
+}
+
+juce::ValueTree read_xml(const juce::MemoryBlock &data) {
+  std::unique_ptr<juce::XmlElement> xml(
+      juce::AudioProcessor::getXmlFromBinary(data.getData(), int(data.getSize())));
+  return xml != nullptr ? juce::ValueTree::fromXml(*xml) : juce::ValueTree();
+}
+
+} // namespace
+
+//==============================================================================
+int main(int argc, char *argv[]) {
+  juce::ArgumentList args(argc, argv);
+  const double seconds =
+      args.containsOption("--seconds") ? args.getValueForOption("--seconds").getDoubleValue() : 0.5;
+  const juce::String output_path = args.getValueForOption("--output");
+
+  // the processor expects a message manager, like it would have inside a host.
+  // this runs on the message thread, so edits are applied right away
+  juce::ScopedJuceInitialiser_GUI juce_initialiser;
+  PluginProcessor processor;
+  auto &state = *processor.state;
+  juce::Random rng(1234);
+
+  // an edit before every save, so neither format can reuse the last one
+  auto edit = [&] {
+    state.set_parameter_normalized(size_t(rng.nextInt(int(TOTAL_NUMBER_PARAMETERS))),
+                                   rng.nextFloat());
+  };
+  auto no_edit = [] {};
+
+  juce::MemoryBlock xml_data, binary_data;
+  // the tree is fetched outside the timing, so the xml save is only the part
+  // the binary format replaced (get_state() is built from the binary snapshot)
+  juce::ValueTree tree;
+  const double xml_save_us = time_per_call([&] { write_xml(tree, xml_data); },
+                                           [&] {
+                                             edit();
+                                             tree = state.get_state();
+                                           },
+                                           seconds);
+  const double binary_save_us =
+      time_per_call([&] { processor.getStateInformation(binary_data); }, edit, seconds);
+  const double cached_save_us =
+      time_per_call([&] { processor.getStateInformation(binary_data); }, no_edit, seconds);
+
+  const double xml_parse_us = time_per_call(
+      [&] { juce::ignoreUnused(read_xml(xml_data).isValid()); }, no_edit, seconds);
+  const double binary_parse_us = time_per_call(
+      [&] {
+        juce::ignoreUnused(
+            state_format::read(binary_data.getData(), binary_data.getSize()).isValid());
+      },
+      no_edit, seconds);
+
+  // setStateInformation detects either format
+  const double xml_load_us = time_per_call(
+      [&] { processor.setStateInformation(xml_data.getData(), int(xml_data.getSize())); },
+      no_edit, seconds);
+  const double binary_load_us = time_per_call(
+      [&] { processor.setStateInformation(binary_data.getData(), int(binary_data.getSize())); },
+      no_edit, seconds);
+
+  juce::Array<juce::var> results;
+  auto add_result = [&](const char *format, size_t bytes, double save_us, double parse_us,
+                        double load_us) {
+    auto *result = new juce::DynamicObject();
+    result->setProperty("format", format);
+    result->setProperty("bytes", juce::int64(bytes));
+    result->setProperty("save_us", save_us);
+    result->setProperty("parse_us", parse_us);
+    result->setProperty("load_us", load_us);
+    results.add(juce::var(result));
+  };
+  add_result("xml", xml_data.getSize(), xml_save_us, xml_parse_us, xml_load_us);
+  add_result("binary", binary_data.getSize(), binary_save_us, binary_parse_us, binary_load_us);
+
+  auto *report = new juce::DynamicObject();
+  report->setProperty("plugin", JucePlugin_Name);
+  report->setProperty("parameters", int(TOTAL_NUMBER_PARAMETERS));
+  report->setProperty("seconds_per_run", seconds);
+  report->setProperty("cached_save_us", cached_save_us);
+  report->setProperty("save_speedup", xml_save_us / binary_save_us);
+  report->setProperty("parse_speedup", xml_parse_us / binary_parse_us);
+  report->setProperty("load_speedup", xml_load_us / binary_load_us);
+  report->setProperty("results", results);
+  const auto json = juce::JSON::toString(juce::var(report));
+
+  if (output_path.isNotEmpty()) {
+    if (!juce::File::getCurrentWorkingDirectory().getChildFile(output_path).replaceWithText(json)) {
+      std::cerr << "could not write " << output_path << std::endl;
+      return 1;
+    }
+  } else {
+    std::cout << json << std::endl;
+  }
+  return 0;
+}
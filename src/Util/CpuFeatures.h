@@ -0,0 +1,108 @@
+#pragma once
+
+//==============================================================================
+// Runtime instruction set detection, for choosing SIMD kernels
+// kernels for a wider instruction set are compiled per function with
+// NTHN_TARGET(...), so the rest of the plugin still builds for the baseline ISA
+//==============================================================================
+
+#if defined(__x86_64__) || defined(_M_X64) || defined(__i386__) || defined(_M_IX86)
+#define NTHN_X86 1
+#include <immintrin.h>
+#if defined(_MSC_VER) && !defined(__clang__)
+#include <intrin.h>
+#endif
+#else
+#define NTHN_X86 0
+#endif
+
+#include <cstddef>
+
+#if NTHN_X86 && (defined(__GNUC__) || defined(__clang__))
+#define NTHN_TARGET(isa) __attribute__((target(isa)))
+#else
+#define NTHN_TARGET(isa)
+#endif
+
+namespace nthn_utils {
+enum class SimdLevel { Scalar, SSE2, AVX2, AVX512 };
+
+inline const char *simd_level_name(SimdLevel level) {
+  switch (level) {
+  case SimdLevel::SSE2:
+    return "sse2";
+  case SimdLevel::AVX2:
+    return "avx2";
+  case SimdLevel::AVX512:
+    return "avx512";
+  default:
+    return "scalar";
+  }
+}
+
+// highest instruction set supported by this cpu (and os)
+inline SimdLevel detect_simd_level() {
+#if NTHN_X86
+#if defined(_MSC_VER) && !defined(__clang__)
+  int info[4];
+  __cpuid(info, 0);
+  const int max_leaf = info[0];
+  __cpuid(info, 1);
+  const bool sse2 = (info[3] & (1 << 26)) != 0;
+  const bool os_avx = (info[2] & (1 << 27)) != 0 && (info[2] & (1 << 28)) != 0;
+  const unsigned long long xcr0 = os_avx ? _xgetbv(0) : 0;
+  bool avx2 = false, avx512 = false;
+  if (max_leaf >= 7 && (xcr0 & 0x6) == 0x6) {
+    __cpuidex(info, 7, 0);
+    avx2 = (info[1] & (1 << 5)) != 0;
+    avx512 = (info[1] & (1 << 16)) != 0 && (xcr0 & 0xe6) == 0xe6;
+  }
+#else
+  __builtin_cpu_init();
+  const bool sse2 = __builtin_cpu_supports("sse2");
+  const bool avx2 = __builtin_cpu_supports("avx2");
+  const bool avx512 = __builtin_cpu_supports("avx512f");
+#endif
+  if (avx512) return SimdLevel::AVX512;
+  if (avx2) return SimdLevel::AVX2;
+  if (sse2) return SimdLevel::SSE2;
+#endif
+  return SimdLevel::Scalar;
+}
+
+//==============================================================================
+// Kernel tables
+// every kernel set (gain_kernels, fir_kernels, ...) lists its compiled in paths
+// in an array indexed by SimdLevel, scalar first, and picks from it with these
+//==============================================================================
+
+// the path for level, falls back to scalar when the simd paths are not compiled in
+template <typename Kernels, std::size_t NumPaths>
+const Kernels &kernels_for_level(const Kernels (&paths)[NumPaths], SimdLevel level) {
+  const auto index = std::size_t(level);
+  return paths[index < NumPaths ? index : 0];
+}
+} // namespace nthn_utils
+
+// defines scalar(), for_level() and best() of a kernel set templated on the
+// sample type, reading KernelTable<SampleType>::paths, with their float and
+// double instantiations. used in the kernel set's namespace
+#define NTHN_DEFINE_KERNEL_SET(KernelTable)                                                        \
+  template <typename SampleType> const Kernels<SampleType> &scalar() {                            \
+    return KernelTable<SampleType>::paths[0];                                                      \
+  }                                                                                                \
+  template <typename SampleType>                                                                   \
+  const Kernels<SampleType> &for_level(nthn_utils::SimdLevel level) {                              \
+    return nthn_utils::kernels_for_level(KernelTable<SampleType>::paths, level);                   \
+  }                                                                                                \
+  template <typename SampleType> const Kernels<SampleType> &best() {                              \
+    static const Kernels<SampleType> &kernels =                                                    \
+        for_level<SampleType>(nthn_utils::detect_simd_level());                                    \
+    return kernels;                                                                                \
+  }                                                                                                \
+  template const Kernels<float> &scalar<float>();                                                  \
+  template const Kernels<double> &scalar<double>();                                                \
+  template const Kernels<float> &for_level<float>(nthn_utils::SimdLevel);                          \
+  template const Kernels<double> &for_level<double>(nthn_utils::SimdLevel);                        \
+  template const Kernels<float> &best<float>();                                                    \
+  template const Kernels<double> &best<double>();
@@ -0,0 +1,163 @@
+#pragma once
+
+#include <cstdint>
+#include <cstring>
+
+//==============================================================================
+// Fast approximations of exp, log, pow, tanh and the decibel conversions, for
+// single precision values in hot loops (per-sample gains, smoothing
+// coefficients, meters...). no libm calls, no branches and no tables, so a loop
+// over them vectorises, and the same arithmetic is written out per instruction
+// set in MathKernels.h for whole arrays.
+//
+// exp2 splits x into an integer part, which goes straight into the exponent
+// bits, and a fraction in [0, 1) for a degree 5 polynomial. log2 does the
+// reverse: exponent bits, plus a degree 8 polynomial of the mantissa in
+// [sqrt(0.5), sqrt(2)). the others are built on these two.
+//
+// error against libm (evaluated in double), for float inputs over the given
+// range. the bounds are in fast_math_bounds below, checked by
+// benchmarks/FastMathBenchmark.cpp:
+//   fast_exp2(x)         x in [-126, 126]     relative 2e-7
+//   fast_exp(x)          x in [-87, 87]       relative 5e-6 (3e-7 for |x| < 1)
+//   fast_log2(x)         x >= FLT_MIN         absolute 1.5e-7 + relative 6e-8
+//   fast_log(x)          x >= FLT_MIN         absolute 1.5e-7 + relative 1.2e-7
+//   fast_pow(x, y)       |y * log2(x)| < 126  relative 2e-7 + 7e-8 * |y * log2(x)|
+//   fast_tanh(x)         any x                absolute 2e-7
+//   fast_db_to_gain(db)  db in [-150, 50]     relative 1e-6
+//   fast_gain_to_db(g)   g >= FLT_MIN         absolute 1e-6 + relative 1.2e-7
+// the relative error of exp grows with |x| only because x * log2(e) is rounded
+// to float before the exponential, which libm avoids.
+//
+// out of range inputs are clamped instead of producing inf, nan or denormals:
+// exp2 saturates at 2^-126 and 2^126, log2 (and so gain_to_db) of zero, negative
+// or denormal values is log2(FLT_MIN) = -126, and tanh is exactly +-1 for
+// |x| > 9. the clamps run before the float to int conversion, and map nan to
+// the low end of the range: exp2(nan) = 2^-126, log2(nan) = -126 and
+// tanh(nan) = -1, in every path (they compare like the simd max and min, which
+// return their second operand when one is nan). so no function ever returns nan
+//==============================================================================
+namespace nthn_utils {
+namespace fast_math_detail {
+inline float bits_to_float(std::int32_t bits) {
+  float x;
+  std::memcpy(&x, &bits, sizeof(x));
+  return x;
+}
+inline std::int32_t float_to_bits(float x) {
+  std::int32_t bits;
+  std::memcpy(&bits, &x, sizeof(bits));
+  return bits;
+}
+
+constexpr float EXP2_MIN = -126.0f;
+constexpr float EXP2_MAX = 126.0f;
+constexpr float MIN_NORMAL = 1.17549435e-38f; // FLT_MIN
+// bits of sqrt(0.5), the bottom of the mantissa range for log2
+constexpr std::int32_t SQRT_HALF_BITS = 0x3f3504f3;
+constexpr float TANH_MAX = 9.0f; // tanh(9) rounds to 1 in float
+
+constexpr float LOG2_E = 1.44269504f;
+constexpr float LN_2 = 0.693147181f;
+constexpr float DB_TO_LOG2 = 0.166096404f; // log2(10) / 20
+constexpr float LOG2_TO_DB = 6.02059991f;  // 20 * log10(2)
+
+// 2^f for f in [0, 1), fitted for relative error
+constexpr float EXP2_C5 = 0.00186713048f;
+constexpr float EXP2_C4 = 0.00901702918f;
+constexpr float EXP2_C3 = 0.0557999142f;
+constexpr float EXP2_C2 = 0.24016445f;
+constexpr float EXP2_C1 = 0.693151312f;
+constexpr float EXP2_C0 = 1.0f;
+
+// log2(1 + u) / u for u in [sqrt(0.5) - 1, sqrt(2) - 1], fitted for the
+// absolute error of log2(1 + u)
+constexpr float LOG2_C7 = -0.14574296f;
+constexpr float LOG2_C6 = 0.236889786f;
+constexpr float LOG2_C5 = -0.250069305f;
+constexpr float LOG2_C4 = 0.286707546f;
+constexpr float LOG2_C3 = -0.3600872f;
+constexpr float LOG2_C2 = 0.480939441f;
+constexpr float LOG2_C1 = -0.721357149f;
+constexpr float LOG2_C0 = 1.44269477f;
+} // namespace fast_math_detail
+
+// the documented error bound of a function: |error| <= absolute + relative * |exact|
+struct FastMathBound {
+  double absolute;
+  double relative;
+};
+namespace fast_math_bounds {
+constexpr FastMathBound EXP2{0.0, 2.0e-7};
+constexpr FastMathBound EXP{0.0, 5.0e-6};
+constexpr FastMathBound LOG2{1.5e-7, 6.0e-8};
+constexpr FastMathBound LOG{1.5e-7, 1.2e-7};
+constexpr FastMathBound TANH{2.0e-7, 0.0};
+constexpr FastMathBound DB_TO_GAIN{0.0, 1.0e-6};
+constexpr FastMathBound GAIN_TO_DB{1.0e-6, 1.2e-7};
+} // namespace fast_math_bounds
+
+// the operations below are in the same order as the simd paths in
+// MathKernels.cpp, keep them in sync
+
+inline float fast_exp2(float x) {
+  using namespace fast_math_detail;
+  // clamped first, the int conversion is undefined outside its range. nan fails
+  // the first compare and becomes EXP2_MIN
+  x = x > EXP2_MIN ? x : EXP2_MIN;
+  x = x < EXP2_MAX ? x : EXP2_MAX;
+  // floor, without the libm call
+  std::int32_t i = std::int32_t(x);
+  i -= float(i) > x ? 1 : 0;
+  const float f = x - float(i);
+  float p = EXP2_C5;
+  p = p * f + EXP2_C4;
+  p = p * f + EXP2_C3;
+  p = p * f + EXP2_C2;
+  p = p * f + EXP2_C1;
+  p = p * f + EXP2_C0;
+  return p * bits_to_float((i + 127) << 23);
+}
+
+inline float fast_log2(float x) {
+  using namespace fast_math_detail;
+  // nan becomes MIN_NORMAL
+  x = x > MIN_NORMAL ? x : MIN_NORMAL;
+  // x = 2^e * m with m in [sqrt(0.5), sqrt(2)), so log2(m) stays small and
+  // log2(1) is exactly 0. the shift is arithmetic on every supported compiler
+  const std::int32_t bits = float_to_bits(x) - SQRT_HALF_BITS;
+  const std::int32_t e = bits >> 23;
+  const float u = bits_to_float((bits & 0x007fffff) + SQRT_HALF_BITS) - 1.0f;
+  float p = LOG2_C7;
+  p = p * u + LOG2_C6;
+  p = p * u + LOG2_C5;
+  p = p * u + LOG2_C4;
+  p = p * u + LOG2_C3;
+  p = p * u + LOG2_C2;
+  p = p * u + LOG2_C1;
+  p = p * u + LOG2_C0;
+  return p * u + float(e);
+}
+
+inline float fast_exp(float x) { return fast_exp2(x * fast_math_detail::LOG2_E); }
+inline float fast_log(float x) { return fast_log2(x) * fast_math_detail::LN_2; }
+// x^y for x > 0
+inline float fast_pow(float x, float y) { return fast_exp2(y * fast_log2(x)); }
+
+inline float fast_tanh(float x) {
+  using namespace fast_math_detail;
+  // nan becomes -TANH_MAX
+  x = x > -TANH_MAX ? x : -TANH_MAX;
+  x = x < TANH_MAX ? x : TANH_MAX;
+  // (e^2x - 1) / (e^2x + 1)
+  const float e = fast_exp2(x * (2.0f * LOG2_E));
+  return (e - 1.0f) / (e + 1.0f);
+}
+
+inline float fast_db_to_gain(float db) {
+  return fast_exp2(db * fast_math_detail::DB_TO_LOG2);
+}
+inline float fast_gain_to_db(float gain) {
+  return fast_log2(gain) * fast_math_detail::LOG2_TO_DB;
+}
+} // namespace nthn_utils
@@ -0,0 +1,65 @@
+#pragma once
+
+#include <array>
+
+#include "Util.h"
+
+//==============================================================================
+// LookupTable
+// a function sampled at Size + 1 evenly spaced points over [min, max], read
+// back with linear interpolation. for smooth curves that cost more than a
+// FastMath.h approximation, or have no closed form (a measured saturation
+// curve, a parameter taper...).
+//
+// the interpolation error is at most step^2 / 8 * max|f''|, with
+// step = (max - min) / Size, plus float rounding. e.g. tanh over [-9, 9] with
+// Size 4096 is within 3e-6. inputs outside [min, max] are clamped.
+//
+// the table is a member array, so a LookupTable never allocates. build it on
+// the message thread (or as a static), then read it from any thread
+//
+// example:
+//   static const nthn_utils::LookupTable<4096> tanh_table(
+//       [](double x) { return std::tanh(x); }, -9.0f, 9.0f);
+//   tanh_table.process(samples, samples, numSamples);
+//==============================================================================
+namespace nthn_utils {
+template <int Size> class LookupTable {
+public:
+  static_assert(Size >= 1, "a table needs at least one segment");
+
+  // fn is called with a double in [min, max], Size + 1 times
+  template <typename Fn>
+  LookupTable(Fn &&fn, float min_, float max_)
+      : min(min_), max(max_), scale(float(Size) / (max_ - min_)) {
+    for (int i = 0; i <= Size; ++i)
+      table[size_t(i)] = float(fn(double(min_) + double(max_ - min_) * double(i) / double(Size)));
+  }
+
+  float operator()(float x) const {
+    x = x < min ? min : x;
+    x = x > max ? max : x;
+    const float position = (x - min) * scale;
+    int i = int(position);
+    // x == max lands on the last point, interpolate from the segment before it
+    i = i < Size - 1 ? i : Size - 1;
+    const float alpha = position - float(i);
+    return lerp(table[size_t(i)], table[size_t(i) + 1], alpha);
+  }
+
+  // output[i] = (*this)(input[i]), output may be the same array as input
+  void process(const float *input, float *output, int numSamples) const {
+    for (int i = 0; i < numSamples; ++i)
+      output[i] = (*this)(input[i]);
+  }
+
+  float get_min() const { return min; }
+  float get_max() const { return max; }
+
+private:
+  const float min;
+  const float max;
+  const float scale; // segments per unit of input
+  std::array<float, size_t(Size) + 1> table;
+};
+} // namespace nthn_utils
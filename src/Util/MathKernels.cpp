@@ -0,0 +1,302 @@
+#include "MathKernels.h"
+#include "FastMath.h"
+
+namespace math_kernels {
+namespace {
+using namespace nthn_utils::fast_math_detail;
+
+// the functions in the table, all of them are built on exp2 or log2
+enum class Op { Exp, Log, Pow, Tanh, DbToGain, GainToDb };
+
+//==============================================================================
+// scalar
+//==============================================================================
+template <Op op> inline float apply_scalar(float x, float exponent) {
+  if constexpr (op == Op::Exp)
+    return nthn_utils::fast_exp(x);
+  else if constexpr (op == Op::Log)
+    return nthn_utils::fast_log(x);
+  else if constexpr (op == Op::Pow)
+    return nthn_utils::fast_pow(x, exponent);
+  else if constexpr (op == Op::Tanh)
+    return nthn_utils::fast_tanh(x);
+  else if constexpr (op == Op::DbToGain)
+    return nthn_utils::fast_db_to_gain(x);
+  else
+    return nthn_utils::fast_gain_to_db(x);
+}
+
+template <Op op>
+void map_scalar(const float *input, float exponent, float *output, int numSamples) {
+  for (int i = 0; i < numSamples; ++i)
+    output[i] = apply_scalar<op>(input[i], exponent);
+}
+
+#if NTHN_X86
+//==============================================================================
+// SSE2. there is no floor before SSE4.1, so exp2 truncates and steps back
+// where that rounded up, like the scalar path
+//==============================================================================
+NTHN_TARGET("sse2")
+inline __m128 exp2_sse2(__m128 x) {
+  x = _mm_max_ps(x, _mm_set1_ps(EXP2_MIN));
+  x = _mm_min_ps(x, _mm_set1_ps(EXP2_MAX));
+  __m128i i = _mm_cvttps_epi32(x);
+  // the compare mask is -1 where truncation rounded up
+  i = _mm_add_epi32(i, _mm_castps_si128(_mm_cmpgt_ps(_mm_cvtepi32_ps(i), x)));
+  const __m128 f = _mm_sub_ps(x, _mm_cvtepi32_ps(i));
+  __m128 p = _mm_set1_ps(EXP2_C5);
+  p = _mm_add_ps(_mm_mul_ps(p, f), _mm_set1_ps(EXP2_C4));
+  p = _mm_add_ps(_mm_mul_ps(p, f), _mm_set1_ps(EXP2_C3));
+  p = _mm_add_ps(_mm_mul_ps(p, f), _mm_set1_ps(EXP2_C2));
+  p = _mm_add_ps(_mm_mul_ps(p, f), _mm_set1_ps(EXP2_C1));
+  p = _mm_add_ps(_mm_mul_ps(p, f), _mm_set1_ps(EXP2_C0));
+  const __m128i scale = _mm_slli_epi32(_mm_add_epi32(i, _mm_set1_epi32(127)), 23);
+  return _mm_mul_ps(p, _mm_castsi128_ps(scale));
+}
+
+NTHN_TARGET("sse2")
+inline __m128 log2_sse2(__m128 x) {
+  x = _mm_max_ps(x, _mm_set1_ps(MIN_NORMAL));
+  const __m128i sqrt_half = _mm_set1_epi32(SQRT_HALF_BITS);
+  const __m128i bits = _mm_sub_epi32(_mm_castps_si128(x), sqrt_half);
+  const __m128 e = _mm_cvtepi32_ps(_mm_srai_epi32(bits, 23));
+  const __m128i mantissa =
+      _mm_add_epi32(_mm_and_si128(bits, _mm_set1_epi32(0x007fffff)), sqrt_half);
+  const __m128 u = _mm_sub_ps(_mm_castsi128_ps(mantissa), _mm_set1_ps(1.0f));
+  __m128 p = _mm_set1_ps(LOG2_C7);
+  p = _mm_add_ps(_mm_mul_ps(p, u), _mm_set1_ps(LOG2_C6));
+  p = _mm_add_ps(_mm_mul_ps(p, u), _mm_set1_ps(LOG2_C5));
+  p = _mm_add_ps(_mm_mul_ps(p, u), _mm_set1_ps(LOG2_C4));
+  p = _mm_add_ps(_mm_mul_ps(p, u), _mm_set1_ps(LOG2_C3));
+  p = _mm_add_ps(_mm_mul_ps(p, u), _mm_set1_ps(LOG2_C2));
+  p = _mm_add_ps(_mm_mul_ps(p, u), _mm_set1_ps(LOG2_C1));
+  p = _mm_add_ps(_mm_mul_ps(p, u), _mm_set1_ps(LOG2_C0));
+  return _mm_add_ps(_mm_mul_ps(p, u), e);
+}
+
+template <Op op> NTHN_TARGET("sse2") inline __m128 apply_sse2(__m128 x, __m128 exponent) {
+  if constexpr (op == Op::Exp) {
+    return exp2_sse2(_mm_mul_ps(x, _mm_set1_ps(LOG2_E)));
+  } else if constexpr (op == Op::Log) {
+    return _mm_mul_ps(log2_sse2(x), _mm_set1_ps(LN_2));
+  } else if constexpr (op == Op::Pow) {
+    return exp2_sse2(_mm_mul_ps(exponent, log2_sse2(x)));
+  } else if constexpr (op == Op::Tanh) {
+    x = _mm_max_ps(x, _mm_set1_ps(-TANH_MAX));
+    x = _mm_min_ps(x, _mm_set1_ps(TANH_MAX));
+    const __m128 e = exp2_sse2(_mm_mul_ps(x, _mm_set1_ps(2.0f * LOG2_E)));
+    const __m128 one = _mm_set1_ps(1.0f);
+    return _mm_div_ps(_mm_sub_ps(e, one), _mm_add_ps(e, one));
+  } else if constexpr (op == Op::DbToGain) {
+    return exp2_sse2(_mm_mul_ps(x, _mm_set1_ps(DB_TO_LOG2)));
+  } else {
+    return _mm_mul_ps(log2_sse2(x), _mm_set1_ps(LOG2_TO_DB));
+  }
+}
+
+template <Op op>
+NTHN_TARGET("sse2")
+void map_sse2(const float *input, float exponent, float *output, int numSamples) {
+  const __m128 y = _mm_set1_ps(exponent);
+  int i = 0;
+  for (; i + 4 <= numSamples; i += 4)
+    _mm_storeu_ps(output + i, apply_sse2<op>(_mm_loadu_ps(input + i), y));
+  for (; i < numSamples; ++i)
+    output[i] = apply_scalar<op>(input[i], exponent);
+}
+
+//==============================================================================
+// AVX2
+//==============================================================================
+NTHN_TARGET("avx2")
+inline __m256 exp2_avx2(__m256 x) {
+  x = _mm256_max_ps(x, _mm256_set1_ps(EXP2_MIN));
+  x = _mm256_min_ps(x, _mm256_set1_ps(EXP2_MAX));
+  const __m256 floor = _mm256_floor_ps(x);
+  const __m256i i = _mm256_cvttps_epi32(floor);
+  const __m256 f = _mm256_sub_ps(x, floor);
+  __m256 p = _mm256_set1_ps(EXP2_C5);
+  p = _mm256_add_ps(_mm256_mul_ps(p, f), _mm256_set1_ps(EXP2_C4));
+  p = _mm256_add_ps(_mm256_mul_ps(p, f), _mm256_set1_ps(EXP2_C3));
+  p = _mm256_add_ps(_mm256_mul_ps(p, f), _mm256_set1_ps(EXP2_C2));
+  p = _mm256_add_ps(_mm256_mul_ps(p, f), _mm256_set1_ps(EXP2_C1));
+  p = _mm256_add_ps(_mm256_mul_ps(p, f), _mm256_set1_ps(EXP2_C0));
+  const __m256i scale = _mm256_slli_epi32(_mm256_add_epi32(i, _mm256_set1_epi32(127)), 23);
+  return _mm256_mul_ps(p, _mm256_castsi256_ps(scale));
+}
+
+NTHN_TARGET("avx2")
+inline __m256 log2_avx2(__m256 x) {
+  x = _mm256_max_ps(x, _mm256_set1_ps(MIN_NORMAL));
+  const __m256i sqrt_half = _mm256_set1_epi32(SQRT_HALF_BITS);
+  const __m256i bits = _mm256_sub_epi32(_mm256_castps_si256(x), sqrt_half);
+  const __m256 e = _mm256_cvtepi32_ps(_mm256_srai_epi32(bits, 23));
+  const __m256i mantissa =
+      _mm256_add_epi32(_mm256_and_si256(bits, _mm256_set1_epi32(0x007fffff)), sqrt_half);
+  const __m256 u = _mm256_sub_ps(_mm256_castsi256_ps(mantissa), _mm256_set1_ps(1.0f));
+  __m256 p = _mm256_set1_ps(LOG2_C7);
+  p = _mm256_add_ps(_mm256_mul_ps(p, u), _mm256_set1_ps(LOG2_C6));
+  p = _mm256_add_ps(_mm256_mul_ps(p, u), _mm256_set1_ps(LOG2_C5));
+  p = _mm256_add_ps(_mm256_mul_ps(p, u), _mm256_set1_ps(LOG2_C4));
+  p = _mm256_add_ps(_mm256_mul_ps(p, u), _mm256_set1_ps(LOG2_C3));
+  p = _mm256_add_ps(_mm256_mul_ps(p, u), _mm256_set1_ps(LOG2_C2));
+  p = _mm256_add_ps(_mm256_mul_ps(p, u), _mm256_set1_ps(LOG2_C1));
+  p = _mm256_add_ps(_mm256_mul_ps(p, u), _mm256_set1_ps(LOG2_C0));
+  return _mm256_add_ps(_mm256_mul_ps(p, u), e);
+}
+
+template <Op op> NTHN_TARGET("avx2") inline __m256 apply_avx2(__m256 x, __m256 exponent) {
+  if constexpr (op == Op::Exp) {
+    return exp2_avx2(_mm256_mul_ps(x, _mm256_set1_ps(LOG2_E)));
+  } else if constexpr (op == Op::Log) {
+    return _mm256_mul_ps(log2_avx2(x), _mm256_set1_ps(LN_2));
+  } else if constexpr (op == Op::Pow) {
+    return exp2_avx2(_mm256_mul_ps(exponent, log2_avx2(x)));
+  } else if constexpr (op == Op::Tanh) {
+    x = _mm256_max_ps(x, _mm256_set1_ps(-TANH_MAX));
+    x = _mm256_min_ps(x, _mm256_set1_ps(TANH_MAX));
+    const __m256 e = exp2_avx2(_mm256_mul_ps(x, _mm256_set1_ps(2.0f * LOG2_E)));
+    const __m256 one = _mm256_set1_ps(1.0f);
+    return _mm256_div_ps(_mm256_sub_ps(e, one), _mm256_add_ps(e, one));
+  } else if constexpr (op == Op::DbToGain) {
+    return exp2_avx2(_mm256_mul_ps(x, _mm256_set1_ps(DB_TO_LOG2)));
+  } else {
+    return _mm256_mul_ps(log2_avx2(x), _mm256_set1_ps(LOG2_TO_DB));
+  }
+}
+
+template <Op op>
+NTHN_TARGET("avx2")
+void map_avx2(const float *input, float exponent, float *output, int numSamples) {
+  const __m256 y = _mm256_set1_ps(exponent);
+  int i = 0;
+  for (; i + 8 <= numSamples; i += 8)
+    _mm256_storeu_ps(output + i, apply_avx2<op>(_mm256_loadu_ps(input + i), y));
+  for (; i < numSamples; ++i)
+    output[i] = apply_scalar<op>(input[i], exponent);
+}
+
+//==============================================================================
+// AVX-512, the tail is handled with a masked load/store.
+// the maskz forms with every lane set do the same as the plain max, min,
+// roundscale, conversions and shifts, which trip a false -Wmaybe-uninitialized
+// in gcc's headers
+//==============================================================================
+constexpr __mmask16 ALL_LANES = 0xffff;
+
+NTHN_TARGET("avx512f")
+inline __m512 exp2_avx512(__m512 x) {
+  x = _mm512_maskz_max_ps(ALL_LANES, x, _mm512_set1_ps(EXP2_MIN));
+  x = _mm512_maskz_min_ps(ALL_LANES, x, _mm512_set1_ps(EXP2_MAX));
+  const __m512 floor =
+      _mm512_maskz_roundscale_ps(ALL_LANES, x, _MM_FROUND_TO_NEG_INF | _MM_FROUND_NO_EXC);
+  const __m512i i = _mm512_maskz_cvttps_epi32(ALL_LANES, floor);
+  const __m512 f = _mm512_sub_ps(x, floor);
+  __m512 p = _mm512_set1_ps(EXP2_C5);
+  p = _mm512_add_ps(_mm512_mul_ps(p, f), _mm512_set1_ps(EXP2_C4));
+  p = _mm512_add_ps(_mm512_mul_ps(p, f), _mm512_set1_ps(EXP2_C3));
+  p = _mm512_add_ps(_mm512_mul_ps(p, f), _mm512_set1_ps(EXP2_C2));
+  p = _mm512_add_ps(_mm512_mul_ps(p, f), _mm512_set1_ps(EXP2_C1));
+  p = _mm512_add_ps(_mm512_mul_ps(p, f), _mm512_set1_ps(EXP2_C0));
+  const __m512i biased = _mm512_add_epi32(i, _mm512_set1_epi32(127));
+  const __m512i scale = _mm512_maskz_slli_epi32(ALL_LANES, biased, 23);
+  return _mm512_mul_ps(p, _mm512_castsi512_ps(scale));
+}
+
+NTHN_TARGET("avx512f")
+inline __m512 log2_avx512(__m512 x) {
+  x = _mm512_maskz_max_ps(ALL_LANES, x, _mm512_set1_ps(MIN_NORMAL));
+  const __m512i sqrt_half = _mm512_set1_epi32(SQRT_HALF_BITS);
+  const __m512i bits = _mm512_sub_epi32(_mm512_castps_si512(x), sqrt_half);
+  const __m512 e =
+      _mm512_maskz_cvtepi32_ps(ALL_LANES, _mm512_maskz_srai_epi32(ALL_LANES, bits, 23));
+  const __m512i mantissa =
+      _mm512_add_epi32(_mm512_and_si512(bits, _mm512_set1_epi32(0x007fffff)), sqrt_half);
+  const __m512 u = _mm512_sub_ps(_mm512_castsi512_ps(mantissa), _mm512_set1_ps(1.0f));
+  __m512 p = _mm512_set1_ps(LOG2_C7);
+  p = _mm512_add_ps(_mm512_mul_ps(p, u), _mm512_set1_ps(LOG2_C6));
+  p = _mm512_add_ps(_mm512_mul_ps(p, u), _mm512_set1_ps(LOG2_C5));
+  p = _mm512_add_ps(_mm512_mul_ps(p, u), _mm512_set1_ps(LOG2_C4));
+  p = _mm512_add_ps(_mm512_mul_ps(p, u), _mm512_set1_ps(LOG2_C3));
+  p = _mm512_add_ps(_mm512_mul_ps(p, u), _mm512_set1_ps(LOG2_C2));
+  p = _mm512_add_ps(_mm512_mul_ps(p, u), _mm512_set1_ps(LOG2_C1));
+  p = _mm512_add_ps(_mm512_mul_ps(p, u), _mm512_set1_ps(LOG2_C0));
+  return _mm512_add_ps(_mm512_mul_ps(p, u), e);
+}
+
+template <Op op> NTHN_TARGET("avx512f") inline __m512 apply_avx512(__m512 x, __m512 exponent) {
+  if constexpr (op == Op::Exp) {
+    return exp2_avx512(_mm512_mul_ps(x, _mm512_set1_ps(LOG2_E)));
+  } else if constexpr (op == Op::Log) {
+    return _mm512_mul_ps(log2_avx512(x), _mm512_set1_ps(LN_2));
+  } else if constexpr (op == Op::Pow) {
+    return exp2_avx512(_mm512_mul_ps(exponent, log2_avx512(x)));
+  } else if constexpr (op == Op::Tanh) {
+    x = _mm512_maskz_max_ps(ALL_LANES, x, _mm512_set1_ps(-TANH_MAX));
+    x = _mm512_maskz_min_ps(ALL_LANES, x, _mm512_set1_ps(TANH_MAX));
+    const __m512 e = exp2_avx512(_mm512_mul_ps(x, _mm512_set1_ps(2.0f * LOG2_E)));
+    const __m512 one = _mm512_set1_ps(1.0f);
+    return _mm512_div_ps(_mm512_sub_ps(e, one), _mm512_add_ps(e, one));
+  } else if constexpr (op == Op::DbToGain) {
+    return exp2_avx512(_mm512_mul_ps(x, _mm512_set1_ps(DB_TO_LOG2)));
+  } else {
+    return _mm512_mul_ps(log2_avx512(x), _mm512_set1_ps(LOG2_TO_DB));
+  }
+}
+
+template <Op op>
+NTHN_TARGET("avx512f")
+void map_avx512(const float *input, float exponent, float *output, int numSamples) {
+  const __m512 y = _mm512_set1_ps(exponent);
+  int i = 0;
+  for (; i + 16 <= numSamples; i += 16)
+    _mm512_storeu_ps(output + i, apply_avx512<op>(_mm512_loadu_ps(input + i), y));
+  if (i < numSamples) {
+    // the masked off lanes are computed from zeros, which is in range for all ops
+    const __mmask16 mask = __mmask16((1u << (numSamples - i)) - 1u);
+    _mm512_mask_storeu_ps(output + i, mask,
+                          apply_avx512<op>(_mm512_maskz_loadu_ps(mask, input + i), y));
+  }
+}
+#endif
+
+//==============================================================================
+// the table entries. pow passes its exponent through, the others ignore it
+//==============================================================================
+using MapFn = void (*)(const float *input, float exponent, float *output, int numSamples);
+
+template <MapFn map> void unary(const float *input, float *output, int numSamples) {
+  map(input, 0.0f, output, numSamples);
+}
+
+// every compiled in path, indexed by SimdLevel
+constexpr Kernels paths[] = {
+    {unary<map_scalar<Op::Exp>>, unary<map_scalar<Op::Log>>, map_scalar<Op::Pow>,
+     unary<map_scalar<Op::Tanh>>, unary<map_scalar<Op::DbToGain>>,
+     unary<map_scalar<Op::GainToDb>>, nthn_utils::SimdLevel::Scalar},
+#if NTHN_X86
+    {unary<map_sse2<Op::Exp>>, unary<map_sse2<Op::Log>>, map_sse2<Op::Pow>,
+     unary<map_sse2<Op::Tanh>>, unary<map_sse2<Op::DbToGain>>, unary<map_sse2<Op::GainToDb>>,
+     nthn_utils::SimdLevel::SSE2},
+    {unary<map_avx2<Op::Exp>>, unary<map_avx2<Op::Log>>, map_avx2<Op::Pow>,
+     unary<map_avx2<Op::Tanh>>, unary<map_avx2<Op::DbToGain>>, unary<map_avx2<Op::GainToDb>>,
+     nthn_utils::SimdLevel::AVX2},
+    {unary<map_avx512<Op::Exp>>, unary<map_avx512<Op::Log>>, map_avx512<Op::Pow>,
+     unary<map_avx512<Op::Tanh>>, unary<map_avx512<Op::DbToGain>>,
+     unary<map_avx512<Op::GainToDb>>, nthn_utils::SimdLevel::AVX512},
+#endif
+};
+} // namespace
+
+const Kernels &scalar() { return paths[0]; }
+
+const Kernels &for_level(nthn_utils::SimdLevel level) {
+  return nthn_utils::kernels_for_level(paths, level);
+}
+
+const Kernels &best() {
+  static const Kernels &kernels = for_level(nthn_utils::detect_simd_level());
+  return kernels;
+}
+} // namespace math_kernels
@@ -0,0 +1,35 @@
+#pragma once
+
+#include "CpuFeatures.h"
+
+//==============================================================================
+// The FastMath.h approximations over whole arrays, one set per instruction set
+// every path does the same operations per element as the scalar functions, so
+// all of them stay within the bounds documented there. the results are the same
+// to the bit, except where the compiler fuses a multiply and add (it does in the
+// avx-512 path). output may be the same array as input, for processing in place
+//==============================================================================
+namespace math_kernels {
+struct Kernels {
+  // output[i] = fast_exp(input[i])
+  void (*exp)(const float *input, float *output, int numSamples);
+  // output[i] = fast_log(input[i])
+  void (*log)(const float *input, float *output, int numSamples);
+  // output[i] = fast_pow(input[i], exponent)
+  void (*pow)(const float *input, float exponent, float *output, int numSamples);
+  // output[i] = fast_tanh(input[i])
+  void (*tanh)(const float *input, float *output, int numSamples);
+  // output[i] = fast_db_to_gain(input[i])
+  void (*db_to_gain)(const float *input, float *output, int numSamples);
+  // output[i] = fast_gain_to_db(input[i])
+  void (*gain_to_db)(const float *input, float *output, int numSamples);
+  nthn_utils::SimdLevel level;
+};
+
+// plain c++ reference path
+const Kernels &scalar();
+// kernels for a specific instruction set, falls back to scalar when not compiled in
+const Kernels &for_level(nthn_utils::SimdLevel level);
+// the fastest kernels this cpu supports, detected once
+const Kernels &best();
+} // namespace math_kernels
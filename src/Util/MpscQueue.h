@@ -0,0 +1,75 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+
+//==============================================================================
+// MpscQueue
+// bounded, lock-free, multi-producer single-consumer queue of Capacity items
+// (a power of 2), for threads that can't know who else pushes (parameter
+// listeners, audio and worker threads) handing fixed-size structs to one
+// consumer. each slot carries a sequence number that tells producers whether
+// it is free for this lap and the consumer whether it has been written, so
+// producers only contend on the compare-exchange of the write position.
+// neither side waits or allocates: push() returns false when full, and the
+// caller drops the item or notes it
+//==============================================================================
+namespace nthn_utils {
+template <typename Item, std::size_t Capacity> class MpscQueue {
+public:
+  static_assert((Capacity & (Capacity - 1)) == 0, "Capacity must be a power of 2");
+
+  MpscQueue() {
+    for (std::size_t i = 0; i < Capacity; ++i)
+      slots[i].sequence.store(i, std::memory_order_relaxed);
+  }
+  MpscQueue(const MpscQueue &) = delete;
+  MpscQueue &operator=(const MpscQueue &) = delete;
+
+  // called from any thread
+  bool push(const Item &item) {
+    auto position = write_position.load(std::memory_order_relaxed);
+    for (;;) {
+      auto &slot = slots[position & (Capacity - 1)];
+      const auto sequence = slot.sequence.load(std::memory_order_acquire);
+      const auto difference = std::ptrdiff_t(sequence) - std::ptrdiff_t(position);
+      if (difference == 0) {
+        if (write_position.compare_exchange_weak(position, position + 1,
+                                                 std::memory_order_relaxed)) {
+          slot.item = item;
+          slot.sequence.store(position + 1, std::memory_order_release);
+          return true;
+        }
+      } else if (difference < 0) {
+        return false; // full
+      } else {
+        // another producer took this slot
+        position = write_position.load(std::memory_order_relaxed);
+      }
+    }
+  }
+
+  // called from the consumer thread only
+  bool pop(Item &item) {
+    auto &slot = slots[read_position & (Capacity - 1)];
+    const auto sequence = slot.sequence.load(std::memory_order_acquire);
+    if (std::ptrdiff_t(sequence) - std::ptrdiff_t(read_position + 1) < 0)
+      return false; // empty, or the producer hasn't finished writing it
+    item = slot.item;
+    slot.sequence.store(read_position + Capacity, std::memory_order_release);
+    ++read_position;
+    return true;
+  }
+
+private:
+  struct Slot {
+    std::atomic<std::size_t> sequence;
+    Item item;
+  };
+  std::array<Slot, Capacity> slots;
+  alignas(64) std::atomic<std::size_t> write_position{0};
+  // consumer side
+  alignas(64) std::size_t read_position{0};
+};
+} // namespace nthn_utils
@@ -0,0 +1,128 @@
+#include "RealtimeSafety.h"
+
+#if NTHN_RT_SAFETY_CHECKS
+
+#include <atomic>
+#include <cstdlib>
+
+#include <juce_core/juce_core.h>
+
+#include "MpscQueue.h"
+
+#if JUCE_WINDOWS
+#include <windows.h>
+#else
+#include <execinfo.h>
+#endif
+
+// the allocator hooks read these, so they must never allocate themselves.
+// initial-exec TLS is reserved when the thread starts (the default model for a
+// dynamically loaded plugin can call malloc on the first access)
+#if defined(__GNUC__) || defined(__clang__)
+#define NTHN_RT_SAFETY_TLS thread_local __attribute__((tls_model("initial-exec")))
+#else
+#define NTHN_RT_SAFETY_TLS thread_local
+#endif
+
+namespace {
+static NTHN_RT_SAFETY_TLS int audio_scope_depth = 0;
+// set while a violation is being recorded, capturing the stack may allocate
+static NTHN_RT_SAFETY_TLS bool reporting = false;
+
+constexpr int MAX_FRAMES = 32;
+
+struct Violation {
+  rt_safety::ViolationKind kind;
+  std::size_t bytes;
+  int num_frames;
+  void *frames[MAX_FRAMES];
+};
+
+int capture_stack(void **frames, int max_frames) {
+#if JUCE_WINDOWS
+  return int(CaptureStackBackTrace(0, DWORD(max_frames), frames, nullptr));
+#else
+  return backtrace(frames, max_frames);
+#endif
+}
+
+// any audio thread (or worker) pushes, the message thread pops
+constexpr std::size_t VIOLATION_LOG_SIZE = 256; // must be a power of 2
+nthn_utils::MpscQueue<Violation, VIOLATION_LOG_SIZE> violation_log;
+std::atomic<std::uint64_t> violation_count{0};
+std::atomic<std::uint64_t> dropped_count{0};
+
+// the first stack capture loads the unwinder, do it before any audio thread needs it
+const int stack_capture_ready = [] {
+  void *frame;
+  return capture_stack(&frame, 1);
+}();
+
+const char *kind_name(rt_safety::ViolationKind kind) {
+  switch (kind) {
+  case rt_safety::ViolationKind::Allocation:
+    return "allocation";
+  case rt_safety::ViolationKind::Deallocation:
+    return "deallocation";
+  case rt_safety::ViolationKind::Lock:
+    return "mutex lock";
+  }
+  return "";
+}
+} // namespace
+
+//==============================================================================
+namespace rt_safety {
+
+ScopedAudioThread::ScopedAudioThread() { ++audio_scope_depth; }
+ScopedAudioThread::~ScopedAudioThread() { --audio_scope_depth; }
+
+bool is_audio_thread() { return audio_scope_depth > 0; }
+
+void report(ViolationKind kind, std::size_t bytes) {
+  if (audio_scope_depth == 0 || reporting)
+    return;
+  reporting = true;
+  violation_count.fetch_add(1, std::memory_order_relaxed);
+  Violation violation;
+  violation.kind = kind;
+  violation.bytes = bytes;
+  violation.num_frames = capture_stack(violation.frames, MAX_FRAMES);
+  if (!violation_log.push(violation))
+    dropped_count.fetch_add(1, std::memory_order_relaxed);
+  reporting = false;
+}
+
+std::uint64_t total_violations() { return violation_count.load(std::memory_order_relaxed); }
+
+int dump_violations() {
+  int num_dumped = 0;
+  Violation violation;
+  while (violation_log.pop(violation)) {
+    juce::String message = "real-time safety violation: ";
+    message << kind_name(violation.kind);
+    if (violation.bytes > 0)
+      message << " of " << juce::String(juce::int64(violation.bytes)) << " bytes";
+    message << " on the audio thread";
+#if JUCE_WINDOWS
+    for (int f = 0; f < violation.num_frames; ++f)
+      message << "\n  0x" << juce::String::toHexString(juce::pointer_sized_int(violation.frames[f]));
+#else
+    if (auto **symbols = backtrace_symbols(violation.frames, violation.num_frames)) {
+      for (int f = 0; f < violation.num_frames; ++f)
+        message << "\n  " << symbols[f];
+      std::free(symbols);
+    }
+#endif
+    juce::Logger::writeToLog(message);
+    ++num_dumped;
+  }
+  if (const auto dropped = dropped_count.exchange(0))
+    juce::Logger::writeToLog(juce::String(juce::int64(dropped)) +
+                             " more real-time safety violations were not logged");
+  return num_dumped;
+}
+
+} // namespace rt_safety
+
+#endif
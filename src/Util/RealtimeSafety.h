@@ -0,0 +1,96 @@
+#pragma once
+
+//==============================================================================
+// Real-time safety checks for the audio thread (opt-in, for debugging)
+//
+// configure with -DRT_SAFETY_CHECKS=ON to define NTHN_RT_SAFETY_CHECKS=1.
+// processBlock (and the channel group workers) mark themselves with a
+// ScopedAudioThread, and while that scope is active on a thread, every lock of
+// a CheckedMutex is recorded as a violation, with the call stack, into a
+// lock-free log. dump_violations() prints the log from the message thread.
+//
+// allocations are only caught in the benchmark executables, which also compile
+// RealtimeSafetyHooks.cpp: it replaces operator new/delete (and malloc/free on
+// glibc), which a plugin must not do to the host it is loaded into.
+//
+// with the checks off, ScopedAudioThread is empty, CheckedMutex<M> is M and
+// nothing is intercepted, so the checks cost nothing in release builds
+//==============================================================================
+
+#ifndef NTHN_RT_SAFETY_CHECKS
+#define NTHN_RT_SAFETY_CHECKS 0
+#endif
+
+#include <cstddef>
+#include <cstdint>
+
+namespace rt_safety {
+
+enum class ViolationKind { Allocation, Deallocation, Lock };
+
+#if NTHN_RT_SAFETY_CHECKS
+
+// marks the current thread as the audio thread until destroyed. scopes can nest
+class ScopedAudioThread {
+public:
+  ScopedAudioThread();
+  ~ScopedAudioThread();
+  ScopedAudioThread(const ScopedAudioThread &) = delete;
+  ScopedAudioThread &operator=(const ScopedAudioThread &) = delete;
+};
+
+// true inside a ScopedAudioThread on this thread
+bool is_audio_thread();
+// records a violation if called inside a ScopedAudioThread, callable from anywhere
+void report(ViolationKind kind, std::size_t bytes = 0);
+
+// a mutex that reports being locked on the audio thread
+template <typename Mutex> class CheckedMutex {
+public:
+  void lock() {
+    report(ViolationKind::Lock);
+    mutex.lock();
+  }
+  bool try_lock() {
+    report(ViolationKind::Lock);
+    return mutex.try_lock();
+  }
+  void unlock() { mutex.unlock(); }
+  void lock_shared() {
+    report(ViolationKind::Lock);
+    mutex.lock_shared();
+  }
+  bool try_lock_shared() {
+    report(ViolationKind::Lock);
+    return mutex.try_lock_shared();
+  }
+  void unlock_shared() { mutex.unlock_shared(); }
+
+private:
+  Mutex mutex;
+};
+
+// total violations since startup, callable from any thread
+std::uint64_t total_violations();
+// writes every logged violation (with symbolized stacks) to juce::Logger and
+// clears the log. returns the number written, called from the message thread
+int dump_violations();
+
+#else
+
+class ScopedAudioThread {
+public:
+  ScopedAudioThread() {}
+};
+
+inline bool is_audio_thread() { return false; }
+inline void report(ViolationKind, std::size_t = 0) {}
+
+template <typename Mutex> using CheckedMutex = Mutex;
+
+inline std::uint64_t total_violations() { return 0; }
+inline int dump_violations() { return 0; }
+
+#endif
+
+} // namespace rt_safety
@@ -0,0 +1,195 @@
+#include "RealtimeSafety.h"
+
+// the replaced allocation functions of the real-time safety checks. only the
+// benchmark executables compile this file (see CMakeLists.txt): a plugin must
+// not replace the allocator of the host it is loaded into
+
+#if NTHN_RT_SAFETY_CHECKS
+
+#include <cstdlib>
+#include <new>
+
+#include <juce_core/juce_core.h>
+
+// on glibc, malloc/free are replaced as well, forwarding to glibc's own entry points.
+// elsewhere only operator new/delete are checked
+#if defined(__GLIBC__)
+#define NTHN_RT_SAFETY_HOOK_MALLOC 1
+extern "C" {
+void *__libc_malloc(std::size_t size);
+void *__libc_calloc(std::size_t count, std::size_t size);
+void *__libc_realloc(void *ptr, std::size_t size);
+void *__libc_memalign(std::size_t alignment, std::size_t size);
+void __libc_free(void *ptr);
+}
+#else
+#define NTHN_RT_SAFETY_HOOK_MALLOC 0
+#endif
+
+namespace {
+//==============================================================================
+// the allocator behind the replaced operator new/delete
+//==============================================================================
+void *raw_malloc(std::size_t size) {
+#if NTHN_RT_SAFETY_HOOK_MALLOC
+  return __libc_malloc(size);
+#else
+  return std::malloc(size);
+#endif
+}
+
+void raw_free(void *ptr) {
+#if NTHN_RT_SAFETY_HOOK_MALLOC
+  __libc_free(ptr);
+#else
+  std::free(ptr);
+#endif
+}
+
+void *raw_aligned_malloc(std::size_t size, std::size_t alignment) {
+#if NTHN_RT_SAFETY_HOOK_MALLOC
+  return __libc_memalign(alignment, size);
+#elif JUCE_WINDOWS
+  return _aligned_malloc(size, alignment);
+#else
+  // aligned_alloc wants a multiple of the alignment
+  return std::aligned_alloc(alignment, (size + alignment - 1) / alignment * alignment);
+#endif
+}
+
+void raw_aligned_free(void *ptr) {
+#if JUCE_WINDOWS
+  _aligned_free(ptr);
+#else
+  raw_free(ptr);
+#endif
+}
+
+void *checked_new(std::size_t size) {
+  rt_safety::report(rt_safety::ViolationKind::Allocation, size);
+  if (size == 0)
+    size = 1;
+  for (;;) {
+    if (auto *ptr = raw_malloc(size))
+      return ptr;
+    if (auto handler = std::get_new_handler())
+      handler();
+    else
+      throw std::bad_alloc();
+  }
+}
+
+void *checked_aligned_new(std::size_t size, std::align_val_t alignment) {
+  rt_safety::report(rt_safety::ViolationKind::Allocation, size);
+  if (size == 0)
+    size = 1;
+  for (;;) {
+    if (auto *ptr = raw_aligned_malloc(size, std::size_t(alignment)))
+      return ptr;
+    if (auto handler = std::get_new_handler())
+      handler();
+    else
+      throw std::bad_alloc();
+  }
+}
+
+void checked_delete(void *ptr) noexcept {
+  if (ptr == nullptr)
+    return;
+  rt_safety::report(rt_safety::ViolationKind::Deallocation);
+  raw_free(ptr);
+}
+
+void checked_aligned_delete(void *ptr) noexcept {
+  if (ptr == nullptr)
+    return;
+  rt_safety::report(rt_safety::ViolationKind::Deallocation);
+  raw_aligned_free(ptr);
+}
+} // namespace
+
+//==============================================================================
+// replaced global allocation functions
+//==============================================================================
+void *operator new(std::size_t size) { return checked_new(size); }
+void *operator new[](std::size_t size) { return checked_new(size); }
+void *operator new(std::size_t size, const std::nothrow_t &) noexcept {
+  try {
+    return checked_new(size);
+  } catch (...) {
+    return nullptr;
+  }
+}
+void *operator new[](std::size_t size, const std::nothrow_t &) noexcept {
+  try {
+    return checked_new(size);
+  } catch (...) {
+    return nullptr;
+  }
+}
+void *operator new(std::size_t size, std::align_val_t alignment) {
+  return checked_aligned_new(size, alignment);
+}
+void *operator new[](std::size_t size, std::align_val_t alignment) {
+  return checked_aligned_new(size, alignment);
+}
+void *operator new(std::size_t size, std::align_val_t alignment, const std::nothrow_t &) noexcept {
+  try {
+    return checked_aligned_new(size, alignment);
+  } catch (...) {
+    return nullptr;
+  }
+}
+void *operator new[](std::size_t size, std::align_val_t alignment,
+                     const std::nothrow_t &) noexcept {
+  try {
+    return checked_aligned_new(size, alignment);
+  } catch (...) {
+    return nullptr;
+  }
+}
+
+void operator delete(void *ptr) noexcept { checked_delete(ptr); }
+void operator delete[](void *ptr) noexcept { checked_delete(ptr); }
+void operator delete(void *ptr, std::size_t) noexcept { checked_delete(ptr); }
+void operator delete[](void *ptr, std::size_t) noexcept { checked_delete(ptr); }
+void operator delete(void *ptr, const std::nothrow_t &) noexcept { checked_delete(ptr); }
+void operator delete[](void *ptr, const std::nothrow_t &) noexcept { checked_delete(ptr); }
+void operator delete(void *ptr, std::align_val_t) noexcept { checked_aligned_delete(ptr); }
+void operator delete[](void *ptr, std::align_val_t) noexcept { checked_aligned_delete(ptr); }
+void operator delete(void *ptr, std::size_t, std::align_val_t) noexcept {
+  checked_aligned_delete(ptr);
+}
+void operator delete[](void *ptr, std::size_t, std::align_val_t) noexcept {
+  checked_aligned_delete(ptr);
+}
+void operator delete(void *ptr, std::align_val_t, const std::nothrow_t &) noexcept {
+  checked_aligned_delete(ptr);
+}
+void operator delete[](void *ptr, std::align_val_t, const std::nothrow_t &) noexcept {
+  checked_aligned_delete(ptr);
+}
+
+#if NTHN_RT_SAFETY_HOOK_MALLOC
+extern "C" {
+void *malloc(std::size_t size) noexcept {
+  rt_safety::report(rt_safety::ViolationKind::Allocation, size);
+  return __libc_malloc(size);
+}
+void *calloc(std::size_t count, std::size_t size) noexcept {
+  rt_safety::report(rt_safety::ViolationKind::Allocation, count * size);
+  return __libc_calloc(count, size);
+}
+void *realloc(void *ptr, std::size_t size) noexcept {
+  rt_safety::report(rt_safety::ViolationKind::Allocation, size);
+  return __libc_realloc(ptr, size);
+}
+void free(void *ptr) noexcept {
+  if (ptr != nullptr)
+    rt_safety::report(rt_safety::ViolationKind::Deallocation);
+  __libc_free(ptr);
+}
+}
+#endif
+
+#endif
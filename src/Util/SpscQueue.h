@@ -0,0 +1,67 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+
+//==============================================================================
+// SpscQueue
+// bounded, lock-free, single-producer single-consumer queue of Capacity items
+// (a power of 2), for handing fixed-size structs between the audio thread and
+// the message thread. a push is a copy, a store and a release, with no
+// compare-exchange loop. each side keeps a copy of the other side's position
+// and only reloads it when the queue looks full (or empty), so they rarely
+// touch each other's cache line. neither side waits or allocates: push()
+// returns false when full, and the caller drops the item or notes it
+//==============================================================================
+namespace nthn_utils {
+template <typename Item, std::size_t Capacity> class SpscQueue {
+public:
+  static_assert((Capacity & (Capacity - 1)) == 0, "Capacity must be a power of 2");
+
+  SpscQueue() = default;
+  SpscQueue(const SpscQueue &) = delete;
+  SpscQueue &operator=(const SpscQueue &) = delete;
+
+  // called from the producer thread only
+  bool push(const Item &item) {
+    const auto position = write_position.load(std::memory_order_relaxed);
+    if (position - cached_read_position == Capacity) {
+      cached_read_position = read_position.load(std::memory_order_acquire);
+      if (position - cached_read_position == Capacity)
+        return false; // full
+    }
+    items[position & (Capacity - 1)] = item;
+    write_position.store(position + 1, std::memory_order_release);
+    return true;
+  }
+
+  // called from the consumer thread only
+  bool pop(Item &item) {
+    const auto position = read_position.load(std::memory_order_relaxed);
+    if (position == cached_write_position) {
+      cached_write_position = write_position.load(std::memory_order_acquire);
+      if (position == cached_write_position)
+        return false; // empty
+    }
+    item = items[position & (Capacity - 1)];
+    read_position.store(position + 1, std::memory_order_release);
+    return true;
+  }
+
+  // called from the consumer thread only, drops everything pushed so far
+  void clear() {
+    cached_write_position = write_position.load(std::memory_order_acquire);
+    read_position.store(cached_write_position, std::memory_order_release);
+  }
+
+private:
+  std::array<Item, Capacity> items;
+  // producer side
+  alignas(64) std::atomic<std::size_t> write_position{0};
+  std::size_t cached_read_position{0};
+  // consumer side
+  alignas(64) std::atomic<std::size_t> read_position{0};
+  std::size_t cached_write_position{0};
+};
+} // namespace nthn_utils
@@ -1,4 +1,10 @@
+#pragma once
+
 #include <cmath>
+#include <cstdint>
+#if defined(_MSC_VER) && !defined(__clang__)
+#include <intrin.h>
+#endif
 
 namespace nthn_utils {
 static inline float tau2pole(const float tau, const float sr) {
@@ -8,5 +14,16 @@ static inline float tau2pole(const float tau, const float sr) {
 static inline float lerp(const float x1, const float x2, const float alpha) {
   return x1 + alpha * (x2 - x1);
 }
+
+// index of the lowest set bit, x must not be 0
+static inline int count_trailing_zeros(const std::uint64_t x) {
+#if defined(_MSC_VER) && !defined(__clang__)
+  unsigned long index;
+  _BitScanForward64(&index, x);
+  return int(index);
+#else
+  return __builtin_ctzll(x);
+#endif
+}
 } // namespace nthn_utils
 // nthn_utils
@@ -0,0 +1,94 @@
+#include "AudioMeter.h"
+#include "MeterKernels.h"
+
+#include <algorithm>
+#include <limits>
+
+namespace {
+// a frame with no samples in it yet
+void clear_frame(AudioMeter::Frame &frame) {
+  frame.num_samples = 0;
+  frame.min.fill(std::numeric_limits<float>::max());
+  frame.max.fill(std::numeric_limits<float>::lowest());
+  frame.mean_square.fill(0.0f); // the sum of squares, until the frame is finished
+}
+} // namespace
+
+//==============================================================================
+// called from prepareToPlay
+void AudioMeter::prepare(double sample_rate_) {
+  sample_rate.store(sample_rate_);
+  samples_per_frame = std::max(1, juce::roundToInt(sample_rate_ * FRAME_SECONDS));
+  // start a new frame with the next block
+  was_enabled = false;
+}
+
+// called from the audio thread
+template <typename SampleType>
+void AudioMeter::process(const SampleType *const *channels, int numChannels, int numSamples) {
+  if (!begin_block(numChannels))
+    return;
+  const auto &kernels = meter_kernels::best<SampleType>();
+  for (int start = 0; start < numSamples;) {
+    const int length = std::min(numSamples - start, samples_per_frame - current.num_samples);
+    for (size_t ch = 0; ch < size_t(current.num_channels); ++ch) {
+      auto min = SampleType(current.min[ch]);
+      auto max = SampleType(current.max[ch]);
+      auto sum_squares = SampleType(current.mean_square[ch]);
+      kernels.accumulate(channels[ch] + start, length, min, max, sum_squares);
+      current.min[ch] = float(min);
+      current.max[ch] = float(max);
+      current.mean_square[ch] = float(sum_squares);
+    }
+    current.num_samples += length;
+    start += length;
+    if (current.num_samples == samples_per_frame)
+      finish_frame();
+  }
+}
+
+// called from the audio thread
+void AudioMeter::process_silence(int numChannels, int numSamples) {
+  if (!begin_block(numChannels))
+    return;
+  for (int start = 0; start < numSamples;) {
+    const int length = std::min(numSamples - start, samples_per_frame - current.num_samples);
+    for (size_t ch = 0; ch < size_t(current.num_channels); ++ch) {
+      current.min[ch] = std::min(current.min[ch], 0.0f);
+      current.max[ch] = std::max(current.max[ch], 0.0f);
+    }
+    current.num_samples += length;
+    start += length;
+    if (current.num_samples == samples_per_frame)
+      finish_frame();
+  }
+}
+
+bool AudioMeter::begin_block(int numChannels) {
+  const bool is_enabled_now = enabled.load(std::memory_order_relaxed);
+  // whatever was measured before metering was turned off is stale
+  const bool restart = is_enabled_now && !was_enabled;
+  was_enabled = is_enabled_now;
+  if (!is_enabled_now)
+    return false;
+
+  numChannels = std::min(numChannels, MAX_CHANNELS);
+  if (restart || numChannels != current.num_channels) {
+    current.num_channels = numChannels;
+    clear_frame(current);
+  }
+  return true;
+}
+
+void AudioMeter::finish_frame() {
+  const float scale = 1.0f / float(current.num_samples);
+  for (size_t ch = 0; ch < size_t(current.num_channels); ++ch)
+    current.mean_square[ch] *= scale;
+  // if the message thread falls behind, drop the frame rather than wait
+  ring.push(current);
+  clear_frame(current);
+}
+
+template void AudioMeter::process<float>(const float *const *, int, int);
+template void AudioMeter::process<double>(const double *const *, int, int);
+
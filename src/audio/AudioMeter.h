@@ -0,0 +1,89 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+
+#include <juce_core/juce_core.h>
+
+#include "../Util/SpscQueue.h"
+
+//==============================================================================
+// AudioMeter
+// the audio-derived data for the editor's meters: per channel peak, rms and the
+// min/max outline of the waveform.
+//
+// the audio thread cuts the output into frames of FRAME_SECONDS, measures each
+// channel of a frame in one simd pass (see MeterKernels.h), and pushes one
+// fixed-size Frame per frame into a lock-free single-producer single-consumer
+// ring. a frame can span several blocks, so the frame rate doesn't depend on
+// the host's block size. the message thread drains the ring with
+// for_each_frame(), at most once per repaint.
+//
+// metering is off until set_enabled(true) (the meter display does that while it
+// exists). when off, process() is a single predictable branch. when on, it is a
+// read of every sample the processor has just written, well under 1% of the
+// callback budget (the metering stage of the load meter). if the message thread
+// falls behind, frames are dropped rather than waited for
+//==============================================================================
+class AudioMeter {
+public:
+  // channels past this are not metered
+  static constexpr int MAX_CHANNELS = 16;
+  // about one waveform point per 4 ms
+  static constexpr double FRAME_SECONDS = 0.004;
+  static constexpr size_t RING_SIZE = 512; // must be a power of 2, ~2 s of frames
+
+  struct Frame {
+    int num_channels;
+    int num_samples;
+    std::array<float, MAX_CHANNELS> min;
+    std::array<float, MAX_CHANNELS> max;
+    std::array<float, MAX_CHANNELS> mean_square;
+  };
+
+  AudioMeter() = default;
+
+  // called from prepareToPlay
+  void prepare(double sample_rate_);
+
+  // called from the audio thread, after processing
+  template <typename SampleType>
+  void process(const SampleType *const *channels, int numChannels, int numSamples);
+  // the same as process() on a block of zeros, without reading it
+  void process_silence(int numChannels, int numSamples);
+
+  // called from the message thread. turning metering on drops the frames left
+  // in the ring from the last time it was on (the editor was closed before it
+  // read them), which would otherwise be drawn as if they were new
+  void set_enabled(bool should_be_enabled) {
+    if (should_be_enabled && !enabled.load())
+      ring.clear();
+    enabled.store(should_be_enabled);
+  }
+  bool is_enabled() const { return enabled.load(); }
+  double get_sample_rate() const { return sample_rate.load(); }
+  // calls fn(frame) for every frame pushed since the last call, oldest first
+  template <typename Fn> void for_each_frame(Fn &&fn) {
+    Frame frame;
+    while (ring.pop(frame))
+      fn(frame);
+  }
+
+private:
+  // audio thread side
+  // resets the frame being measured when metering has just been turned on, and
+  // returns false while metering is off
+  bool begin_block(int numChannels);
+  void finish_frame();
+  Frame current{};
+  int samples_per_frame{192};
+  bool was_enabled{false};
+
+  // written by the audio thread, read by the message thread
+  nthn_utils::SpscQueue<Frame, RING_SIZE> ring;
+
+  std::atomic<bool> enabled{false};
+  std::atomic<double> sample_rate{44100.0};
+
+  JUCE_DECLARE_NON_COPYABLE(AudioMeter)
+};
@@ -0,0 +1,189 @@
+#include "ChannelGroupPool.h"
+#include "../Util/CpuFeatures.h"
+#include "../Util/RealtimeSafety.h"
+
+namespace {
+// tells the cpu we're in a spin loop
+inline void spin_pause() {
+#if NTHN_X86
+  _mm_pause();
+#elif defined(__aarch64__) || defined(_M_ARM64)
+#if defined(_MSC_VER) && !defined(__clang__)
+  __yield();
+#else
+  __asm__ __volatile__("yield");
+#endif
+#endif
+}
+} // namespace
+
+//==============================================================================
+class ChannelGroupPool::Worker : public juce::Thread {
+public:
+  Worker(ChannelGroupPool &pool_, int index)
+      : juce::Thread("Channel Group " + juce::String(index + 1)), pool(pool_) {}
+  ~Worker() override { stopThread(-1); }
+
+  void run() override { pool.worker_loop(*this); }
+
+  // the workgroup this thread is in, and the number it had when joined
+  juce::WorkgroupToken workgroup_token;
+  std::uint32_t workgroup_number{0};
+  // true while the worker waits for notify() (or is about to)
+  std::atomic<bool> parked{false};
+
+private:
+  ChannelGroupPool &pool;
+};
+
+ChannelGroupPool::ChannelGroupPool() {}
+
+ChannelGroupPool::~ChannelGroupPool() { stop_workers(); }
+
+void ChannelGroupPool::prepare(int num_workers, int samples_per_block, double sample_rate) {
+  num_workers = juce::jlimit(0, MAX_WORKERS, num_workers);
+  if (num_workers == get_num_workers() && samples_per_block == worker_samples_per_block &&
+      sample_rate == worker_sample_rate)
+    return;
+  stop_workers();
+  should_exit.store(false);
+  worker_samples_per_block = samples_per_block;
+  worker_sample_rate = sample_rate;
+  // the same deadline as the audio thread, which the workers share each block
+  const auto options = juce::Thread::RealtimeOptions{}.withApproximateAudioProcessingTime(
+      std::max(1, samples_per_block), sample_rate);
+  for (int w = 0; w < num_workers; ++w)
+    workers.push_back(std::make_unique<Worker>(*this, w));
+  for (auto &worker : workers)
+    if (!worker->startRealtimeThread(options))
+      // no realtime scheduling allowed (e.g. no rtkit), a high priority is the next best
+      worker->startThread(juce::Thread::Priority::highest);
+}
+
+void ChannelGroupPool::stop_workers() {
+  should_exit.store(true);
+  for (auto &worker : workers)
+    worker->signalThreadShouldExit();
+  for (auto &worker : workers)
+    worker->stopThread(-1);
+  workers.clear();
+}
+
+void ChannelGroupPool::set_workgroup(const juce::AudioWorkgroup &new_workgroup) {
+  {
+    std::lock_guard<std::mutex> lock(workgroup_mutex);
+    workgroup = new_workgroup;
+  }
+  workgroup_number.fetch_add(1);
+}
+
+void ChannelGroupPool::update_workgroup(Worker &worker) {
+  const auto number = workgroup_number.load();
+  if (number == worker.workgroup_number)
+    return;
+  worker.workgroup_number = number;
+  // leaves the previous workgroup first
+  worker.workgroup_token.reset();
+  std::lock_guard<std::mutex> lock(workgroup_mutex);
+  if (workgroup)
+    workgroup.join(worker.workgroup_token);
+}
+
+//==============================================================================
+// called from the audio thread
+void ChannelGroupPool::run_parallel(int num_groups, Task task, void *context) {
+  const auto job = job_number.load(std::memory_order_relaxed) + 1;
+  finished_groups.store(0, std::memory_order_relaxed);
+  // retag the claim counter first, so a worker still holding the previous job
+  // number fails to claim anything from here on
+  next_group.store(std::uint64_t(job) << 32);
+  job_task.store(task, std::memory_order_release);
+  job_context.store(context, std::memory_order_release);
+  job_num_groups.store(num_groups, std::memory_order_release);
+  job_number.store(job);
+  // one worker per group the audio thread doesn't take
+  wake_workers(num_groups - 1);
+
+  // work alongside the workers, then wait for the groups they claimed
+  int group;
+  while (claim_group(job, num_groups, group)) {
+    task(context, group);
+    finished_groups.fetch_add(1, std::memory_order_acq_rel);
+  }
+  while (finished_groups.load(std::memory_order_acquire) < num_groups)
+    spin_pause();
+}
+
+void ChannelGroupPool::wake_workers(int num_workers) {
+  // a worker sets parked before it reloads job_number, and run() stores
+  // job_number before it reads parked (all sequentially consistent), so either
+  // the worker sees the new job or it gets notified. workers still spinning
+  // from the last run() are not signalled
+  for (auto &worker : workers) {
+    if (num_workers <= 0)
+      return;
+    if (worker->parked.load()) {
+      worker->notify();
+      --num_workers;
+    }
+  }
+}
+
+bool ChannelGroupPool::claim_group(std::uint32_t job, int num_groups, int &group) {
+  auto current = next_group.load(std::memory_order_acquire);
+  for (;;) {
+    if (std::uint32_t(current >> 32) != job)
+      return false; // a newer job has started
+    const int next = int(current & 0xffffffffu);
+    if (next >= num_groups)
+      return false;
+    if (next_group.compare_exchange_weak(current, current + 1, std::memory_order_acq_rel)) {
+      group = next;
+      return true;
+    }
+  }
+}
+
+//==============================================================================
+void ChannelGroupPool::worker_loop(Worker &worker) {
+  const auto spin_ticks =
+      juce::int64(SPIN_SECONDS * double(juce::Time::getHighResolutionTicksPerSecond()));
+  auto last_job = job_number.load();
+
+  while (!should_exit.load()) {
+    update_workgroup(worker);
+    // wait for a new job: spin for a while, then park until run() wakes us
+    auto job = job_number.load();
+    const auto spin_start = juce::Time::getHighResolutionTicks();
+    while (job == last_job && !should_exit.load() &&
+           juce::Time::getHighResolutionTicks() - spin_start < spin_ticks) {
+      spin_pause();
+      job = job_number.load();
+    }
+    while (job == last_job && !should_exit.load()) {
+      worker.parked.store(true);
+      // run() may have published a job before it saw the flag
+      job = job_number.load();
+      if (job == last_job && !should_exit.load())
+        // run() and stop_workers() notify
+        worker.wait(-1);
+      worker.parked.store(false);
+      update_workgroup(worker);
+      job = job_number.load();
+    }
+    if (job == last_job)
+      continue;
+    last_job = job;
+
+    const auto task = job_task.load(std::memory_order_acquire);
+    auto *context = job_context.load(std::memory_order_acquire);
+    const int num_groups = job_num_groups.load(std::memory_order_acquire);
+    // the groups run under the same rules as processBlock
+    rt_safety::ScopedAudioThread audio_thread_scope;
+    int group;
+    while (claim_group(job, num_groups, group)) {
+      task(context, group);
+      finished_groups.fetch_add(1, std::memory_order_acq_rel);
+    }
+  }
+}
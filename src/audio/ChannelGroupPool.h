@@ -0,0 +1,105 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+#include <juce_audio_basics/juce_audio_basics.h>
+#include <juce_core/juce_core.h>
+
+//==============================================================================
+// ChannelGroupPool
+// splits per-channel processing across preallocated worker threads.
+//
+// run(num_groups, fn) calls fn(group) once for every group, on the audio thread
+// and on any worker that is awake, and returns when all groups are done.
+// groups are claimed from a single atomic counter (tagged with the job number,
+// so a late worker can never claim a group of the next job), and the audio
+// thread joins by spinning on a second counter. neither side allocates, and the
+// audio thread's only system call is waking parked workers. the audio thread
+// claims groups too, so a job always finishes even if no worker wakes up in
+// time.
+//
+// workers are realtime threads (sized for the block like the audio thread) and
+// join the host's audio workgroup when it has one. they spin for a short while
+// after each job, catching the next run() of the same block without a system
+// call, then park until run() wakes them. run() only signals the workers that
+// are parked, so an idle pool (transport stopped, or blocks that never run in
+// parallel) costs nothing. a worker still waking up when a block starts joins
+// it late or not at all, the audio thread takes its groups.
+//
+// groups must not share state, then the result does not depend on which thread
+// ran which group
+//==============================================================================
+class ChannelGroupPool {
+public:
+  static constexpr int MAX_WORKERS = 15;
+
+  ChannelGroupPool();
+  ~ChannelGroupPool();
+
+  // starts (or restarts) num_workers threads, 0 runs everything on the calling
+  // thread. the block size and sample rate tell the os how much time the
+  // workers need per block. called from prepareToPlay, never while run() is in
+  // progress
+  void prepare(int num_workers, int samples_per_block, double sample_rate);
+  // the workgroup of the host's audio thread (an empty one if it has none).
+  // workers join it between jobs. not called from the audio thread
+  void set_workgroup(const juce::AudioWorkgroup &new_workgroup);
+  int get_num_workers() const { return int(workers.size()); }
+
+  // called from the audio thread. with parallel false (or no workers, or one
+  // group) the groups run in order on the calling thread
+  template <typename GroupFn> void run(int num_groups, bool parallel, GroupFn &&process_group) {
+    if (!parallel || workers.empty() || num_groups < 2) {
+      for (int group = 0; group < num_groups; ++group)
+        process_group(group);
+      return;
+    }
+    run_parallel(num_groups, &invoke<std::remove_reference_t<GroupFn>>, &process_group);
+  }
+
+  // spin time of an idle worker before it parks, long enough for the next run()
+  // of the same block but not to burn a core between blocks
+  static constexpr double SPIN_SECONDS = 0.0001;
+
+private:
+  using Task = void (*)(void *context, int group);
+  template <typename GroupFn> static void invoke(void *context, int group) {
+    (*static_cast<GroupFn *>(context))(group);
+  }
+
+  void run_parallel(int num_groups, Task task, void *context);
+  // wakes up to num_workers parked workers
+  void wake_workers(int num_workers);
+  // claims the next group of job, returns false when there are none left
+  bool claim_group(std::uint32_t job, int num_groups, int &group);
+  class Worker;
+  void worker_loop(Worker &worker);
+  void stop_workers();
+  // joins the current workgroup if it changed since the worker last joined
+  void update_workgroup(Worker &worker);
+
+  std::vector<std::unique_ptr<Worker>> workers;
+  int worker_samples_per_block{0};
+  double worker_sample_rate{0.0};
+
+  // only the workers and set_workgroup() touch the workgroup, never the audio thread
+  std::mutex workgroup_mutex;
+  juce::AudioWorkgroup workgroup;
+  std::atomic<std::uint32_t> workgroup_number{0};
+
+  // the current job, published by bumping job_number
+  std::atomic<Task> job_task{nullptr};
+  std::atomic<void *> job_context{nullptr};
+  std::atomic<int> job_num_groups{0};
+  alignas(64) std::atomic<std::uint32_t> job_number{0};
+  // (job number << 32) | next unclaimed group
+  alignas(64) std::atomic<std::uint64_t> next_group{0};
+  alignas(64) std::atomic<int> finished_groups{0};
+  std::atomic<bool> should_exit{false};
+
+  JUCE_DECLARE_NON_COPYABLE(ChannelGroupPool)
+};
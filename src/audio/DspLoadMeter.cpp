@@ -0,0 +1,88 @@
+#include "DspLoadMeter.h"
+
+#include <cmath>
+
+//==============================================================================
+// called from the audio thread
+void DspLoadMeter::BlockTimer::start(int num_samples) {
+  timing.start_ticks = juce::Time::getHighResolutionTicks();
+  timing.stage_ticks.fill(0);
+  timing.sample_rate = meter->sample_rate.load(std::memory_order_relaxed);
+  timing.num_samples = num_samples;
+  timing.skipped = false;
+  last_ticks = timing.start_ticks;
+}
+
+void DspLoadMeter::BlockTimer::finish() {
+  timing.total_ticks = juce::Time::getHighResolutionTicks() - timing.start_ticks;
+  // if the message thread falls behind, drop the block rather than wait
+  meter->ring.push(timing);
+}
+
+//==============================================================================
+DspLoadMeter::DspLoadMeter() : history(HISTORY_SIZE) {}
+
+void DspLoadMeter::prepare(double sample_rate_) { sample_rate.store(sample_rate_); }
+
+void DspLoadMeter::set_enabled(bool should_be_enabled) { enabled.store(should_be_enabled); }
+
+//==============================================================================
+// called from the message thread
+void DspLoadMeter::update() {
+  const double seconds_per_tick = 1.0 / double(juce::Time::getHighResolutionTicksPerSecond());
+  BlockTiming timing;
+  while (ring.pop(timing)) {
+    history[history_position] = timing;
+    history_position = (history_position + 1) % HISTORY_SIZE;
+    history_count = std::min(history_count + 1, HISTORY_SIZE);
+
+    if (timing.num_samples <= 0 || timing.sample_rate <= 0.0)
+      continue;
+    // the load of one block is the time it took over the time it had
+    const double budget = double(timing.num_samples) / timing.sample_rate;
+    const double load = double(timing.total_ticks) * seconds_per_tick / budget;
+    peak_load = std::max(peak_load, load);
+
+    // one-pole average over ROLLING_TIME seconds of audio, so short blocks
+    // count for less than long ones
+    const double alpha = 1.0 - std::exp(-budget / ROLLING_TIME);
+    rolling_load += alpha * (load - rolling_load);
+    for (size_t s = 0; s < NUM_STAGES; ++s) {
+      const double stage_load = double(timing.stage_ticks[s]) * seconds_per_tick / budget;
+      rolling_stage_load[s] += alpha * (stage_load - rolling_stage_load[s]);
+    }
+    rolling_skip_ratio += alpha * ((timing.skipped ? 1.0 : 0.0) - rolling_skip_ratio);
+  }
+}
+
+float DspLoadMeter::get_peak_load() {
+  const auto peak = peak_load;
+  peak_load = 0.0;
+  return float(peak);
+}
+
+bool DspLoadMeter::export_csv(const juce::File &file) const {
+  const double us_per_tick = 1.0e6 / double(juce::Time::getHighResolutionTicksPerSecond());
+
+  juce::String csv = "start_us,num_samples,sample_rate,budget_us,total_us,load";
+  for (auto *name : STAGE_NAMES)
+    csv << "," << name << "_us";
+  csv << ",skipped\n";
+
+  // oldest first
+  const size_t oldest = (history_position + HISTORY_SIZE - history_count) % HISTORY_SIZE;
+  const auto first_ticks = history_count > 0 ? history[oldest].start_ticks : juce::int64(0);
+  for (size_t i = 0; i < history_count; ++i) {
+    const auto &timing = history[(oldest + i) % HISTORY_SIZE];
+    const double budget_us = 1.0e6 * double(timing.num_samples) / timing.sample_rate;
+    const double total_us = double(timing.total_ticks) * us_per_tick;
+    csv << juce::String(double(timing.start_ticks - first_ticks) * us_per_tick, 1) << ","
+        << timing.num_samples << "," << juce::String(timing.sample_rate, 0) << ","
+        << juce::String(budget_us, 3) << "," << juce::String(total_us, 3) << ","
+        << juce::String(total_us / budget_us, 5);
+    for (auto stage_ticks : timing.stage_ticks)
+      csv << "," << juce::String(double(stage_ticks) * us_per_tick, 3);
+    csv << "," << (timing.skipped ? 1 : 0) << "\n";
+  }
+  return file.replaceWithText(csv);
+}
@@ -0,0 +1,130 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <vector>
+
+#include <juce_core/juce_core.h>
+
+#include "../Util/SpscQueue.h"
+
+//==============================================================================
+// DspLoadMeter
+// measures how much of the callback budget (numSamples / sampleRate) processBlock
+// uses, split into processing stages.
+//
+// the audio thread times each block with a BlockTimer and pushes one
+// BlockTiming per block into a lock-free single-producer single-consumer ring.
+// the message thread drains the ring in update(), which keeps the rolling load
+// and a history of recent blocks for export_csv().
+//
+// timing is off until set_enabled(true). when off, a BlockTimer holds a null
+// meter, so each lap() costs a single predictable branch
+//==============================================================================
+class DspLoadMeter {
+public:
+  //--------------------------------------------------------------------------------
+  // the stages of processBlock, in order. to time a new stage, add it here and
+  // in STAGE_NAMES, then call timer.lap(DspLoadMeter::YOUR_STAGE) after it
+  //--------------------------------------------------------------------------------
+  // CHANNELS is the per-channel work (the host rate chain and the oversampled
+  // stages), which can be split across threads, so it's timed as a whole.
+  // METERING is the output metering for the editor (see AudioMeter.h)
+  enum Stage { AUTOMATION, SMOOTHING, CHANNELS, METERING, NUM_STAGES };
+  static inline const std::array<const char *, NUM_STAGES> STAGE_NAMES{
+      "automation", "smoothing", "channels", "metering"};
+
+  struct BlockTiming {
+    juce::int64 start_ticks;
+    juce::int64 total_ticks;
+    std::array<juce::int64, NUM_STAGES> stage_ticks;
+    double sample_rate;
+    int num_samples;
+    bool skipped; // the dsp was skipped, because the input was silent and the tails had decayed
+  };
+
+  //--------------------------------------------------------------------------------
+  // times one call of processBlock, create at the top of processBlock
+  // lap(stage) adds the time since the previous lap (or the start) to that stage,
+  // so a stage that runs once per sub-block is summed over the block
+  //--------------------------------------------------------------------------------
+  class BlockTimer {
+  public:
+    BlockTimer(DspLoadMeter &meter_, int num_samples)
+        : meter(meter_.enabled.load(std::memory_order_relaxed) ? &meter_ : nullptr) {
+      if (meter != nullptr)
+        start(num_samples);
+    }
+    ~BlockTimer() {
+      if (meter != nullptr)
+        finish();
+    }
+    void lap(Stage stage) {
+      if (meter != nullptr) {
+        const auto now = juce::Time::getHighResolutionTicks();
+        timing.stage_ticks[size_t(stage)] += now - last_ticks;
+        last_ticks = now;
+      }
+    }
+    // marks this block as skipped (silent input, no tail left)
+    void set_skipped() {
+      if (meter != nullptr)
+        timing.skipped = true;
+    }
+
+  private:
+    void start(int num_samples);
+    void finish();
+
+    DspLoadMeter *meter;
+    BlockTiming timing;
+    juce::int64 last_ticks;
+
+    JUCE_DECLARE_NON_COPYABLE(BlockTimer)
+  };
+
+  DspLoadMeter();
+
+  // called from prepareToPlay
+  void prepare(double sample_rate_);
+
+  // called from the message thread
+  void set_enabled(bool should_be_enabled);
+  bool is_enabled() const { return enabled.load(); }
+
+  // drains the timings of the blocks processed since the last call
+  void update();
+  // rolling share of the callback budget used, 1.0 = 100%
+  float get_load() const { return float(rolling_load); }
+  // highest single-block load since the last call
+  float get_peak_load();
+  // rolling share of the callback budget used by a stage
+  float get_stage_load(Stage stage) const { return float(rolling_stage_load[size_t(stage)]); }
+  // rolling share of the audio whose processing was skipped, 1.0 = all of it
+  float get_skip_ratio() const { return float(rolling_skip_ratio); }
+  // writes the history (the last HISTORY_SIZE blocks) as CSV
+  bool export_csv(const juce::File &file) const;
+
+  static constexpr size_t RING_SIZE = 1024;    // must be a power of 2
+  static constexpr size_t HISTORY_SIZE = 16384;
+  // time constant of the rolling load, in seconds of audio
+  static constexpr double ROLLING_TIME = 0.3;
+
+private:
+  // written by the audio thread, read by the message thread
+  nthn_utils::SpscQueue<BlockTiming, RING_SIZE> ring;
+
+  std::atomic<bool> enabled{false};
+  std::atomic<double> sample_rate{44100.0};
+
+  // message thread side
+  std::vector<BlockTiming> history; // circular, preallocated
+  size_t history_position{0};
+  size_t history_count{0};
+  double rolling_load{0.0};
+  std::array<double, NUM_STAGES> rolling_stage_load{};
+  double rolling_skip_ratio{0.0};
+  double peak_load{0.0};
+
+  JUCE_DECLARE_NON_COPYABLE(DspLoadMeter)
+};
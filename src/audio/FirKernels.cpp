@@ -0,0 +1,185 @@
+#include "FirKernels.h"
+
+namespace fir_kernels {
+namespace {
+//==============================================================================
+// scalar
+//==============================================================================
+template <typename SampleType>
+void convolve_scalar(const SampleType *input, const SampleType *coefficients, int numTaps,
+                     SampleType *output, int numOutputs) {
+  for (int i = 0; i < numOutputs; ++i) {
+    SampleType sum = 0;
+    for (int t = 0; t < numTaps; ++t)
+      sum += coefficients[t] * input[i + t];
+    output[i] = sum;
+  }
+}
+
+#if NTHN_X86
+//==============================================================================
+// SSE2, 8 outputs per pass
+//==============================================================================
+NTHN_TARGET("sse2")
+void convolve_sse2(const float *input, const float *coefficients, int numTaps, float *output,
+                   int numOutputs) {
+  int i = 0;
+  for (; i + 8 <= numOutputs; i += 8) {
+    __m128 a = _mm_setzero_ps();
+    __m128 b = _mm_setzero_ps();
+    for (int t = 0; t < numTaps; ++t) {
+      const __m128 c = _mm_set1_ps(coefficients[t]);
+      a = _mm_add_ps(a, _mm_mul_ps(c, _mm_loadu_ps(input + i + t)));
+      b = _mm_add_ps(b, _mm_mul_ps(c, _mm_loadu_ps(input + i + t + 4)));
+    }
+    _mm_storeu_ps(output + i, a);
+    _mm_storeu_ps(output + i + 4, b);
+  }
+  convolve_scalar(input + i, coefficients, numTaps, output + i, numOutputs - i);
+}
+
+//==============================================================================
+// AVX2, 16 outputs per pass
+//==============================================================================
+NTHN_TARGET("avx2")
+void convolve_avx2(const float *input, const float *coefficients, int numTaps, float *output,
+                   int numOutputs) {
+  int i = 0;
+  for (; i + 16 <= numOutputs; i += 16) {
+    __m256 a = _mm256_setzero_ps();
+    __m256 b = _mm256_setzero_ps();
+    for (int t = 0; t < numTaps; ++t) {
+      const __m256 c = _mm256_set1_ps(coefficients[t]);
+      a = _mm256_add_ps(a, _mm256_mul_ps(c, _mm256_loadu_ps(input + i + t)));
+      b = _mm256_add_ps(b, _mm256_mul_ps(c, _mm256_loadu_ps(input + i + t + 8)));
+    }
+    _mm256_storeu_ps(output + i, a);
+    _mm256_storeu_ps(output + i + 8, b);
+  }
+  for (; i + 8 <= numOutputs; i += 8) {
+    __m256 a = _mm256_setzero_ps();
+    for (int t = 0; t < numTaps; ++t)
+      a = _mm256_add_ps(a, _mm256_mul_ps(_mm256_set1_ps(coefficients[t]),
+                                         _mm256_loadu_ps(input + i + t)));
+    _mm256_storeu_ps(output + i, a);
+  }
+  convolve_scalar(input + i, coefficients, numTaps, output + i, numOutputs - i);
+}
+
+//==============================================================================
+// AVX-512, the tail is handled with masked loads/stores
+//==============================================================================
+NTHN_TARGET("avx512f")
+void convolve_avx512(const float *input, const float *coefficients, int numTaps, float *output,
+                     int numOutputs) {
+  int i = 0;
+  for (; i + 16 <= numOutputs; i += 16) {
+    __m512 a = _mm512_setzero_ps();
+    for (int t = 0; t < numTaps; ++t)
+      a = _mm512_add_ps(a, _mm512_mul_ps(_mm512_set1_ps(coefficients[t]),
+                                         _mm512_loadu_ps(input + i + t)));
+    _mm512_storeu_ps(output + i, a);
+  }
+  if (i < numOutputs) {
+    const __mmask16 mask = __mmask16((1u << (numOutputs - i)) - 1u);
+    __m512 a = _mm512_setzero_ps();
+    for (int t = 0; t < numTaps; ++t)
+      a = _mm512_add_ps(a, _mm512_mul_ps(_mm512_set1_ps(coefficients[t]),
+                                         _mm512_maskz_loadu_ps(mask, input + i + t)));
+    _mm512_mask_storeu_ps(output + i, mask, a);
+  }
+}
+//==============================================================================
+// double precision, half as many outputs per register
+//==============================================================================
+NTHN_TARGET("sse2")
+void convolve_double_sse2(const double *input, const double *coefficients, int numTaps,
+                          double *output, int numOutputs) {
+  int i = 0;
+  for (; i + 4 <= numOutputs; i += 4) {
+    __m128d a = _mm_setzero_pd();
+    __m128d b = _mm_setzero_pd();
+    for (int t = 0; t < numTaps; ++t) {
+      const __m128d c = _mm_set1_pd(coefficients[t]);
+      a = _mm_add_pd(a, _mm_mul_pd(c, _mm_loadu_pd(input + i + t)));
+      b = _mm_add_pd(b, _mm_mul_pd(c, _mm_loadu_pd(input + i + t + 2)));
+    }
+    _mm_storeu_pd(output + i, a);
+    _mm_storeu_pd(output + i + 2, b);
+  }
+  convolve_scalar(input + i, coefficients, numTaps, output + i, numOutputs - i);
+}
+
+NTHN_TARGET("avx2")
+void convolve_double_avx2(const double *input, const double *coefficients, int numTaps,
+                          double *output, int numOutputs) {
+  int i = 0;
+  for (; i + 8 <= numOutputs; i += 8) {
+    __m256d a = _mm256_setzero_pd();
+    __m256d b = _mm256_setzero_pd();
+    for (int t = 0; t < numTaps; ++t) {
+      const __m256d c = _mm256_set1_pd(coefficients[t]);
+      a = _mm256_add_pd(a, _mm256_mul_pd(c, _mm256_loadu_pd(input + i + t)));
+      b = _mm256_add_pd(b, _mm256_mul_pd(c, _mm256_loadu_pd(input + i + t + 4)));
+    }
+    _mm256_storeu_pd(output + i, a);
+    _mm256_storeu_pd(output + i + 4, b);
+  }
+  for (; i + 4 <= numOutputs; i += 4) {
+    __m256d a = _mm256_setzero_pd();
+    for (int t = 0; t < numTaps; ++t)
+      a = _mm256_add_pd(a, _mm256_mul_pd(_mm256_set1_pd(coefficients[t]),
+                                         _mm256_loadu_pd(input + i + t)));
+    _mm256_storeu_pd(output + i, a);
+  }
+  convolve_scalar(input + i, coefficients, numTaps, output + i, numOutputs - i);
+}
+
+NTHN_TARGET("avx512f")
+void convolve_double_avx512(const double *input, const double *coefficients, int numTaps,
+                            double *output, int numOutputs) {
+  int i = 0;
+  for (; i + 8 <= numOutputs; i += 8) {
+    __m512d a = _mm512_setzero_pd();
+    for (int t = 0; t < numTaps; ++t)
+      a = _mm512_add_pd(a, _mm512_mul_pd(_mm512_set1_pd(coefficients[t]),
+                                         _mm512_loadu_pd(input + i + t)));
+    _mm512_storeu_pd(output + i, a);
+  }
+  if (i < numOutputs) {
+    const __mmask8 mask = __mmask8((1u << (numOutputs - i)) - 1u);
+    __m512d a = _mm512_setzero_pd();
+    for (int t = 0; t < numTaps; ++t)
+      a = _mm512_add_pd(a, _mm512_mul_pd(_mm512_set1_pd(coefficients[t]),
+                                         _mm512_maskz_loadu_pd(mask, input + i + t)));
+    _mm512_mask_storeu_pd(output + i, mask, a);
+  }
+}
+#endif
+
+// every compiled in path, indexed by SimdLevel
+template <typename SampleType> struct KernelTable;
+template <> struct KernelTable<float> {
+  static constexpr Kernels<float> paths[] = {
+      {convolve_scalar<float>, nthn_utils::SimdLevel::Scalar},
+#if NTHN_X86
+      {convolve_sse2, nthn_utils::SimdLevel::SSE2},
+      {convolve_avx2, nthn_utils::SimdLevel::AVX2},
+      {convolve_avx512, nthn_utils::SimdLevel::AVX512},
+#endif
+  };
+};
+template <> struct KernelTable<double> {
+  static constexpr Kernels<double> paths[] = {
+      {convolve_scalar<double>, nthn_utils::SimdLevel::Scalar},
+#if NTHN_X86
+      {convolve_double_sse2, nthn_utils::SimdLevel::SSE2},
+      {convolve_double_avx2, nthn_utils::SimdLevel::AVX2},
+      {convolve_double_avx512, nthn_utils::SimdLevel::AVX512},
+#endif
+  };
+};
+} // namespace
+
+NTHN_DEFINE_KERNEL_SET(KernelTable)
+} // namespace fir_kernels
@@ -0,0 +1,26 @@
+#pragma once
+
+#include "../Util/CpuFeatures.h"
+
+//==============================================================================
+// FIR inner loops (used by the half-band filters in Oversampler), one set per
+// instruction set. each path is vectorised across output samples rather than
+// across taps, so every output is summed in the same order as the scalar path.
+// there is a float and a double version of each
+//==============================================================================
+namespace fir_kernels {
+template <typename SampleType> struct Kernels {
+  // output[i] = sum over t of coefficients[t] * input[i + t], for i in [0, numOutputs)
+  // input must hold numOutputs + numTaps - 1 samples
+  void (*convolve)(const SampleType *input, const SampleType *coefficients, int numTaps,
+                   SampleType *output, int numOutputs);
+  nthn_utils::SimdLevel level;
+};
+
+// plain c++ reference path
+template <typename SampleType> const Kernels<SampleType> &scalar();
+// kernels for a specific instruction set, falls back to scalar when not compiled in
+template <typename SampleType> const Kernels<SampleType> &for_level(nthn_utils::SimdLevel level);
+// the fastest kernels this cpu supports, detected once
+template <typename SampleType> const Kernels<SampleType> &best();
+} // namespace fir_kernels
@@ -1,30 +1,15 @@
 #include "Gain.h"
-#include "../Util/Util.h"
 
-Gain::Gain(float sample_rate, int, int, float default_gain_)
-    : smooth_pole(nthn_utils::tau2pole(0.05f, sample_rate)), default_gain(default_gain_) {
-  setState(default_gain);
-}
-
-Gain::~Gain() {}
+template <typename SampleType>
+Gain<SampleType>::Gain(float gain_scale_)
+    : kernels(&gain_kernels::best<SampleType>()), gain_scale(gain_scale_) {}
 
-void Gain::process(float *const *buffer, const int numSamples, const int numChannels, const float gain) {
-  // get variable smooth_gain in a register
-  float local_gain = smooth_gain;
-  for (int i = 0; i < numSamples; ++i) {
-    // smooth gain to next value using IIR
-    local_gain = nthn_utils::lerp(gain, local_gain, smooth_pole);
+template <typename SampleType> Gain<SampleType>::~Gain() {}
 
-    // apply gain
-    for (int c = 0; c < numChannels; ++c) {
-      buffer[c][i] *= local_gain;
-    }
-  }
-  // store smooth gain state variable in object
-  smooth_gain = local_gain;
+template <typename SampleType>
+void Gain<SampleType>::setKernels(const gain_kernels::Kernels<SampleType> &kernels_) {
+  kernels = &kernels_;
 }
 
-void Gain::setState(const float gain) {
-  // force update, no smoothing applied
-  smooth_gain = gain;
-}
\ No newline at end of file
+template class Gain<float>;
+template class Gain<double>;
@@ -1,13 +1,51 @@
 #pragma once
 
-class Gain {
+#include "GainKernels.h"
+
+// SampleType is float or double (instantiated in Gain.cpp)
+template <typename SampleType_> class Gain {
 public:
-  Gain(float sample_rate, int samples_per_block, int num_channels, float default_gain_);
+  using SampleType = SampleType_;
+
+  // the gain passed to set_block() is multiplied by gain_scale_,
+  // e.g. 0.01 for a gain parameter in percent
+  explicit Gain(float gain_scale_ = 1.0f);
   ~Gain();
-  void process(float *const *buffer, const int numSamples, const int numChannels, const float gain);
-  void setState(const float gain);
+  // swap the simd kernels, e.g. for the scalar reference path
+  void setKernels(const gain_kernels::Kernels<SampleType> &kernels_);
+
+  //--------------------------------------------------------------------------------
+  // ProcessorChain stage (see ProcessorChain.h)
+  // set_block() takes the gain ramp, one (smoothed) gain per sample or nullptr
+  // if the gain is constant over the sub-block, and the gain, once per sub-block.
+  // the frames go through the simd kernels picked in the constructor
+  //--------------------------------------------------------------------------------
+  void set_block(const float *gain_ramp, const float gain) {
+    block_ramp = gain_ramp;
+    block_gain = SampleType(gain * gain_scale);
+  }
+  void process_frame(SampleType *frame, int channel, int index, int length) const {
+    (void)channel;
+    if (block_ramp != nullptr)
+      kernels->apply_ramp(frame, block_ramp + index, gain_scale, length);
+    else
+      kernels->apply_constant(frame, block_gain, length);
+  }
+  // each gain of the ramp is computed once, for the left and right sample
+  // (see gain_kernels::Kernels::apply_ramp_stereo)
+  void process_frame_stereo(SampleType *left, SampleType *right, int index, int length) const {
+    if (block_ramp != nullptr) {
+      kernels->apply_ramp_stereo(left, right, block_ramp + index, gain_scale, length);
+    } else {
+      kernels->apply_constant(left, block_gain, length);
+      kernels->apply_constant(right, block_gain, length);
+    }
+  }
 
 private:
-  float smooth_gain;
-  const float smooth_pole, default_gain;
-};
\ No newline at end of file
+  const gain_kernels::Kernels<SampleType> *kernels;
+  const float gain_scale;
+
+  const float *block_ramp{nullptr};
+  SampleType block_gain{0};
+};
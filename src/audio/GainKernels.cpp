@@ -0,0 +1,369 @@
+#include "GainKernels.h"
+
+namespace gain_kernels {
+namespace {
+//==============================================================================
+// scalar
+//==============================================================================
+template <typename SampleType>
+void apply_ramp_scalar(SampleType *samples, const float *ramp, float scale, int numSamples) {
+  for (int i = 0; i < numSamples; ++i)
+    samples[i] *= SampleType(ramp[i] * scale);
+}
+
+template <typename SampleType>
+void apply_ramp_stereo_scalar(SampleType *left, SampleType *right, const float *ramp, float scale,
+                              int numSamples) {
+  for (int i = 0; i < numSamples; ++i) {
+    const auto g = SampleType(ramp[i] * scale);
+    left[i] *= g;
+    right[i] *= g;
+  }
+}
+
+template <typename SampleType>
+void apply_constant_scalar(SampleType *samples, SampleType gain, int numSamples) {
+  for (int i = 0; i < numSamples; ++i)
+    samples[i] *= gain;
+}
+
+#if NTHN_X86
+//==============================================================================
+// SSE2
+//==============================================================================
+NTHN_TARGET("sse2")
+void apply_ramp_sse2(float *samples, const float *ramp, float scale, int numSamples) {
+  const __m128 s = _mm_set1_ps(scale);
+  int i = 0;
+  for (; i + 4 <= numSamples; i += 4)
+    _mm_storeu_ps(samples + i,
+                  _mm_mul_ps(_mm_loadu_ps(samples + i), _mm_mul_ps(_mm_loadu_ps(ramp + i), s)));
+  for (; i < numSamples; ++i)
+    samples[i] *= ramp[i] * scale;
+}
+
+NTHN_TARGET("sse2")
+void apply_ramp_stereo_sse2(float *left, float *right, const float *ramp, float scale,
+                            int numSamples) {
+  const __m128 s = _mm_set1_ps(scale);
+  int i = 0;
+  for (; i + 4 <= numSamples; i += 4) {
+    const __m128 g = _mm_mul_ps(_mm_loadu_ps(ramp + i), s);
+    _mm_storeu_ps(left + i, _mm_mul_ps(_mm_loadu_ps(left + i), g));
+    _mm_storeu_ps(right + i, _mm_mul_ps(_mm_loadu_ps(right + i), g));
+  }
+  for (; i < numSamples; ++i) {
+    const float g = ramp[i] * scale;
+    left[i] *= g;
+    right[i] *= g;
+  }
+}
+
+NTHN_TARGET("sse2")
+void apply_constant_sse2(float *samples, float gain, int numSamples) {
+  const __m128 g = _mm_set1_ps(gain);
+  int i = 0;
+  for (; i + 4 <= numSamples; i += 4)
+    _mm_storeu_ps(samples + i, _mm_mul_ps(_mm_loadu_ps(samples + i), g));
+  for (; i < numSamples; ++i)
+    samples[i] *= gain;
+}
+
+//==============================================================================
+// AVX2, unrolled twice to keep two multiplies in flight
+//==============================================================================
+NTHN_TARGET("avx2")
+void apply_ramp_avx2(float *samples, const float *ramp, float scale, int numSamples) {
+  const __m256 s = _mm256_set1_ps(scale);
+  int i = 0;
+  for (; i + 16 <= numSamples; i += 16) {
+    const __m256 ga = _mm256_mul_ps(_mm256_loadu_ps(ramp + i), s);
+    const __m256 gb = _mm256_mul_ps(_mm256_loadu_ps(ramp + i + 8), s);
+    _mm256_storeu_ps(samples + i, _mm256_mul_ps(_mm256_loadu_ps(samples + i), ga));
+    _mm256_storeu_ps(samples + i + 8, _mm256_mul_ps(_mm256_loadu_ps(samples + i + 8), gb));
+  }
+  for (; i + 8 <= numSamples; i += 8)
+    _mm256_storeu_ps(samples + i, _mm256_mul_ps(_mm256_loadu_ps(samples + i),
+                                                _mm256_mul_ps(_mm256_loadu_ps(ramp + i), s)));
+  for (; i < numSamples; ++i)
+    samples[i] *= ramp[i] * scale;
+}
+
+NTHN_TARGET("avx2")
+void apply_ramp_stereo_avx2(float *left, float *right, const float *ramp, float scale,
+                            int numSamples) {
+  const __m256 s = _mm256_set1_ps(scale);
+  int i = 0;
+  for (; i + 8 <= numSamples; i += 8) {
+    const __m256 g = _mm256_mul_ps(_mm256_loadu_ps(ramp + i), s);
+    _mm256_storeu_ps(left + i, _mm256_mul_ps(_mm256_loadu_ps(left + i), g));
+    _mm256_storeu_ps(right + i, _mm256_mul_ps(_mm256_loadu_ps(right + i), g));
+  }
+  for (; i < numSamples; ++i) {
+    const float g = ramp[i] * scale;
+    left[i] *= g;
+    right[i] *= g;
+  }
+}
+
+NTHN_TARGET("avx2")
+void apply_constant_avx2(float *samples, float gain, int numSamples) {
+  const __m256 g = _mm256_set1_ps(gain);
+  int i = 0;
+  for (; i + 16 <= numSamples; i += 16) {
+    const __m256 a = _mm256_mul_ps(_mm256_loadu_ps(samples + i), g);
+    const __m256 b = _mm256_mul_ps(_mm256_loadu_ps(samples + i + 8), g);
+    _mm256_storeu_ps(samples + i, a);
+    _mm256_storeu_ps(samples + i + 8, b);
+  }
+  for (; i + 8 <= numSamples; i += 8)
+    _mm256_storeu_ps(samples + i, _mm256_mul_ps(_mm256_loadu_ps(samples + i), g));
+  for (; i < numSamples; ++i)
+    samples[i] *= gain;
+}
+
+//==============================================================================
+// AVX-512, the tail is handled with a masked load/store
+//==============================================================================
+NTHN_TARGET("avx512f")
+void apply_ramp_avx512(float *samples, const float *ramp, float scale, int numSamples) {
+  const __m512 s = _mm512_set1_ps(scale);
+  int i = 0;
+  for (; i + 16 <= numSamples; i += 16)
+    _mm512_storeu_ps(samples + i, _mm512_mul_ps(_mm512_loadu_ps(samples + i),
+                                                _mm512_mul_ps(_mm512_loadu_ps(ramp + i), s)));
+  if (i < numSamples) {
+    const __mmask16 mask = __mmask16((1u << (numSamples - i)) - 1u);
+    const __m512 x = _mm512_maskz_loadu_ps(mask, samples + i);
+    const __m512 r = _mm512_maskz_loadu_ps(mask, ramp + i);
+    _mm512_mask_storeu_ps(samples + i, mask, _mm512_mul_ps(x, _mm512_mul_ps(r, s)));
+  }
+}
+
+NTHN_TARGET("avx512f")
+void apply_ramp_stereo_avx512(float *left, float *right, const float *ramp, float scale,
+                              int numSamples) {
+  const __m512 s = _mm512_set1_ps(scale);
+  int i = 0;
+  for (; i + 16 <= numSamples; i += 16) {
+    const __m512 g = _mm512_mul_ps(_mm512_loadu_ps(ramp + i), s);
+    _mm512_storeu_ps(left + i, _mm512_mul_ps(_mm512_loadu_ps(left + i), g));
+    _mm512_storeu_ps(right + i, _mm512_mul_ps(_mm512_loadu_ps(right + i), g));
+  }
+  if (i < numSamples) {
+    const __mmask16 mask = __mmask16((1u << (numSamples - i)) - 1u);
+    const __m512 g = _mm512_mul_ps(_mm512_maskz_loadu_ps(mask, ramp + i), s);
+    _mm512_mask_storeu_ps(left + i, mask,
+                          _mm512_mul_ps(_mm512_maskz_loadu_ps(mask, left + i), g));
+    _mm512_mask_storeu_ps(right + i, mask,
+                          _mm512_mul_ps(_mm512_maskz_loadu_ps(mask, right + i), g));
+  }
+}
+
+NTHN_TARGET("avx512f")
+void apply_constant_avx512(float *samples, float gain, int numSamples) {
+  const __m512 g = _mm512_set1_ps(gain);
+  int i = 0;
+  for (; i + 16 <= numSamples; i += 16)
+    _mm512_storeu_ps(samples + i, _mm512_mul_ps(_mm512_loadu_ps(samples + i), g));
+  if (i < numSamples) {
+    const __mmask16 mask = __mmask16((1u << (numSamples - i)) - 1u);
+    _mm512_mask_storeu_ps(samples + i, mask,
+                          _mm512_mul_ps(_mm512_maskz_loadu_ps(mask, samples + i), g));
+  }
+}
+//==============================================================================
+// double precision. the gain is computed in float, then widened and applied to
+// 2, 4 or 8 doubles per register
+//==============================================================================
+NTHN_TARGET("sse2")
+void apply_ramp_double_sse2(double *samples, const float *ramp, float scale, int numSamples) {
+  const __m128 s = _mm_set1_ps(scale);
+  int i = 0;
+  for (; i + 4 <= numSamples; i += 4) {
+    const __m128 g = _mm_mul_ps(_mm_loadu_ps(ramp + i), s);
+    _mm_storeu_pd(samples + i, _mm_mul_pd(_mm_loadu_pd(samples + i), _mm_cvtps_pd(g)));
+    _mm_storeu_pd(samples + i + 2,
+                  _mm_mul_pd(_mm_loadu_pd(samples + i + 2), _mm_cvtps_pd(_mm_movehl_ps(g, g))));
+  }
+  for (; i < numSamples; ++i)
+    samples[i] *= double(ramp[i] * scale);
+}
+
+NTHN_TARGET("sse2")
+void apply_ramp_stereo_double_sse2(double *left, double *right, const float *ramp, float scale,
+                                   int numSamples) {
+  const __m128 s = _mm_set1_ps(scale);
+  int i = 0;
+  for (; i + 4 <= numSamples; i += 4) {
+    const __m128 g = _mm_mul_ps(_mm_loadu_ps(ramp + i), s);
+    const __m128d ga = _mm_cvtps_pd(g);
+    const __m128d gb = _mm_cvtps_pd(_mm_movehl_ps(g, g));
+    _mm_storeu_pd(left + i, _mm_mul_pd(_mm_loadu_pd(left + i), ga));
+    _mm_storeu_pd(left + i + 2, _mm_mul_pd(_mm_loadu_pd(left + i + 2), gb));
+    _mm_storeu_pd(right + i, _mm_mul_pd(_mm_loadu_pd(right + i), ga));
+    _mm_storeu_pd(right + i + 2, _mm_mul_pd(_mm_loadu_pd(right + i + 2), gb));
+  }
+  for (; i < numSamples; ++i) {
+    const double g = double(ramp[i] * scale);
+    left[i] *= g;
+    right[i] *= g;
+  }
+}
+
+NTHN_TARGET("sse2")
+void apply_constant_double_sse2(double *samples, double gain, int numSamples) {
+  const __m128d g = _mm_set1_pd(gain);
+  int i = 0;
+  for (; i + 4 <= numSamples; i += 4) {
+    _mm_storeu_pd(samples + i, _mm_mul_pd(_mm_loadu_pd(samples + i), g));
+    _mm_storeu_pd(samples + i + 2, _mm_mul_pd(_mm_loadu_pd(samples + i + 2), g));
+  }
+  for (; i < numSamples; ++i)
+    samples[i] *= gain;
+}
+
+NTHN_TARGET("avx2")
+void apply_ramp_double_avx2(double *samples, const float *ramp, float scale, int numSamples) {
+  const __m256 s = _mm256_set1_ps(scale);
+  int i = 0;
+  for (; i + 8 <= numSamples; i += 8) {
+    const __m256 g = _mm256_mul_ps(_mm256_loadu_ps(ramp + i), s);
+    _mm256_storeu_pd(samples + i, _mm256_mul_pd(_mm256_loadu_pd(samples + i),
+                                                _mm256_cvtps_pd(_mm256_castps256_ps128(g))));
+    _mm256_storeu_pd(samples + i + 4, _mm256_mul_pd(_mm256_loadu_pd(samples + i + 4),
+                                                    _mm256_cvtps_pd(_mm256_extractf128_ps(g, 1))));
+  }
+  for (; i < numSamples; ++i)
+    samples[i] *= double(ramp[i] * scale);
+}
+
+NTHN_TARGET("avx2")
+void apply_ramp_stereo_double_avx2(double *left, double *right, const float *ramp, float scale,
+                                   int numSamples) {
+  const __m256 s = _mm256_set1_ps(scale);
+  int i = 0;
+  for (; i + 8 <= numSamples; i += 8) {
+    const __m256 g = _mm256_mul_ps(_mm256_loadu_ps(ramp + i), s);
+    const __m256d ga = _mm256_cvtps_pd(_mm256_castps256_ps128(g));
+    const __m256d gb = _mm256_cvtps_pd(_mm256_extractf128_ps(g, 1));
+    _mm256_storeu_pd(left + i, _mm256_mul_pd(_mm256_loadu_pd(left + i), ga));
+    _mm256_storeu_pd(left + i + 4, _mm256_mul_pd(_mm256_loadu_pd(left + i + 4), gb));
+    _mm256_storeu_pd(right + i, _mm256_mul_pd(_mm256_loadu_pd(right + i), ga));
+    _mm256_storeu_pd(right + i + 4, _mm256_mul_pd(_mm256_loadu_pd(right + i + 4), gb));
+  }
+  for (; i < numSamples; ++i) {
+    const double g = double(ramp[i] * scale);
+    left[i] *= g;
+    right[i] *= g;
+  }
+}
+
+NTHN_TARGET("avx2")
+void apply_constant_double_avx2(double *samples, double gain, int numSamples) {
+  const __m256d g = _mm256_set1_pd(gain);
+  int i = 0;
+  for (; i + 8 <= numSamples; i += 8) {
+    const __m256d a = _mm256_mul_pd(_mm256_loadu_pd(samples + i), g);
+    const __m256d b = _mm256_mul_pd(_mm256_loadu_pd(samples + i + 4), g);
+    _mm256_storeu_pd(samples + i, a);
+    _mm256_storeu_pd(samples + i + 4, b);
+  }
+  for (; i + 4 <= numSamples; i += 4)
+    _mm256_storeu_pd(samples + i, _mm256_mul_pd(_mm256_loadu_pd(samples + i), g));
+  for (; i < numSamples; ++i)
+    samples[i] *= gain;
+}
+
+NTHN_TARGET("avx512f")
+void apply_ramp_double_avx512(double *samples, const float *ramp, float scale, int numSamples) {
+  // 8 floats of ramp per 8 doubles. the maskz conversion does the same as
+  // _mm512_cvtps_pd, and the ramp tail is copied rather than loaded with a mask:
+  // the plain forms trip a false -Wmaybe-uninitialized in gcc's headers
+  const __m256 s = _mm256_set1_ps(scale);
+  int i = 0;
+  for (; i + 8 <= numSamples; i += 8) {
+    const __m512d g = _mm512_maskz_cvtps_pd(0xff, _mm256_mul_ps(_mm256_loadu_ps(ramp + i), s));
+    _mm512_storeu_pd(samples + i, _mm512_mul_pd(_mm512_loadu_pd(samples + i), g));
+  }
+  if (i < numSamples) {
+    const __mmask8 mask = __mmask8((1u << (numSamples - i)) - 1u);
+    float tail[8] = {};
+    for (int j = 0; j < numSamples - i; ++j)
+      tail[j] = ramp[i + j];
+    const __m512d g = _mm512_maskz_cvtps_pd(mask, _mm256_mul_ps(_mm256_loadu_ps(tail), s));
+    _mm512_mask_storeu_pd(samples + i, mask,
+                          _mm512_mul_pd(_mm512_maskz_loadu_pd(mask, samples + i), g));
+  }
+}
+
+NTHN_TARGET("avx512f")
+void apply_ramp_stereo_double_avx512(double *left, double *right, const float *ramp, float scale,
+                                     int numSamples) {
+  // see apply_ramp_double_avx512 for the maskz conversion and the copied tail
+  const __m256 s = _mm256_set1_ps(scale);
+  int i = 0;
+  for (; i + 8 <= numSamples; i += 8) {
+    const __m512d g = _mm512_maskz_cvtps_pd(0xff, _mm256_mul_ps(_mm256_loadu_ps(ramp + i), s));
+    _mm512_storeu_pd(left + i, _mm512_mul_pd(_mm512_loadu_pd(left + i), g));
+    _mm512_storeu_pd(right + i, _mm512_mul_pd(_mm512_loadu_pd(right + i), g));
+  }
+  if (i < numSamples) {
+    const __mmask8 mask = __mmask8((1u << (numSamples - i)) - 1u);
+    float tail[8] = {};
+    for (int j = 0; j < numSamples - i; ++j)
+      tail[j] = ramp[i + j];
+    const __m512d g = _mm512_maskz_cvtps_pd(mask, _mm256_mul_ps(_mm256_loadu_ps(tail), s));
+    _mm512_mask_storeu_pd(left + i, mask,
+                          _mm512_mul_pd(_mm512_maskz_loadu_pd(mask, left + i), g));
+    _mm512_mask_storeu_pd(right + i, mask,
+                          _mm512_mul_pd(_mm512_maskz_loadu_pd(mask, right + i), g));
+  }
+}
+
+NTHN_TARGET("avx512f")
+void apply_constant_double_avx512(double *samples, double gain, int numSamples) {
+  const __m512d g = _mm512_set1_pd(gain);
+  int i = 0;
+  for (; i + 8 <= numSamples; i += 8)
+    _mm512_storeu_pd(samples + i, _mm512_mul_pd(_mm512_loadu_pd(samples + i), g));
+  if (i < numSamples) {
+    const __mmask8 mask = __mmask8((1u << (numSamples - i)) - 1u);
+    _mm512_mask_storeu_pd(samples + i, mask,
+                          _mm512_mul_pd(_mm512_maskz_loadu_pd(mask, samples + i), g));
+  }
+}
+#endif
+
+// every compiled in path, indexed by SimdLevel
+template <typename SampleType> struct KernelTable;
+template <> struct KernelTable<float> {
+  static constexpr Kernels<float> paths[] = {
+      {apply_ramp_scalar<float>, apply_constant_scalar<float>, apply_ramp_stereo_scalar<float>,
+       nthn_utils::SimdLevel::Scalar},
+#if NTHN_X86
+      {apply_ramp_sse2, apply_constant_sse2, apply_ramp_stereo_sse2, nthn_utils::SimdLevel::SSE2},
+      {apply_ramp_avx2, apply_constant_avx2, apply_ramp_stereo_avx2, nthn_utils::SimdLevel::AVX2},
+      {apply_ramp_avx512, apply_constant_avx512, apply_ramp_stereo_avx512,
+       nthn_utils::SimdLevel::AVX512},
+#endif
+  };
+};
+template <> struct KernelTable<double> {
+  static constexpr Kernels<double> paths[] = {
+      {apply_ramp_scalar<double>, apply_constant_scalar<double>, apply_ramp_stereo_scalar<double>,
+       nthn_utils::SimdLevel::Scalar},
+#if NTHN_X86
+      {apply_ramp_double_sse2, apply_constant_double_sse2, apply_ramp_stereo_double_sse2,
+       nthn_utils::SimdLevel::SSE2},
+      {apply_ramp_double_avx2, apply_constant_double_avx2, apply_ramp_stereo_double_avx2,
+       nthn_utils::SimdLevel::AVX2},
+      {apply_ramp_double_avx512, apply_constant_double_avx512, apply_ramp_stereo_double_avx512,
+       nthn_utils::SimdLevel::AVX512},
+#endif
+  };
+};
+} // namespace
+
+NTHN_DEFINE_KERNEL_SET(KernelTable)
+} // namespace gain_kernels
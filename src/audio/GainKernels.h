@@ -0,0 +1,31 @@
+#pragma once
+
+#include "../Util/CpuFeatures.h"
+
+//==============================================================================
+// Inner loops for Gain, one set per instruction set and sample type
+// every path does exactly one multiply per sample, so all of them are bit exact
+// with the scalar reference path. the ramp is always float (it comes from the
+// parameter smoothing), ramp[i] * scale is computed in float and then applied
+// at the sample type's precision
+//==============================================================================
+namespace gain_kernels {
+template <typename SampleType> struct Kernels {
+  // samples[i] *= ramp[i] * scale
+  void (*apply_ramp)(SampleType *samples, const float *ramp, float scale, int numSamples);
+  // samples[i] *= gain
+  void (*apply_constant)(SampleType *samples, SampleType gain, int numSamples);
+  // left[i] *= ramp[i] * scale and right[i] *= ramp[i] * scale, each gain is
+  // computed once and applied to a register of each channel
+  void (*apply_ramp_stereo)(SampleType *left, SampleType *right, const float *ramp, float scale,
+                            int numSamples);
+  nthn_utils::SimdLevel level;
+};
+
+// plain c++ reference path
+template <typename SampleType> const Kernels<SampleType> &scalar();
+// kernels for a specific instruction set, falls back to scalar when not compiled in
+template <typename SampleType> const Kernels<SampleType> &for_level(nthn_utils::SimdLevel level);
+// the fastest kernels this cpu supports, detected once
+template <typename SampleType> const Kernels<SampleType> &best();
+} // namespace gain_kernels
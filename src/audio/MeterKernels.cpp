@@ -0,0 +1,224 @@
+#include "MeterKernels.h"
+
+namespace meter_kernels {
+namespace {
+//==============================================================================
+// scalar
+//==============================================================================
+template <typename SampleType>
+void accumulate_scalar(const SampleType *samples, int numSamples, SampleType &min,
+                       SampleType &max, SampleType &sum_squares) {
+  SampleType lo = min, hi = max, sum = SampleType(0);
+  for (int i = 0; i < numSamples; ++i) {
+    const SampleType x = samples[i];
+    lo = x < lo ? x : lo;
+    hi = x > hi ? x : hi;
+    sum += x * x;
+  }
+  min = lo;
+  max = hi;
+  sum_squares += sum;
+}
+
+// folds the lanes of the simd accumulators into the running values, then the
+// samples the vector loop left over
+template <typename SampleType, size_t Lanes>
+void finish(const SampleType (&lo)[Lanes], const SampleType (&hi)[Lanes],
+            const SampleType (&sum)[Lanes], const SampleType *tail, int tail_samples,
+            SampleType &min, SampleType &max, SampleType &sum_squares) {
+  SampleType total = SampleType(0);
+  for (size_t k = 0; k < Lanes; ++k) {
+    min = lo[k] < min ? lo[k] : min;
+    max = hi[k] > max ? hi[k] : max;
+    total += sum[k];
+  }
+  sum_squares += total;
+  accumulate_scalar(tail, tail_samples, min, max, sum_squares);
+}
+
+#if NTHN_X86
+//==============================================================================
+// SSE2, 8 floats or 4 doubles per iteration, in two sets of accumulators
+//==============================================================================
+NTHN_TARGET("sse2")
+void accumulate_sse2(const float *samples, int numSamples, float &min, float &max,
+                     float &sum_squares) {
+  __m128 lo0 = _mm_set1_ps(min), lo1 = lo0;
+  __m128 hi0 = _mm_set1_ps(max), hi1 = hi0;
+  __m128 sum0 = _mm_setzero_ps(), sum1 = sum0;
+  int i = 0;
+  for (; i + 8 <= numSamples; i += 8) {
+    const __m128 a = _mm_loadu_ps(samples + i);
+    const __m128 b = _mm_loadu_ps(samples + i + 4);
+    lo0 = _mm_min_ps(lo0, a);
+    lo1 = _mm_min_ps(lo1, b);
+    hi0 = _mm_max_ps(hi0, a);
+    hi1 = _mm_max_ps(hi1, b);
+    sum0 = _mm_add_ps(sum0, _mm_mul_ps(a, a));
+    sum1 = _mm_add_ps(sum1, _mm_mul_ps(b, b));
+  }
+  alignas(16) float lo[4], hi[4], sum[4];
+  _mm_store_ps(lo, _mm_min_ps(lo0, lo1));
+  _mm_store_ps(hi, _mm_max_ps(hi0, hi1));
+  _mm_store_ps(sum, _mm_add_ps(sum0, sum1));
+  finish(lo, hi, sum, samples + i, numSamples - i, min, max, sum_squares);
+}
+
+NTHN_TARGET("sse2")
+void accumulate_double_sse2(const double *samples, int numSamples, double &min, double &max,
+                            double &sum_squares) {
+  __m128d lo0 = _mm_set1_pd(min), lo1 = lo0;
+  __m128d hi0 = _mm_set1_pd(max), hi1 = hi0;
+  __m128d sum0 = _mm_setzero_pd(), sum1 = sum0;
+  int i = 0;
+  for (; i + 4 <= numSamples; i += 4) {
+    const __m128d a = _mm_loadu_pd(samples + i);
+    const __m128d b = _mm_loadu_pd(samples + i + 2);
+    lo0 = _mm_min_pd(lo0, a);
+    lo1 = _mm_min_pd(lo1, b);
+    hi0 = _mm_max_pd(hi0, a);
+    hi1 = _mm_max_pd(hi1, b);
+    sum0 = _mm_add_pd(sum0, _mm_mul_pd(a, a));
+    sum1 = _mm_add_pd(sum1, _mm_mul_pd(b, b));
+  }
+  alignas(16) double lo[2], hi[2], sum[2];
+  _mm_store_pd(lo, _mm_min_pd(lo0, lo1));
+  _mm_store_pd(hi, _mm_max_pd(hi0, hi1));
+  _mm_store_pd(sum, _mm_add_pd(sum0, sum1));
+  finish(lo, hi, sum, samples + i, numSamples - i, min, max, sum_squares);
+}
+
+//==============================================================================
+// AVX2, 16 floats or 8 doubles per iteration
+//==============================================================================
+NTHN_TARGET("avx2")
+void accumulate_avx2(const float *samples, int numSamples, float &min, float &max,
+                     float &sum_squares) {
+  __m256 lo0 = _mm256_set1_ps(min), lo1 = lo0;
+  __m256 hi0 = _mm256_set1_ps(max), hi1 = hi0;
+  __m256 sum0 = _mm256_setzero_ps(), sum1 = sum0;
+  int i = 0;
+  for (; i + 16 <= numSamples; i += 16) {
+    const __m256 a = _mm256_loadu_ps(samples + i);
+    const __m256 b = _mm256_loadu_ps(samples + i + 8);
+    lo0 = _mm256_min_ps(lo0, a);
+    lo1 = _mm256_min_ps(lo1, b);
+    hi0 = _mm256_max_ps(hi0, a);
+    hi1 = _mm256_max_ps(hi1, b);
+    sum0 = _mm256_add_ps(sum0, _mm256_mul_ps(a, a));
+    sum1 = _mm256_add_ps(sum1, _mm256_mul_ps(b, b));
+  }
+  alignas(32) float lo[8], hi[8], sum[8];
+  _mm256_store_ps(lo, _mm256_min_ps(lo0, lo1));
+  _mm256_store_ps(hi, _mm256_max_ps(hi0, hi1));
+  _mm256_store_ps(sum, _mm256_add_ps(sum0, sum1));
+  finish(lo, hi, sum, samples + i, numSamples - i, min, max, sum_squares);
+}
+
+NTHN_TARGET("avx2")
+void accumulate_double_avx2(const double *samples, int numSamples, double &min, double &max,
+                            double &sum_squares) {
+  __m256d lo0 = _mm256_set1_pd(min), lo1 = lo0;
+  __m256d hi0 = _mm256_set1_pd(max), hi1 = hi0;
+  __m256d sum0 = _mm256_setzero_pd(), sum1 = sum0;
+  int i = 0;
+  for (; i + 8 <= numSamples; i += 8) {
+    const __m256d a = _mm256_loadu_pd(samples + i);
+    const __m256d b = _mm256_loadu_pd(samples + i + 4);
+    lo0 = _mm256_min_pd(lo0, a);
+    lo1 = _mm256_min_pd(lo1, b);
+    hi0 = _mm256_max_pd(hi0, a);
+    hi1 = _mm256_max_pd(hi1, b);
+    sum0 = _mm256_add_pd(sum0, _mm256_mul_pd(a, a));
+    sum1 = _mm256_add_pd(sum1, _mm256_mul_pd(b, b));
+  }
+  alignas(32) double lo[4], hi[4], sum[4];
+  _mm256_store_pd(lo, _mm256_min_pd(lo0, lo1));
+  _mm256_store_pd(hi, _mm256_max_pd(hi0, hi1));
+  _mm256_store_pd(sum, _mm256_add_pd(sum0, sum1));
+  finish(lo, hi, sum, samples + i, numSamples - i, min, max, sum_squares);
+}
+
+//==============================================================================
+// AVX-512, 32 floats or 16 doubles per iteration. min and max use the
+// zero-masked forms with every lane set, the plain ones trip a false
+// -Wmaybe-uninitialized in gcc's headers
+//==============================================================================
+constexpr __mmask16 ALL_FLOAT_LANES = 0xffff;
+constexpr __mmask8 ALL_DOUBLE_LANES = 0xff;
+
+NTHN_TARGET("avx512f")
+void accumulate_avx512(const float *samples, int numSamples, float &min, float &max,
+                       float &sum_squares) {
+  __m512 lo0 = _mm512_set1_ps(min), lo1 = lo0;
+  __m512 hi0 = _mm512_set1_ps(max), hi1 = hi0;
+  __m512 sum0 = _mm512_setzero_ps(), sum1 = sum0;
+  int i = 0;
+  for (; i + 32 <= numSamples; i += 32) {
+    const __m512 a = _mm512_loadu_ps(samples + i);
+    const __m512 b = _mm512_loadu_ps(samples + i + 16);
+    lo0 = _mm512_maskz_min_ps(ALL_FLOAT_LANES, lo0, a);
+    lo1 = _mm512_maskz_min_ps(ALL_FLOAT_LANES, lo1, b);
+    hi0 = _mm512_maskz_max_ps(ALL_FLOAT_LANES, hi0, a);
+    hi1 = _mm512_maskz_max_ps(ALL_FLOAT_LANES, hi1, b);
+    sum0 = _mm512_add_ps(sum0, _mm512_mul_ps(a, a));
+    sum1 = _mm512_add_ps(sum1, _mm512_mul_ps(b, b));
+  }
+  alignas(64) float lo[16], hi[16], sum[16];
+  _mm512_store_ps(lo, _mm512_maskz_min_ps(ALL_FLOAT_LANES, lo0, lo1));
+  _mm512_store_ps(hi, _mm512_maskz_max_ps(ALL_FLOAT_LANES, hi0, hi1));
+  _mm512_store_ps(sum, _mm512_add_ps(sum0, sum1));
+  finish(lo, hi, sum, samples + i, numSamples - i, min, max, sum_squares);
+}
+
+NTHN_TARGET("avx512f")
+void accumulate_double_avx512(const double *samples, int numSamples, double &min, double &max,
+                              double &sum_squares) {
+  __m512d lo0 = _mm512_set1_pd(min), lo1 = lo0;
+  __m512d hi0 = _mm512_set1_pd(max), hi1 = hi0;
+  __m512d sum0 = _mm512_setzero_pd(), sum1 = sum0;
+  int i = 0;
+  for (; i + 16 <= numSamples; i += 16) {
+    const __m512d a = _mm512_loadu_pd(samples + i);
+    const __m512d b = _mm512_loadu_pd(samples + i + 8);
+    lo0 = _mm512_maskz_min_pd(ALL_DOUBLE_LANES, lo0, a);
+    lo1 = _mm512_maskz_min_pd(ALL_DOUBLE_LANES, lo1, b);
+    hi0 = _mm512_maskz_max_pd(ALL_DOUBLE_LANES, hi0, a);
+    hi1 = _mm512_maskz_max_pd(ALL_DOUBLE_LANES, hi1, b);
+    sum0 = _mm512_add_pd(sum0, _mm512_mul_pd(a, a));
+    sum1 = _mm512_add_pd(sum1, _mm512_mul_pd(b, b));
+  }
+  alignas(64) double lo[8], hi[8], sum[8];
+  _mm512_store_pd(lo, _mm512_maskz_min_pd(ALL_DOUBLE_LANES, lo0, lo1));
+  _mm512_store_pd(hi, _mm512_maskz_max_pd(ALL_DOUBLE_LANES, hi0, hi1));
+  _mm512_store_pd(sum, _mm512_add_pd(sum0, sum1));
+  finish(lo, hi, sum, samples + i, numSamples - i, min, max, sum_squares);
+}
+#endif
+
+// every compiled in path, indexed by SimdLevel
+template <typename SampleType> struct KernelTable;
+template <> struct KernelTable<float> {
+  static constexpr Kernels<float> paths[] = {
+      {accumulate_scalar<float>, nthn_utils::SimdLevel::Scalar},
+#if NTHN_X86
+      {accumulate_sse2, nthn_utils::SimdLevel::SSE2},
+      {accumulate_avx2, nthn_utils::SimdLevel::AVX2},
+      {accumulate_avx512, nthn_utils::SimdLevel::AVX512},
+#endif
+  };
+};
+template <> struct KernelTable<double> {
+  static constexpr Kernels<double> paths[] = {
+      {accumulate_scalar<double>, nthn_utils::SimdLevel::Scalar},
+#if NTHN_X86
+      {accumulate_double_sse2, nthn_utils::SimdLevel::SSE2},
+      {accumulate_double_avx2, nthn_utils::SimdLevel::AVX2},
+      {accumulate_double_avx512, nthn_utils::SimdLevel::AVX512},
+#endif
+  };
+};
+} // namespace
+
+NTHN_DEFINE_KERNEL_SET(KernelTable)
+} // namespace meter_kernels
@@ -0,0 +1,27 @@
+#pragma once
+
+#include "../Util/CpuFeatures.h"
+
+//==============================================================================
+// Level metering, one set per instruction set and sample type
+// one pass over a channel gives its smallest and largest sample (the waveform
+// outline, and the peak) and its sum of squares (the rms). the simd paths keep
+// several lanes of each, so the sum is added in a different order than the
+// scalar path and can differ from it in the last bits
+//==============================================================================
+namespace meter_kernels {
+template <typename SampleType> struct Kernels {
+  // folds samples[0, numSamples) into min, max and sum_squares, which hold the
+  // running values of the frame so far
+  void (*accumulate)(const SampleType *samples, int numSamples, SampleType &min, SampleType &max,
+                     SampleType &sum_squares);
+  nthn_utils::SimdLevel level;
+};
+
+// plain c++ reference path
+template <typename SampleType> const Kernels<SampleType> &scalar();
+// kernels for a specific instruction set, falls back to scalar when not compiled in
+template <typename SampleType> const Kernels<SampleType> &for_level(nthn_utils::SimdLevel level);
+// the fastest kernels this cpu supports, detected once
+template <typename SampleType> const Kernels<SampleType> &best();
+} // namespace meter_kernels
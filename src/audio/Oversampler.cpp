@@ -0,0 +1,227 @@
+#include "Oversampler.h"
+#include "FirKernels.h"
+
+#include <algorithm>
+#include <cmath>
+
+namespace {
+// non-zero taps per side of the half-band filter of each stage, by quality.
+// the first stage has the narrowest transition band, later stages run at rates
+// where the band above the original signal is already empty, so they need fewer taps
+constexpr int NUM_QUALITIES = 3, MAX_STAGES = 3;
+constexpr int HALF_TAPS[NUM_QUALITIES][MAX_STAGES] = {
+    {8, 4, 3},  // LOW
+    {16, 6, 4}, // NORMAL
+    {32, 8, 6}, // HIGH
+};
+constexpr double ATTENUATION_DB[NUM_QUALITIES] = {60.0, 90.0, 120.0};
+
+// zeroth order modified bessel function of the first kind, for the kaiser window
+double bessel_i0(double x) {
+  double sum = 1.0, term = 1.0;
+  for (int k = 1; k < 50; ++k) {
+    term *= (x / (2.0 * k)) * (x / (2.0 * k));
+    sum += term;
+    if (term < sum * 1.0e-12)
+      break;
+  }
+  return sum;
+}
+} // namespace
+
+template <typename SampleType>
+Oversampler<SampleType>::Oversampler() : kernels(&fir_kernels::best<SampleType>()) {
+  static_assert(Oversampler::NUM_QUALITIES == NUM_QUALITIES && Oversampler::MAX_STAGES == MAX_STAGES,
+                "the filter tables above need a row per quality and a column per stage");
+  for (int q = 0; q < NUM_QUALITIES; ++q)
+    for (int s = 0; s < MAX_STAGES; ++s)
+      filters[size_t(q)][size_t(s)] = design_half_band(HALF_TAPS[q][s], ATTENUATION_DB[q]);
+}
+
+template <typename SampleType> Oversampler<SampleType>::~Oversampler() {}
+
+//==============================================================================
+// kaiser windowed sinc with its cutoff at half nyquist.
+// with the centre tap at M = 2 * half_taps - 1, every tap an even distance from
+// the centre is zero, so only the taps at odd distances are stored
+//==============================================================================
+template <typename SampleType>
+typename Oversampler<SampleType>::HalfBand
+Oversampler<SampleType>::design_half_band(int half_taps, double attenuation_db) {
+  const double pi = 3.14159265358979323846;
+  const int centre = 2 * half_taps - 1;
+  const double beta = attenuation_db > 50.0 ? 0.1102 * (attenuation_db - 8.7)
+                                            : 0.5842 * std::pow(attenuation_db - 21.0, 0.4) +
+                                                  0.07886 * (attenuation_db - 21.0);
+  HalfBand filter;
+  filter.half_taps = half_taps;
+  filter.coefficients.resize(size_t(2 * half_taps));
+  // designed in double, then rounded to the sample type
+  std::vector<double> taps(size_t(2 * half_taps));
+  double sum = 0.0;
+  for (int j = 0; j < 2 * half_taps; ++j) {
+    const int distance = 2 * j - centre; // odd, from -centre to centre
+    const double x = double(distance) / double(centre + 1);
+    const double window = bessel_i0(beta * std::sqrt(std::max(0.0, 1.0 - x * x))) / bessel_i0(beta);
+    const double sinc = std::sin(0.5 * pi * distance) / (pi * distance);
+    taps[size_t(j)] = sinc * window;
+    sum += sinc * window;
+  }
+  // the odd taps of a half-band filter sum to 0.5, so the dc gain is exactly 1
+  for (size_t j = 0; j < taps.size(); ++j)
+    filter.coefficients[j] = SampleType(taps[j] * 0.5 / sum);
+  filter.interpolation_coefficients = filter.coefficients;
+  for (auto &c : filter.interpolation_coefficients)
+    c *= SampleType(2);
+  return filter;
+}
+
+template <typename SampleType>
+double Oversampler<SampleType>::latency_for(int num_stages_, Quality quality_) {
+  // each filter delays by its centre tap M = 2 * half_taps - 1 at the higher rate
+  // of its stage, and the decimator keeps the odd samples, half a sample earlier.
+  // so a round trip through stage s (from 1) delays by (2M - 1) / 2^s host samples
+  double latency = 0.0;
+  for (int s = 0; s < num_stages_; ++s)
+    latency += double(2 * (2 * HALF_TAPS[quality_][s] - 1) - 1) / double(2 << s);
+  return latency;
+}
+
+//==============================================================================
+template <typename SampleType>
+void Oversampler<SampleType>::prepare(int max_block_size_, int max_channels_) {
+  max_block_size = std::max(max_block_size_, 1);
+  max_channels = std::max(max_channels_, 1);
+
+  for (int s = 0; s < MAX_STAGES; ++s) {
+    // the input length of stage s, and the longest history any quality needs
+    const size_t input_length = size_t(max_block_size) << s;
+    const size_t history = size_t(2 * HALF_TAPS[HIGH][s] - 1);
+    stage_buffers[size_t(s)].assign(size_t(max_channels), {});
+    for (auto &buffers : stage_buffers[size_t(s)]) {
+      buffers.up.assign(history + input_length, SampleType(0));
+      buffers.down_odd.assign(history + input_length, SampleType(0));
+      buffers.down_even.assign(history + input_length, SampleType(0));
+    }
+  }
+  for (int level = 1; level <= MAX_STAGES; ++level) {
+    level_buffers[size_t(level)].assign(size_t(max_channels),
+                                        std::vector<SampleType>(size_t(max_block_size) << level));
+    level_pointers[size_t(level)].resize(size_t(max_channels));
+    for (int c = 0; c < max_channels; ++c)
+      level_pointers[size_t(level)][size_t(c)] = level_buffers[size_t(level)][size_t(c)].data();
+  }
+  level_pointers[0].assign(size_t(max_channels), nullptr);
+  host_pointers.assign(size_t(max_channels), nullptr);
+  scratch.assign(size_t(max_channels),
+                 std::vector<SampleType>(size_t(max_block_size) << (MAX_STAGES - 1)));
+}
+
+template <typename SampleType>
+bool Oversampler<SampleType>::configure(int num_stages_, Quality quality_) {
+  num_stages_ = std::clamp(num_stages_, 0, MAX_STAGES);
+  quality_ = Quality(std::clamp(int(quality_), 0, NUM_QUALITIES - 1));
+  if (num_stages_ == num_stages && quality_ == quality)
+    return false;
+  num_stages = num_stages_;
+  quality = quality_;
+  reset();
+  return true;
+}
+
+template <typename SampleType> void Oversampler<SampleType>::reset() {
+  for (auto &stage : stage_buffers)
+    for (auto &buffers : stage) {
+      std::fill(buffers.up.begin(), buffers.up.end(), SampleType(0));
+      std::fill(buffers.down_odd.begin(), buffers.down_odd.end(), SampleType(0));
+      std::fill(buffers.down_even.begin(), buffers.down_even.end(), SampleType(0));
+    }
+}
+
+template <typename SampleType>
+void Oversampler<SampleType>::setKernels(const fir_kernels::Kernels<SampleType> &kernels_) {
+  kernels = &kernels_;
+}
+
+//==============================================================================
+template <typename SampleType>
+int Oversampler<SampleType>::set_host_pointers(SampleType *const *buffer, int startSample,
+                                               int numSamples, int firstChannel, int numChannels) {
+  // prepare() sizes every buffer, more than that would have to allocate
+  numChannels = std::max(0, std::min(numChannels, max_channels - firstChannel));
+  (void)numSamples;
+  for (int c = firstChannel; c < firstChannel + numChannels; ++c)
+    host_pointers[size_t(c)] = buffer[c] + startSample;
+  return numChannels;
+}
+
+//==============================================================================
+// interpolation by 2, for input x and the non-zero taps c (times 2):
+//   y[2n]     = sum over j of c[j] * x[n - j]
+//   y[2n + 1] = x[n - (half_taps - 1)]          (the centre tap)
+//==============================================================================
+template <typename SampleType>
+void Oversampler<SampleType>::upsample(int numSamples, int firstChannel, int numChannels) {
+  const size_t first = size_t(firstChannel), end = size_t(firstChannel + numChannels);
+  for (size_t c = first; c < end; ++c)
+    level_pointers[0][c] = host_pointers[c];
+
+  for (int s = 0; s < num_stages; ++s) {
+    const auto &filter = filters[size_t(quality)][size_t(s)];
+    const int history = 2 * filter.half_taps - 1;
+    const int length = numSamples << s;
+    for (size_t c = first; c < end; ++c) {
+      SampleType *work = stage_buffers[size_t(s)][c].up.data();
+      const SampleType *input = level_pointers[size_t(s)][c];
+      SampleType *output = level_pointers[size_t(s + 1)][c];
+      SampleType *even = scratch[c].data();
+
+      std::copy(input, input + length, work + history);
+      kernels->convolve(work, filter.interpolation_coefficients.data(), 2 * filter.half_taps, even,
+                        length);
+      const SampleType *centre = work + filter.half_taps;
+      for (int i = 0; i < length; ++i) {
+        output[2 * i] = even[i];
+        output[2 * i + 1] = centre[i];
+      }
+      // keep the last samples as history for the next block
+      std::copy(work + length, work + length + history, work);
+    }
+  }
+}
+
+//==============================================================================
+// decimation by 2, for input v and the non-zero taps c:
+//   y[n] = sum over j of c[j] * v[2(n - j) + 1] + 0.5 * v[2(n - (half_taps - 1))]
+//==============================================================================
+template <typename SampleType>
+void Oversampler<SampleType>::downsample(int numSamples, int firstChannel, int numChannels) {
+  const size_t first = size_t(firstChannel), end = size_t(firstChannel + numChannels);
+  for (int s = num_stages - 1; s >= 0; --s) {
+    const auto &filter = filters[size_t(quality)][size_t(s)];
+    const int odd_history = 2 * filter.half_taps - 1;
+    const int even_history = filter.half_taps - 1;
+    const int length = numSamples << s;
+    for (size_t c = first; c < end; ++c) {
+      auto &buffers = stage_buffers[size_t(s)][c];
+      SampleType *odd = buffers.down_odd.data();
+      SampleType *even = buffers.down_even.data();
+      const SampleType *input = level_pointers[size_t(s + 1)][c];
+      SampleType *output = level_pointers[size_t(s)][c];
+
+      for (int i = 0; i < length; ++i) {
+        even[even_history + i] = input[2 * i];
+        odd[odd_history + i] = input[2 * i + 1];
+      }
+      kernels->convolve(odd, filter.coefficients.data(), 2 * filter.half_taps, output, length);
+      for (int i = 0; i < length; ++i)
+        output[i] += SampleType(0.5) * even[i];
+
+      std::copy(odd + length, odd + length + odd_history, odd);
+      std::copy(even + length, even + length + even_history, even);
+    }
+  }
+}
+
+template class Oversampler<float>;
+template class Oversampler<double>;
@@ -0,0 +1,130 @@
+#pragma once
+
+namespace fir_kernels {
+template <typename SampleType> struct Kernels;
+}
+
+#include <array>
+#include <cmath>
+#include <cstddef>
+#include <utility>
+#include <vector>
+
+//==============================================================================
+// Oversampler
+// 2x, 4x or 8x oversampling with a cascade of polyphase half-band FIR filters,
+// for float or double samples (instantiated in Oversampler.cpp)
+//
+// each 2x stage only convolves the half of the filter taps that are not zero,
+// at the lower of its two rates; the centre tap is a plain delay. the filter
+// loops run on the fir_kernels simd paths.
+// every buffer is allocated in prepare(), for the highest factor and quality,
+// so switching factor or quality on the audio thread does not allocate
+//
+// usage, from processBlock:
+//   oversampler.process(buffer, start, length, numChannels,
+//                       [&](float *const *oversampled, int oversampledLength) {
+//                         // nonlinear processing, at get_factor() times the host rate
+//                       });
+// channels are independent, so disjoint channel ranges can be processed on
+// different threads at the same time with process_channels()
+//==============================================================================
+template <typename SampleType> class Oversampler {
+public:
+  // filter quality, more taps give a steeper filter with more stopband attenuation
+  enum Quality { LOW, NORMAL, HIGH, NUM_QUALITIES };
+  // 2^3 = 8x
+  static constexpr int MAX_STAGES = 3;
+
+  Oversampler();
+  ~Oversampler();
+
+  // called from prepareToPlay. blocks passed to process() must not be longer
+  // than max_block_size or have more than max_channels channels
+  void prepare(int max_block_size_, int max_channels_);
+  // number of 2x stages (0 is off, 3 is 8x) and filter quality, called from the
+  // audio thread. returns true if the configuration changed, which clears the filters
+  bool configure(int num_stages_, Quality quality_);
+  // clear the filter states, called from the audio thread
+  void reset();
+
+  int get_num_stages() const { return num_stages; }
+  int get_factor() const { return 1 << num_stages; }
+  // delay of the round trip through the filters, in host rate samples
+  double get_latency() const { return latency_for(num_stages, quality); }
+  static double latency_for(int num_stages_, Quality quality_);
+  // length of the round trip's impulse response, in host rate samples. the
+  // filters are linear phase, so it's symmetric around the latency
+  int get_tail_samples() const {
+    return num_stages == 0 ? 0 : int(std::ceil(2.0 * get_latency())) + 1;
+  }
+
+  // upsamples the block, calls process_oversampled(channels, numOversampledSamples)
+  // and downsamples the result back into the block. with no stages, the block is
+  // passed straight through
+  template <typename ProcessFn>
+  void process(SampleType *const *buffer, int startSample, int numSamples, int numChannels,
+               ProcessFn &&process_oversampled) {
+    process_channels(buffer, startSample, numSamples, 0, numChannels,
+                     std::forward<ProcessFn>(process_oversampled));
+  }
+
+  // the same for channels [firstChannel, firstChannel + numChannels) of buffer.
+  // process_oversampled gets the pointers of those channels only
+  template <typename ProcessFn>
+  void process_channels(SampleType *const *buffer, int startSample, int numSamples, int firstChannel,
+                        int numChannels, ProcessFn &&process_oversampled) {
+    numChannels = set_host_pointers(buffer, startSample, numSamples, firstChannel, numChannels);
+    const auto first = std::size_t(firstChannel);
+    if (num_stages == 0) {
+      process_oversampled(host_pointers.data() + first, numSamples);
+      return;
+    }
+    upsample(numSamples, firstChannel, numChannels);
+    process_oversampled(level_pointers[std::size_t(num_stages)].data() + first,
+                        numSamples << num_stages);
+    downsample(numSamples, firstChannel, numChannels);
+  }
+
+  // swap the simd kernels, e.g. for the scalar reference path
+  void setKernels(const fir_kernels::Kernels<SampleType> &kernels_);
+
+private:
+  // non-zero taps of one half-band filter (the centre tap is always 0.5)
+  struct HalfBand {
+    int half_taps{0}; // there are 2 * half_taps non-zero taps, besides the centre
+    std::vector<SampleType> coefficients;            // for decimation
+    std::vector<SampleType> interpolation_coefficients; // coefficients * 2, for interpolation
+  };
+  static HalfBand design_half_band(int half_taps, double attenuation_db);
+
+  // filter memory of one stage and channel, the history is kept at the front
+  struct StageBuffers {
+    std::vector<SampleType> up;        // input of the interpolator
+    std::vector<SampleType> down_odd;  // odd phase of the decimator input
+    std::vector<SampleType> down_even; // even phase of the decimator input
+  };
+
+  // returns the number of channels that fit in what prepare() allocated
+  int set_host_pointers(SampleType *const *buffer, int startSample, int numSamples, int firstChannel,
+                        int numChannels);
+  void upsample(int numSamples, int firstChannel, int numChannels);
+  void downsample(int numSamples, int firstChannel, int numChannels);
+
+  const fir_kernels::Kernels<SampleType> *kernels;
+  std::array<std::array<HalfBand, MAX_STAGES>, NUM_QUALITIES> filters;
+
+  int num_stages{0};
+  Quality quality{NORMAL};
+  int max_block_size{0};
+  int max_channels{0};
+
+  // [stage][channel]
+  std::array<std::vector<StageBuffers>, MAX_STAGES> stage_buffers;
+  // the signal at each rate: level 0 is the host buffer, level s is 2^s times the host rate
+  std::array<std::vector<std::vector<SampleType>>, MAX_STAGES + 1> level_buffers;
+  std::array<std::vector<SampleType *>, MAX_STAGES + 1> level_pointers;
+  std::vector<SampleType *> host_pointers;
+  // [channel], per channel so channel ranges can run in parallel
+  std::vector<std::vector<SampleType>> scratch;
+};
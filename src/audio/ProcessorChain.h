@@ -0,0 +1,215 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+
+//==============================================================================
+// ProcessorChain
+// runs a fixed list of processing stages in a single pass over each channel.
+//
+// instead of every stage reading and writing the whole buffer in turn, the chain
+// walks each channel in frames of FRAME_SIZE samples, and runs every stage on a
+// frame before moving to the next. a frame stays in L1 between stages, so a
+// chain of N stages brings buffer memory into cache once instead of N times,
+// and the stage calls are resolved at compile time.
+//
+// the stages run in place on the buffer, one frame-sized chunk at a time, so a
+// stage with simd kernels (like Gain) runs them on whole vectors: FRAME_SIZE
+// is a multiple of the widest register (16 floats, 8 doubles), and only the
+// last frame of a range is shorter
+//
+// a stage declares the sample type it processes (float or double, the chain
+// takes its own from the first stage), and implements one of these kernels:
+//   using SampleType = float;
+//   SampleType process_sample(SampleType sample, int channel, int index)
+//   void process_frame(SampleType *frame, int channel, int index, int length)
+// where index is the position of the (first) sample in the processed range and
+// length is at most FRAME_SIZE. and optionally:
+//   void process_frame_stereo(SampleType *left, SampleType *right, int index, int length)
+//   void prepare(double sample_rate, int max_block_size, int num_channels)
+//   void begin_block(int num_channels, int num_samples) // per-block setup
+//   void reset()
+// block parameters (ramps, coefficients...) are set on the stages directly,
+// through get<Stage>() or get<index>(), before calling process()
+//
+// to split the channels across threads, call begin_block() once, then
+// process_channels() for disjoint channel ranges. the stages' kernels must only
+// touch per-channel state for that to be safe
+//
+// the channel loop is specialised for mono, stereo and any other count, and
+// prepare() picks one for num_channels. the mono and stereo loops have the
+// channel count as a constant, and the stereo one runs a stage on both channels
+// of a frame before the next stage, through process_frame_stereo() if the stage
+// has one, so a gain or coefficient is computed once for both channels
+//
+// example:
+//   ProcessorChain<Gain<float>, Saturator> chain{Gain<float>(0.01f), Saturator()};
+//   chain.get<Gain<float>>().set_block(gain_ramp, gain);
+//   chain.process(buffer, start, length, numChannels);
+//==============================================================================
+namespace processor_chain_detail {
+template <typename T, typename SampleType, typename = void>
+struct has_process_frame : std::false_type {};
+template <typename T, typename SampleType>
+struct has_process_frame<T, SampleType,
+                         std::void_t<decltype(std::declval<T &>().process_frame(
+                             std::declval<SampleType *>(), 0, 0, 0))>> : std::true_type {};
+
+template <typename T, typename SampleType, typename = void>
+struct has_process_frame_stereo : std::false_type {};
+template <typename T, typename SampleType>
+struct has_process_frame_stereo<T, SampleType,
+                                std::void_t<decltype(std::declval<T &>().process_frame_stereo(
+                                    std::declval<SampleType *>(), std::declval<SampleType *>(),
+                                    0, 0))>> : std::true_type {};
+
+template <typename T, typename = void> struct has_prepare : std::false_type {};
+template <typename T>
+struct has_prepare<T, std::void_t<decltype(std::declval<T &>().prepare(0.0, 0, 0))>>
+    : std::true_type {};
+
+template <typename T, typename = void> struct has_begin_block : std::false_type {};
+template <typename T>
+struct has_begin_block<T, std::void_t<decltype(std::declval<T &>().begin_block(0, 0))>>
+    : std::true_type {};
+
+template <typename T, typename = void> struct has_reset : std::false_type {};
+template <typename T>
+struct has_reset<T, std::void_t<decltype(std::declval<T &>().reset())>> : std::true_type {};
+} // namespace processor_chain_detail
+
+template <typename... Stages> class ProcessorChain {
+public:
+  using SampleType = typename std::tuple_element_t<0, std::tuple<Stages...>>::SampleType;
+  // samples per channel processed by every stage before moving on
+  static constexpr int FRAME_SIZE = 64;
+  static constexpr std::size_t NUM_STAGES = sizeof...(Stages);
+
+  ProcessorChain() = default;
+  explicit ProcessorChain(Stages... stages_) : stages(std::move(stages_)...) {}
+
+  template <std::size_t Index> auto &get() { return std::get<Index>(stages); }
+  template <typename Stage> Stage &get() { return std::get<Stage>(stages); }
+
+  // called from prepareToPlay
+  void prepare(double sample_rate, int max_block_size, int num_channels) {
+    for_each_stage([&](auto &stage) {
+      if constexpr (processor_chain_detail::has_prepare<std::decay_t<decltype(stage)>>::value)
+        stage.prepare(sample_rate, max_block_size, num_channels);
+    });
+    // pick the channel loop once here, so processing never branches on the count
+    kernel_channels = num_channels;
+    if (num_channels == 1)
+      channels_kernel = &ProcessorChain::process_fixed_channels<1>;
+    else if (num_channels == 2)
+      channels_kernel = &ProcessorChain::process_fixed_channels<2>;
+    else
+      channels_kernel = &ProcessorChain::process_any_channels;
+  }
+
+  void reset() {
+    for_each_stage([](auto &stage) {
+      if constexpr (processor_chain_detail::has_reset<std::decay_t<decltype(stage)>>::value)
+        stage.reset();
+    });
+  }
+
+  // runs every stage over [startSample, startSample + numSamples) of each channel, in place
+  void process(SampleType *const *buffer, int startSample, int numSamples, int numChannels) {
+    begin_block(numChannels, numSamples);
+    process_channels(buffer, startSample, numSamples, 0, numChannels);
+  }
+
+  void begin_block(int numChannels, int numSamples) {
+    for_each_stage([&](auto &stage) {
+      if constexpr (processor_chain_detail::has_begin_block<std::decay_t<decltype(stage)>>::value)
+        stage.begin_block(numChannels, numSamples);
+    });
+  }
+
+  // the per-channel part of process(), for channels [firstChannel, firstChannel + numChannels).
+  // a range other than the prepared channel count (a group of a wider layout)
+  // takes the loop for any count
+  void process_channels(SampleType *const *buffer, int startSample, int numSamples,
+                        int firstChannel, int numChannels) {
+    const auto kernel =
+        numChannels == kernel_channels ? channels_kernel : &ProcessorChain::process_any_channels;
+    (this->*kernel)(buffer, startSample, numSamples, firstChannel, numChannels);
+  }
+
+private:
+  using ChannelsKernel = void (ProcessorChain::*)(SampleType *const *, int, int, int, int);
+
+  template <typename Fn> void for_each_stage(Fn &&fn) {
+    std::apply([&](auto &...stage) { (fn(stage), ...); }, stages);
+  }
+
+  // one channel at a time, for any number of channels
+  void process_any_channels(SampleType *const *buffer, int startSample, int numSamples,
+                            int firstChannel, int numChannels) {
+    for (int channel = firstChannel; channel < firstChannel + numChannels; ++channel) {
+      SampleType *samples = buffer[channel] + startSample;
+      for (int index = 0; index < numSamples; index += FRAME_SIZE)
+        process_frame(samples + index, channel, index, std::min(FRAME_SIZE, numSamples - index),
+                      std::index_sequence_for<Stages...>{});
+    }
+  }
+
+  // all NumChannels channels frame by frame, numChannels is always NumChannels
+  template <int NumChannels>
+  void process_fixed_channels(SampleType *const *buffer, int startSample, int numSamples,
+                              int firstChannel, int) {
+    SampleType *samples[NumChannels];
+    for (int index = 0; index < numSamples; index += FRAME_SIZE) {
+      for (int c = 0; c < NumChannels; ++c)
+        samples[c] = buffer[firstChannel + c] + startSample + index;
+      process_frames<NumChannels>(samples, firstChannel, index,
+                                  std::min(FRAME_SIZE, numSamples - index),
+                                  std::index_sequence_for<Stages...>{});
+    }
+  }
+
+  template <std::size_t... Indices>
+  void process_frame(SampleType *frame, int channel, int index, int length,
+                     std::index_sequence<Indices...>) {
+    (run_stage(std::get<Indices>(stages), frame, channel, index, length), ...);
+  }
+
+  // frames holds the frame of each channel
+  template <int NumChannels, std::size_t... Indices>
+  void process_frames(SampleType *const *frames, int firstChannel, int index, int length,
+                      std::index_sequence<Indices...>) {
+    (run_stage_on_frames<NumChannels>(std::get<Indices>(stages), frames, firstChannel, index,
+                                      length),
+     ...);
+  }
+
+  template <int NumChannels, typename Stage>
+  static void run_stage_on_frames(Stage &stage, SampleType *const *frames, int firstChannel,
+                                  int index, int length) {
+    if constexpr (NumChannels == 2 &&
+                  processor_chain_detail::has_process_frame_stereo<Stage, SampleType>::value) {
+      stage.process_frame_stereo(frames[0], frames[1], index, length);
+    } else {
+      for (int c = 0; c < NumChannels; ++c)
+        run_stage(stage, frames[c], firstChannel + c, index, length);
+    }
+  }
+
+  template <typename Stage>
+  static void run_stage(Stage &stage, SampleType *frame, int channel, int index, int length) {
+    if constexpr (processor_chain_detail::has_process_frame<Stage, SampleType>::value) {
+      stage.process_frame(frame, channel, index, length);
+    } else {
+      for (int i = 0; i < length; ++i)
+        frame[i] = stage.process_sample(frame[i], channel, index + i);
+    }
+  }
+
+  std::tuple<Stages...> stages;
+  ChannelsKernel channels_kernel{&ProcessorChain::process_any_channels};
+  int kernel_channels{0};
+};
@@ -0,0 +1,149 @@
+#include "SilenceKernels.h"
+
+#include <cmath>
+
+namespace silence_kernels {
+namespace {
+//==============================================================================
+// scalar
+//==============================================================================
+template <typename SampleType>
+bool is_silent_scalar(const SampleType *samples, SampleType threshold, int numSamples) {
+  for (int i = 0; i < numSamples; ++i)
+    if (std::abs(samples[i]) > threshold)
+      return false;
+  return true;
+}
+
+#if NTHN_X86
+//==============================================================================
+// SSE2, 16 floats or 8 doubles per check. the magnitude is the sample with its
+// sign bit cleared
+//==============================================================================
+NTHN_TARGET("sse2")
+bool is_silent_sse2(const float *samples, float threshold, int numSamples) {
+  const __m128 sign = _mm_set1_ps(-0.0f);
+  const __m128 t = _mm_set1_ps(threshold);
+  int i = 0;
+  for (; i + 16 <= numSamples; i += 16) {
+    const __m128 a = _mm_cmpgt_ps(_mm_andnot_ps(sign, _mm_loadu_ps(samples + i)), t);
+    const __m128 b = _mm_cmpgt_ps(_mm_andnot_ps(sign, _mm_loadu_ps(samples + i + 4)), t);
+    const __m128 c = _mm_cmpgt_ps(_mm_andnot_ps(sign, _mm_loadu_ps(samples + i + 8)), t);
+    const __m128 d = _mm_cmpgt_ps(_mm_andnot_ps(sign, _mm_loadu_ps(samples + i + 12)), t);
+    if (_mm_movemask_ps(_mm_or_ps(_mm_or_ps(a, b), _mm_or_ps(c, d))) != 0)
+      return false;
+  }
+  return is_silent_scalar(samples + i, threshold, numSamples - i);
+}
+
+NTHN_TARGET("sse2")
+bool is_silent_double_sse2(const double *samples, double threshold, int numSamples) {
+  const __m128d sign = _mm_set1_pd(-0.0);
+  const __m128d t = _mm_set1_pd(threshold);
+  int i = 0;
+  for (; i + 8 <= numSamples; i += 8) {
+    const __m128d a = _mm_cmpgt_pd(_mm_andnot_pd(sign, _mm_loadu_pd(samples + i)), t);
+    const __m128d b = _mm_cmpgt_pd(_mm_andnot_pd(sign, _mm_loadu_pd(samples + i + 2)), t);
+    const __m128d c = _mm_cmpgt_pd(_mm_andnot_pd(sign, _mm_loadu_pd(samples + i + 4)), t);
+    const __m128d d = _mm_cmpgt_pd(_mm_andnot_pd(sign, _mm_loadu_pd(samples + i + 6)), t);
+    if (_mm_movemask_pd(_mm_or_pd(_mm_or_pd(a, b), _mm_or_pd(c, d))) != 0)
+      return false;
+  }
+  return is_silent_scalar(samples + i, threshold, numSamples - i);
+}
+
+//==============================================================================
+// AVX2, 32 floats or 16 doubles per check
+//==============================================================================
+NTHN_TARGET("avx2")
+bool is_silent_avx2(const float *samples, float threshold, int numSamples) {
+  const __m256 sign = _mm256_set1_ps(-0.0f);
+  const __m256 t = _mm256_set1_ps(threshold);
+  int i = 0;
+  for (; i + 32 <= numSamples; i += 32) {
+    __m256 above = _mm256_setzero_ps();
+    for (int k = 0; k < 32; k += 8)
+      above = _mm256_or_ps(
+          above, _mm256_cmp_ps(_mm256_andnot_ps(sign, _mm256_loadu_ps(samples + i + k)), t,
+                               _CMP_GT_OQ));
+    if (_mm256_movemask_ps(above) != 0)
+      return false;
+  }
+  return is_silent_scalar(samples + i, threshold, numSamples - i);
+}
+
+NTHN_TARGET("avx2")
+bool is_silent_double_avx2(const double *samples, double threshold, int numSamples) {
+  const __m256d sign = _mm256_set1_pd(-0.0);
+  const __m256d t = _mm256_set1_pd(threshold);
+  int i = 0;
+  for (; i + 16 <= numSamples; i += 16) {
+    __m256d above = _mm256_setzero_pd();
+    for (int k = 0; k < 16; k += 4)
+      above = _mm256_or_pd(
+          above, _mm256_cmp_pd(_mm256_andnot_pd(sign, _mm256_loadu_pd(samples + i + k)), t,
+                               _CMP_GT_OQ));
+    if (_mm256_movemask_pd(above) != 0)
+      return false;
+  }
+  return is_silent_scalar(samples + i, threshold, numSamples - i);
+}
+
+//==============================================================================
+// AVX-512, 64 floats or 32 doubles per check, compares straight into a mask
+//==============================================================================
+NTHN_TARGET("avx512f")
+bool is_silent_avx512(const float *samples, float threshold, int numSamples) {
+  const __m512 t = _mm512_set1_ps(threshold);
+  int i = 0;
+  for (; i + 64 <= numSamples; i += 64) {
+    __mmask16 above = 0;
+    for (int k = 0; k < 64; k += 16)
+      above |= _mm512_cmp_ps_mask(_mm512_abs_ps(_mm512_loadu_ps(samples + i + k)), t, _CMP_GT_OQ);
+    if (above != 0)
+      return false;
+  }
+  return is_silent_scalar(samples + i, threshold, numSamples - i);
+}
+
+NTHN_TARGET("avx512f")
+bool is_silent_double_avx512(const double *samples, double threshold, int numSamples) {
+  const __m512d t = _mm512_set1_pd(threshold);
+  int i = 0;
+  for (; i + 32 <= numSamples; i += 32) {
+    __mmask8 above = 0;
+    for (int k = 0; k < 32; k += 8)
+      above |= _mm512_cmp_pd_mask(_mm512_abs_pd(_mm512_loadu_pd(samples + i + k)), t, _CMP_GT_OQ);
+    if (above != 0)
+      return false;
+  }
+  return is_silent_scalar(samples + i, threshold, numSamples - i);
+}
+#endif
+
+// every compiled in path, indexed by SimdLevel
+template <typename SampleType> struct KernelTable;
+template <> struct KernelTable<float> {
+  static constexpr Kernels<float> paths[] = {
+      {is_silent_scalar<float>, nthn_utils::SimdLevel::Scalar},
+#if NTHN_X86
+      {is_silent_sse2, nthn_utils::SimdLevel::SSE2},
+      {is_silent_avx2, nthn_utils::SimdLevel::AVX2},
+      {is_silent_avx512, nthn_utils::SimdLevel::AVX512},
+#endif
+  };
+};
+template <> struct KernelTable<double> {
+  static constexpr Kernels<double> paths[] = {
+      {is_silent_scalar<double>, nthn_utils::SimdLevel::Scalar},
+#if NTHN_X86
+      {is_silent_double_sse2, nthn_utils::SimdLevel::SSE2},
+      {is_silent_double_avx2, nthn_utils::SimdLevel::AVX2},
+      {is_silent_double_avx512, nthn_utils::SimdLevel::AVX512},
+#endif
+  };
+};
+} // namespace
+
+NTHN_DEFINE_KERNEL_SET(KernelTable)
+} // namespace silence_kernels
@@ -0,0 +1,24 @@
+#pragma once
+
+#include "../Util/CpuFeatures.h"
+
+//==============================================================================
+// Silence detection, one set per instruction set and sample type
+// a block is silent when no sample's magnitude is above the threshold. the simd
+// paths compare a few registers at a time and return as soon as one sample is
+// above, so a block with signal usually costs a handful of compares
+//==============================================================================
+namespace silence_kernels {
+template <typename SampleType> struct Kernels {
+  // true if |samples[i]| <= threshold for every i in [0, numSamples)
+  bool (*is_silent)(const SampleType *samples, SampleType threshold, int numSamples);
+  nthn_utils::SimdLevel level;
+};
+
+// plain c++ reference path
+template <typename SampleType> const Kernels<SampleType> &scalar();
+// kernels for a specific instruction set, falls back to scalar when not compiled in
+template <typename SampleType> const Kernels<SampleType> &for_level(nthn_utils::SimdLevel level);
+// the fastest kernels this cpu supports, detected once
+template <typename SampleType> const Kernels<SampleType> &best();
+} // namespace silence_kernels
@@ -0,0 +1,186 @@
+#include "LevelMeterDisplay.h"
+#include "../audio/AudioMeter.h"
+
+namespace {
+// with no frames for this long, the host has stopped processing, and the
+// meters fall as if the output were silent
+constexpr double STALL_SECONDS = 0.25;
+// width of one channel's bar, in pixels
+constexpr int CHANNEL_WIDTH = 14;
+} // namespace
+
+LevelMeterDisplay::LevelMeterDisplay(AudioMeter &meter_) : meter(meter_) {
+  addAndMakeVisible(waveform);
+  meter.set_enabled(true);
+}
+
+LevelMeterDisplay::~LevelMeterDisplay() { meter.set_enabled(false); }
+
+void LevelMeterDisplay::paint(juce::Graphics &g) {
+  g.fillAll(findColour(ColourIds::backgroundColourId, true));
+}
+
+void LevelMeterDisplay::resized() {
+  auto area = getLocalBounds();
+  auto bars = area.removeFromRight(
+      std::min(area.getWidth() / 3, CHANNEL_WIDTH * int(channel_meters.size())));
+  const int width = channel_meters.empty() ? 0 : bars.getWidth() / int(channel_meters.size());
+  for (auto &channel_meter : channel_meters)
+    channel_meter->setBounds(bars.removeFromLeft(width).reduced(1, 0));
+  waveform.setBounds(area.withTrimmedRight(4));
+}
+
+// called from the message thread
+void LevelMeterDisplay::update() {
+  const double now_ms = juce::Time::getMillisecondCounterHiRes();
+  const double elapsed = last_update_ms > 0.0 ? 0.001 * (now_ms - last_update_ms) : 0.0;
+  last_update_ms = now_ms;
+
+  const double sample_rate = meter.get_sample_rate();
+  bool any_frames = false;
+  meter.for_each_frame([&](const AudioMeter::Frame &frame) {
+    any_frames = true;
+    if (frame.num_channels != int(channel_meters.size()))
+      set_num_channels(frame.num_channels);
+    if (frame.num_channels == 0)
+      return;
+    const double seconds = double(frame.num_samples) / sample_rate;
+    float min = frame.min[0];
+    float max = frame.max[0];
+    for (size_t ch = 0; ch < size_t(frame.num_channels); ++ch) {
+      advance(channel_levels[ch], seconds, double(frame.mean_square[ch]),
+              std::max(-frame.min[ch], frame.max[ch]));
+      min = std::min(min, frame.min[ch]);
+      max = std::max(max, frame.max[ch]);
+    }
+    waveform.push(min, max);
+  });
+
+  if (any_frames) {
+    seconds_without_frames = 0.0;
+  } else {
+    seconds_without_frames += elapsed;
+    if (seconds_without_frames > STALL_SECONDS)
+      for (auto &levels : channel_levels)
+        advance(levels, elapsed, 0.0, 0.0f);
+  }
+
+  // only the components whose pixels moved are repainted
+  for (size_t ch = 0; ch < channel_meters.size(); ++ch) {
+    const auto &levels = channel_levels[ch];
+    const float rms_db =
+        juce::Decibels::gainToDecibels(float(std::sqrt(levels.mean_square)), MIN_DB);
+    channel_meters[ch]->set_levels(rms_db, held_peak_db(levels));
+  }
+  waveform.repaint_if_changed();
+}
+
+void LevelMeterDisplay::set_num_channels(int num_channels) {
+  channel_levels.assign(size_t(num_channels), {});
+  channel_meters.clear();
+  for (int ch = 0; ch < num_channels; ++ch) {
+    channel_meters.push_back(std::make_unique<ChannelMeter>());
+    addAndMakeVisible(*channel_meters.back());
+  }
+  resized();
+  repaint();
+}
+
+// moves a channel's ballistics on by seconds of audio with the given level
+void LevelMeterDisplay::advance(ChannelLevels &levels, double seconds, double mean_square,
+                                float peak) {
+  const double alpha = 1.0 - std::exp(-seconds / RMS_SECONDS);
+  levels.mean_square += alpha * (mean_square - levels.mean_square);
+  levels.peak_age += seconds;
+  const float peak_db = juce::Decibels::gainToDecibels(peak, MIN_DB);
+  if (peak_db >= held_peak_db(levels)) {
+    levels.peak_db = peak_db;
+    levels.peak_age = 0.0;
+  }
+}
+
+float LevelMeterDisplay::held_peak_db(const ChannelLevels &levels) {
+  const double falling = std::max(0.0, levels.peak_age - PEAK_HOLD_SECONDS);
+  return std::max(MIN_DB, levels.peak_db - float(falling) * PEAK_DECAY_DB_PER_SECOND);
+}
+
+//==============================================================================
+void LevelMeterDisplay::ChannelMeter::paint(juce::Graphics &g) {
+  g.fillAll(findColour(ColourIds::backgroundColourId, true));
+  const int rms_y = db_to_y(rms_db);
+  const int peak_y = db_to_y(peak_db);
+  g.setColour(juce::Colour(0xff000000).withAlpha(0.6f));
+  g.fillRect(0, rms_y, getWidth(), getHeight() - rms_y);
+  g.setColour(juce::Colour(0xff000000));
+  g.fillRect(0, std::min(peak_y, getHeight() - 2), getWidth(), 2);
+}
+
+void LevelMeterDisplay::ChannelMeter::set_levels(float rms_db_, float peak_db_) {
+  rms_db = rms_db_;
+  peak_db = peak_db_;
+  const int rms_y = db_to_y(rms_db);
+  const int peak_y = db_to_y(peak_db);
+  if (std::abs(rms_y - drawn_rms_y) >= PIXEL_THRESHOLD ||
+      std::abs(peak_y - drawn_peak_y) >= PIXEL_THRESHOLD) {
+    drawn_rms_y = rms_y;
+    drawn_peak_y = peak_y;
+    repaint();
+  }
+}
+
+int LevelMeterDisplay::ChannelMeter::db_to_y(float db) const {
+  const float proportion = juce::jlimit(0.0f, 1.0f, (db - MIN_DB) / (MAX_DB - MIN_DB));
+  return juce::roundToInt(float(getHeight()) * (1.0f - proportion));
+}
+
+//==============================================================================
+void LevelMeterDisplay::WaveformView::paint(juce::Graphics &g) {
+  g.fillAll(findColour(ColourIds::backgroundColourId, true));
+  g.setColour(juce::Colour(0xff000000));
+  const float column_width = float(getWidth()) / float(WAVEFORM_POINTS);
+  // oldest first, from the left
+  for (int i = 0; i < WAVEFORM_POINTS; ++i) {
+    const auto point = size_t((newest + 1 + i) % WAVEFORM_POINTS);
+    const auto [top, bottom] = to_pixels(mins[point], maxes[point]);
+    g.fillRect(juce::Rectangle<float>(float(i) * column_width, float(top), column_width,
+                                      float(bottom - top + 1)));
+  }
+}
+
+void LevelMeterDisplay::WaveformView::resized() {
+  // the pixels of every point have moved
+  newest_pixels = to_pixels(mins[size_t(newest)], maxes[size_t(newest)]);
+  identical_points = 0;
+}
+
+void LevelMeterDisplay::WaveformView::push(float min, float max) {
+  newest = (newest + 1) % WAVEFORM_POINTS;
+  mins[size_t(newest)] = min;
+  maxes[size_t(newest)] = max;
+
+  const auto pixels = to_pixels(min, max);
+  if (pixels == newest_pixels) {
+    identical_points = std::min(identical_points + 1, WAVEFORM_POINTS + 1);
+  } else {
+    newest_pixels = pixels;
+    identical_points = 1;
+  }
+  // the scroll only leaves the picture as it was if every point on screen
+  // before it, and the new one, look the same
+  if (identical_points <= WAVEFORM_POINTS)
+    changed = true;
+}
+
+void LevelMeterDisplay::WaveformView::repaint_if_changed() {
+  if (changed) {
+    changed = false;
+    repaint();
+  }
+}
+
+// the rows of the top and bottom of a point, with full scale filling the height
+std::pair<int, int> LevelMeterDisplay::WaveformView::to_pixels(float min, float max) const {
+  const float half_height = 0.5f * float(getHeight());
+  return {juce::roundToInt(half_height * (1.0f - juce::jlimit(-1.0f, 1.0f, max))),
+          juce::roundToInt(half_height * (1.0f - juce::jlimit(-1.0f, 1.0f, min)))};
+}
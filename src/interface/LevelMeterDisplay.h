@@ -0,0 +1,107 @@
+#pragma once
+
+class AudioMeter;
+
+#include <array>
+
+#include <juce_gui_basics/juce_gui_basics.h>
+
+//==============================================================================
+// shows the output of the plugin: a peak and rms bar per channel, and a
+// scrolling min/max outline of the waveform. the audio meter is enabled while
+// this component exists. call update() from the editor's vblank callback.
+//
+// update() drains the audio meter and works out where each bar and line would
+// be drawn, in whole pixels. each channel and the waveform are their own
+// component, and only the ones whose pixels moved are repainted, so steady or
+// silent audio repaints nothing
+//==============================================================================
+class LevelMeterDisplay : public juce::Component {
+public:
+  explicit LevelMeterDisplay(AudioMeter &meter_);
+  ~LevelMeterDisplay() override;
+  void paint(juce::Graphics &g) override;
+  void resized() override;
+  void update();
+
+  // the range of the bars, in decibels
+  static constexpr float MIN_DB = -60.0f;
+  static constexpr float MAX_DB = 6.0f;
+  // the peak falls at this rate after PEAK_HOLD_SECONDS
+  static constexpr float PEAK_DECAY_DB_PER_SECOND = 20.0f;
+  static constexpr double PEAK_HOLD_SECONDS = 1.5;
+  // time constant of the rms average
+  static constexpr double RMS_SECONDS = 0.3;
+  // waveform points kept, one per AudioMeter frame
+  static constexpr int WAVEFORM_POINTS = 512;
+  // a meter is repainted once its bar or line has moved this many pixels
+  static constexpr int PIXEL_THRESHOLD = 1;
+
+  // the background of the display and its meters is inherited from the editor,
+  // which sets backgroundColourId
+  enum ColourIds { backgroundColourId };
+
+private:
+  //--------------------------------------------------------------------------------
+  // one channel: the rms as a bar and the held peak as a line
+  //--------------------------------------------------------------------------------
+  class ChannelMeter : public juce::Component {
+  public:
+    ChannelMeter() { setOpaque(true); }
+    void paint(juce::Graphics &g) override;
+    // sets the levels in decibels, and repaints if the bar or line moved a pixel
+    void set_levels(float rms_db_, float peak_db_);
+
+  private:
+    int db_to_y(float db) const;
+    float rms_db{MIN_DB};
+    float peak_db{MIN_DB};
+    // where the bar and the line were last drawn
+    int drawn_rms_y{-1};
+    int drawn_peak_y{-1};
+  };
+
+  //--------------------------------------------------------------------------------
+  // the largest and smallest sample of every frame, over all channels, newest
+  // on the right
+  //--------------------------------------------------------------------------------
+  class WaveformView : public juce::Component {
+  public:
+    WaveformView() { setOpaque(true); }
+    void paint(juce::Graphics &g) override;
+    void resized() override;
+    // adds a point, scrolling the rest left
+    void push(float min, float max);
+    // repaints if anything pushed since the last call moved a pixel
+    void repaint_if_changed();
+
+  private:
+    std::pair<int, int> to_pixels(float min, float max) const;
+    std::array<float, WAVEFORM_POINTS> mins{};
+    std::array<float, WAVEFORM_POINTS> maxes{};
+    int newest{WAVEFORM_POINTS - 1};
+    // the picture only stays the same while a scroll brings in points that look
+    // the same as every point on screen. identical_points counts the newest
+    // points that look the same as the newest one
+    std::pair<int, int> newest_pixels{0, 0};
+    int identical_points{0};
+    bool changed{true};
+  };
+
+  struct ChannelLevels {
+    double mean_square{0.0}; // the rms average, squared
+    float peak_db{MIN_DB};
+    double peak_age{0.0}; // seconds since the peak was set
+  };
+  void set_num_channels(int num_channels);
+  static void advance(ChannelLevels &levels, double seconds, double mean_square, float peak);
+  // the peak after its hold time and fall
+  static float held_peak_db(const ChannelLevels &levels);
+
+  AudioMeter &meter;
+  std::vector<std::unique_ptr<ChannelMeter>> channel_meters;
+  std::vector<ChannelLevels> channel_levels;
+  WaveformView waveform;
+  double last_update_ms{0.0};
+  double seconds_without_frames{0.0};
+};
@@ -0,0 +1,59 @@
+#include "LoadMeterDisplay.h"
+#include "../audio/DspLoadMeter.h"
+
+LoadMeterDisplay::LoadMeterDisplay(DspLoadMeter &meter_) : meter(meter_) {
+  setOpaque(true);
+  export_button.setTooltip("Save the timing of the last blocks as a CSV file");
+  export_button.onClick = [this] { export_csv(); };
+  addAndMakeVisible(export_button);
+  meter.set_enabled(true);
+}
+
+LoadMeterDisplay::~LoadMeterDisplay() { meter.set_enabled(false); }
+
+void LoadMeterDisplay::paint(juce::Graphics &g) {
+  g.fillAll(findColour(ColourIds::backgroundColourId, true));
+  g.setColour(juce::Colour(0xff000000));
+  auto text_area = getLocalBounds().withTrimmedRight(export_button.getWidth());
+  g.drawText(load_text, text_area.removeFromTop(getHeight() / 2), juce::Justification::centredLeft,
+             true);
+  g.setFont(g.getCurrentFont().withHeight(float(getHeight()) * 0.3f));
+  g.drawText(stage_text, text_area, juce::Justification::centredLeft, true);
+}
+
+void LoadMeterDisplay::resized() { export_button.setBounds(getLocalBounds().removeFromRight(90)); }
+
+// called from the message thread
+void LoadMeterDisplay::update() {
+  meter.update();
+  if (++frames_since_text_update < FRAMES_PER_TEXT_UPDATE)
+    return;
+  frames_since_text_update = 0;
+
+  load_text = "DSP " + juce::String(100.0f * meter.get_load(), 1) + "% (peak " +
+              juce::String(100.0f * meter.get_peak_load(), 1) + "%)";
+  stage_text.clear();
+  for (int s = 0; s < DspLoadMeter::NUM_STAGES; ++s) {
+    const auto stage = DspLoadMeter::Stage(s);
+    stage_text << DspLoadMeter::STAGE_NAMES[size_t(s)] << " "
+               << juce::String(100.0f * meter.get_stage_load(stage), 2) << "%  ";
+  }
+  // share of the audio that skipped the dsp (silent input, tails decayed)
+  stage_text << "skipped " << juce::String(100.0f * meter.get_skip_ratio(), 1) << "%";
+  repaint();
+}
+
+void LoadMeterDisplay::export_csv() {
+  file_chooser = std::make_unique<juce::FileChooser>(
+      "Export DSP timing",
+      juce::File::getSpecialLocation(juce::File::userDocumentsDirectory).getChildFile("dsp_timing.csv"),
+      "*.csv");
+  file_chooser->launchAsync(juce::FileBrowserComponent::saveMode |
+                                juce::FileBrowserComponent::canSelectFiles |
+                                juce::FileBrowserComponent::warnAboutOverwriting,
+                            [this](const juce::FileChooser &chooser) {
+                              const auto file = chooser.getResult();
+                              if (file != juce::File())
+                                meter.export_csv(file);
+                            });
+}
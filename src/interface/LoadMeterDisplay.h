@@ -0,0 +1,35 @@
+#pragma once
+
+class DspLoadMeter;
+
+#include <juce_gui_basics/juce_gui_basics.h>
+
+//==============================================================================
+// shows the DSP load of the plugin, and exports the timing history as CSV
+// the meter is enabled while this component exists
+// call update() from the editor's vblank callback
+//==============================================================================
+class LoadMeterDisplay : public juce::Component {
+public:
+  explicit LoadMeterDisplay(DspLoadMeter &meter_);
+  ~LoadMeterDisplay() override;
+  void paint(juce::Graphics &g) override;
+  void resized() override;
+  void update();
+
+  // the background is inherited from the editor, which sets backgroundColourId
+  enum ColourIds { backgroundColourId };
+
+private:
+  void export_csv();
+
+  DspLoadMeter &meter;
+  juce::String load_text;
+  juce::String stage_text;
+  int frames_since_text_update{0};
+  // the readout changes at most this often, so it stays readable
+  static constexpr int FRAMES_PER_TEXT_UPDATE = 15;
+
+  juce::TextButton export_button{"Export CSV"};
+  std::unique_ptr<juce::FileChooser> file_chooser;
+};
@@ -1,10 +1,17 @@
 #include "ParameterSlider.h"
 #include "../parameters/StateManager.h"
 
+namespace {
+const float ROTARY_START_ANGLE = -3.0f * juce::MathConstants<float>::pi / 4.0f;
+const float ROTARY_END_ANGLE = 3.0f * juce::MathConstants<float>::pi / 4.0f;
+} // namespace
+
 ParameterSlider::ParameterSlider(StateManager *s, size_t p_id)
     : juce::SettableTooltipClient(), juce::Component(), state(s) {
   update_param_id(p_id);
   setOpaque(true);
+  // everything is drawn inside the bounds, so juce can skip clipping to them
+  setPaintingIsUnclipped(true);
   setColour(ColourIds::sliderColourId,
             juce::Colour(0xff000000)); // to change the colour of the slider, set colour id 1
 
@@ -14,32 +21,66 @@ ParameterSlider::ParameterSlider(StateManager *s, size_t p_id)
 ParameterSlider::~ParameterSlider() { state->unregister_component(param_id, this); }
 
 void ParameterSlider::paint(juce::Graphics &g) {
-  // paint background
-  g.fillAll(findColour(ColourIds::backgroundColourId, true));
+  // the parts that don't move, redrawn only when the size, scale or colours change
+  const float scale = g.getInternalContext().getPhysicalPixelScaleFactor();
+  if (!static_layer.isValid() || scale != static_layer_scale)
+    render_static_layer(scale);
+  g.drawImageTransformed(static_layer, juce::AffineTransform::scale(1.0f / static_layer_scale));
 
   // keep up to date with the parameter via polling
   auto normed_val = get_current_knob_position();
   jassert(normed_val >= 0 && normed_val <= 1.0f);
+  draw_pointer(g, normed_val);
+
+  // the value text, formatted again only when the value has changed, and laid
+  // out again only when that gives a different string
+  const float value = state->param_value(param_id);
+  if (!text_valid || value != text_value) {
+    text_value = value;
+    text_valid = true;
+    auto text = state->get_parameter_text(param_id);
+    if (!glyphs_valid || text != value_text) {
+      value_text = std::move(text);
+      glyphs_valid = false;
+    }
+  }
+  if (!glyphs_valid) {
+    // the same layout as g.drawText()
+    const auto area = juce::Rectangle<int>(0, proportionOfHeight(0.75f), getWidth(),
+                                           proportionOfHeight(0.25f))
+                          .toFloat();
+    value_glyphs.clear();
+    value_glyphs.addCurtailedLineOfText(g.getCurrentFont(), value_text, 0.0f, 0.0f,
+                                        area.getWidth(), true);
+    value_glyphs.justifyGlyphs(0, value_glyphs.getNumGlyphs(), area.getX(), area.getY(),
+                               area.getWidth(), area.getHeight(), juce::Justification::centred);
+    glyphs_valid = true;
+  }
+  g.setColour(juce::Colour(0xff000000));
+  value_glyphs.draw(g);
+}
 
-  draw_rotary_slider(g, normed_val);
+void ParameterSlider::resized() {
+  invalidate_static_layer();
+  glyphs_valid = false;
+}
 
-  // draw text
-  g.setColour(juce::Colour(0xff000000));
-  auto param_name = PARAMETER_NICKNAMES[param_id];
-  auto text = state->get_parameter_text(param_id);
-  g.drawText(param_name, 0, 0, getWidth(), proportionOfHeight(0.25f), juce::Justification::centred,
-             true);
-  g.drawText(text, 0, proportionOfHeight(0.75f), getWidth(), proportionOfHeight(0.25f),
-             juce::Justification::centred, true);
+void ParameterSlider::colourChanged() { invalidate_static_layer(); }
 
-  // draw bounding box
-  g.drawRect(getLocalBounds());
+void ParameterSlider::lookAndFeelChanged() {
+  invalidate_static_layer();
+  glyphs_valid = false;
 }
 
+// the background colour can come from a parent
+void ParameterSlider::parentHierarchyChanged() { invalidate_static_layer(); }
+
 void ParameterSlider::update_param_id(size_t p_id) {
   param_id = p_id;
-  setTooltip(PARAMETER_TOOLTIPS[param_id]);
-  setName(PARAMETER_NICKNAMES[param_id]);
+  setTooltip(parameter_objects::tooltip(param_id));
+  setName(parameter_objects::nickname(param_id));
+  invalidate_static_layer();
+  text_valid = false;
 }
 
 void ParameterSlider::update_slider_sensitivity(float pixels_per_percent_) {
@@ -79,30 +120,53 @@ void ParameterSlider::mouseUp(const juce::MouseEvent &e) {
   juce::ignoreUnused(e);
 }
 
-void ParameterSlider::draw_rotary_slider(juce::Graphics &g, float slider_pos, float x, float y,
-                                         float w, float h) {
-  // draw the rotary slider
-  const float width = w * getWidth();
-  const float height = h * getHeight();
-  const float x_ = x * getWidth();
-  const float y_ = y * getWidth();
-  const float rotaryStartAngle = -3.0f * juce::MathConstants<float>::pi / 4.0f;
-  const float rotaryEndAngle = 3.0f * juce::MathConstants<float>::pi / 4.0f;
-  ;
-  const float radius = std::min(width / 2, height / 2) - 2.0f;
-  const float centreX = x_ + width * 0.5f;
-  const float centreY = y_ + height * 0.5f;
-  const float rw = radius * 2.0f;
-  const float angle = rotaryStartAngle + slider_pos * (rotaryEndAngle - rotaryStartAngle);
+ParameterSlider::KnobGeometry ParameterSlider::get_knob_geometry(float x, float y, float w,
+                                                                 float h) const {
+  const float width = w * float(getWidth());
+  const float height = h * float(getHeight());
+  const float x_ = x * float(getWidth());
+  const float y_ = y * float(getWidth());
+  return {x_ + width * 0.5f, y_ + height * 0.5f, std::min(width / 2, height / 2) - 2.0f};
+}
+
+void ParameterSlider::render_static_layer(float scale) {
+  static_layer_scale = scale;
+  static_layer = juce::Image(juce::Image::RGB,
+                             std::max(1, juce::roundToInt(float(getWidth()) * scale)),
+                             std::max(1, juce::roundToInt(float(getHeight()) * scale)), false);
+  juce::Graphics g(static_layer);
+  g.addTransform(juce::AffineTransform::scale(scale));
+
+  // paint background
+  g.fillAll(findColour(ColourIds::backgroundColourId, true));
 
+  // the ring of the rotary slider
+  const auto knob = get_knob_geometry();
+  const float rw = knob.radius * 2.0f;
   juce::Path p;
   p.addEllipse(-0.5f * rw, -0.5f * rw, rw, rw);
   juce::PathStrokeType(rw * 0.05f).createStrokedPath(p, p);
-  p.addLineSegment(juce::Line<float>(0.0f, 0.0f, 0.0f, -radius), rw * 0.05f);
   g.setColour(findColour(ColourIds::sliderColourId));
-  g.fillPath(p, juce::AffineTransform::rotation(angle).translated(centreX, centreY));
+  g.fillPath(p, juce::AffineTransform::translation(knob.centre_x, knob.centre_y));
+
+  // draw the name
+  g.setColour(juce::Colour(0xff000000));
+  g.drawText(parameter_objects::nickname(param_id), 0, 0, getWidth(),
+             proportionOfHeight(0.25f), juce::Justification::centred, true);
+
+  // draw bounding box
+  g.drawRect(getLocalBounds());
+}
+
+void ParameterSlider::draw_pointer(juce::Graphics &g, float normed_value) const {
+  // a line from the centre to the ring
+  const auto knob = get_knob_geometry();
+  const float angle = ROTARY_START_ANGLE + normed_value * (ROTARY_END_ANGLE - ROTARY_START_ANGLE);
+  g.setColour(findColour(ColourIds::sliderColourId));
+  g.drawLine(knob.centre_x, knob.centre_y, knob.centre_x + knob.radius * std::sin(angle),
+             knob.centre_y - knob.radius * std::cos(angle), knob.radius * 2.0f * 0.05f);
 }
 
 float ParameterSlider::get_current_knob_position() {
-  return PARAMETER_RANGES[param_id].convertTo0to1(state->param_value(param_id));
-}
\ No newline at end of file
+  return parameter_objects::range(param_id).convertTo0to1(state->param_value(param_id));
+}
@@ -4,11 +4,23 @@ class StateManager;
 
 #include <juce_gui_basics/juce_gui_basics.h>
 
+//==============================================================================
+// a rotary knob for one parameter
+// the parts that don't move (background, ring, name and bounding box) are drawn
+// once into an image at the screen's pixel scale, and redrawn only after a
+// resize, a scale change or a colour change. each paint() then blits the image
+// and draws the pointer and the value text. the value text is only formatted
+// again when the value changes, and only laid out again when the string does
+//==============================================================================
 class ParameterSlider : public juce::SettableTooltipClient, public juce::Component {
 public:
   ParameterSlider(StateManager *s, size_t p_id);
   ~ParameterSlider() override;
   void paint(juce::Graphics &g) override;
+  void resized() override;
+  void colourChanged() override;
+  void lookAndFeelChanged() override;
+  void parentHierarchyChanged() override;
   void update_param_id(size_t p_id);
   void update_slider_sensitivity(float pixels_per_percent_);
 
@@ -24,10 +36,30 @@ protected:
   StateManager *state;
 
 private:
-  void draw_rotary_slider(juce::Graphics &g, float normed_value, float x = 0.25f, float y = 0.25f,
-                          float w = 0.5f, float h = 0.5f);
+  // the circle the knob is drawn in, in component coordinates
+  struct KnobGeometry {
+    float centre_x;
+    float centre_y;
+    float radius;
+  };
+  KnobGeometry get_knob_geometry(float x = 0.25f, float y = 0.25f, float w = 0.5f,
+                                 float h = 0.5f) const;
+  void render_static_layer(float scale);
+  void draw_pointer(juce::Graphics &g, float normed_value) const;
   float get_current_knob_position(); // 0 to 1
+  // drops the cached image, so the next paint() draws it again
+  void invalidate_static_layer() { static_layer = juce::Image(); }
 
   float pixels_per_percent{100.0f};
   juce::Point<int> last_mouse_position;
-};
\ No newline at end of file
+
+  // background, ring, name and box, at static_layer_scale physical pixels per point
+  juce::Image static_layer;
+  float static_layer_scale{0.0f};
+  // the value the text was last formatted for, the text, and its layout
+  float text_value{0.0f};
+  bool text_valid{false};
+  juce::String value_text;
+  juce::GlyphArrangement value_glyphs;
+  bool glyphs_valid{false};
+};
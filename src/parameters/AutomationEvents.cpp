@@ -0,0 +1,128 @@
+#include "AutomationEvents.h"
+#include "StateManager.h"
+
+//==============================================================================
+// called from any thread
+bool AutomationEventQueue::push(const AutomationEvent &event) {
+  if (events.push(event))
+    return true;
+  // queue is full
+  overflowed.store(true);
+  return false;
+}
+
+// called from the audio thread
+bool AutomationEventQueue::pop(AutomationEvent &event) { return events.pop(event); }
+
+//==============================================================================
+// called from the message thread
+bool AutomationCommandQueue::push(const AutomationEvent &event) {
+  if (events.push(event))
+    return true;
+  // queue is full
+  overflowed.store(true);
+  return false;
+}
+
+// called from the audio thread
+bool AutomationCommandQueue::pop(AutomationEvent &event) { return events.pop(event); }
+
+//==============================================================================
+void BlockAutomation::prepare(double sample_rate, int min_sub_block_size_,
+                              int max_sub_block_size_) {
+  samples_per_tick = sample_rate / double(juce::Time::getHighResolutionTicksPerSecond());
+  max_sub_block_size = std::max(1, max_sub_block_size_);
+  set_min_sub_block_size(min_sub_block_size_);
+  num_events = 0;
+  last_block_ticks = 0;
+}
+
+void BlockAutomation::set_min_sub_block_size(int min_sub_block_size_) {
+  min_sub_block_size = juce::jlimit(1, max_sub_block_size, min_sub_block_size_);
+}
+
+// called from the audio thread
+void BlockAutomation::begin_block(StateManager &state, int numSamples) {
+  const auto block_ticks = juce::Time::getHighResolutionTicks();
+  // both flags are exchanged, so neither overflow is left over for the next block
+  const bool events_overflowed = state.automation_events.exchange_overflowed();
+  const bool commands_overflowed = state.automation_commands.exchange_overflowed();
+
+  if (events_overflowed || commands_overflowed) {
+    // we lost track of some changes, fall back to the latest values
+    reset(state);
+  } else {
+    auto add = [&](const AutomationEvent &event, bool timed) {
+      if (event.type == AutomationEvent::Type::PARAMETER_SET) {
+        apply_parameter_set(state, event.ticks);
+        return;
+      }
+      // changes made during the previous block land at the same relative
+      // position in this one. host automation starts the block
+      int offset = 0;
+      if (timed && event.type != AutomationEvent::Type::PROPERTY && last_block_ticks != 0)
+        offset = int(double(event.ticks - last_block_ticks) * samples_per_tick);
+      offset = juce::jlimit(0, std::max(0, numSamples - 1), offset);
+      offset -= offset % min_sub_block_size;
+      add_event(offset, event);
+    };
+    AutomationEvent event;
+    while (state.automation_events.pop(event)) {
+      host_ticks[event.param_id] = event.ticks;
+      host_values[event.param_id] = event.value;
+      add(event, false);
+    }
+    while (state.automation_commands.pop(event))
+      add(event, true);
+  }
+  last_block_ticks = block_ticks;
+}
+
+// called from the audio thread
+void BlockAutomation::reset(StateManager &state) {
+  AutomationEvent event;
+  while (state.automation_events.pop(event)) {
+  }
+  while (state.automation_commands.pop(event)) {
+  }
+  num_events = 0;
+  clear_snapped();
+  host_ticks.fill(0);
+  for (size_t p_id = 0; p_id < TOTAL_NUMBER_PARAMETERS; ++p_id)
+    values[p_id] = state.param_value(p_id);
+  last_block_ticks = juce::Time::getHighResolutionTicks();
+}
+
+void BlockAutomation::add_event(int sample_offset, const AutomationEvent &event) {
+  if (num_events == MAX_EVENTS_PER_BLOCK) {
+    // out of room, apply at the start of the block instead. a snap is then
+    // just a step, which the smoothing follows
+    values[event.param_id] = event.value;
+    return;
+  }
+  // insertion sort, stable so later changes to the same offset win
+  int i = num_events++;
+  for (; i > 0 && events[size_t(i - 1)].sample_offset > sample_offset; --i)
+    events[size_t(i)] = events[size_t(i - 1)];
+  events[size_t(i)] = {sample_offset, event.ticks, event.param_id, event.value,
+                       event.type == AutomationEvent::Type::SNAP};
+}
+
+void BlockAutomation::apply_parameter_set(StateManager &state, juce::int64 set_ticks) {
+  // the commands queued before the set are all older than it, but host
+  // automation comes from another queue, drained first, and can be newer.
+  // newer host changes win over the set, like they did in the state: the
+  // pending ones are kept, in order, and the ones already applied (in this
+  // block or an earlier one) keep their value
+  int kept = 0;
+  for (int e = 0; e < num_events; ++e)
+    if (events[size_t(e)].ticks >= set_ticks)
+      events[size_t(kept++)] = events[size_t(e)];
+  num_events = kept;
+  // the snaps that were pending are replaced too
+  clear_snapped();
+  values = state.parameter_sets.latest();
+  for (size_t p_id = 0; p_id < TOTAL_NUMBER_PARAMETERS; ++p_id)
+    if (host_ticks[p_id] >= set_ticks)
+      values[p_id] = host_values[p_id];
+}
@@ -0,0 +1,234 @@
+#pragma once
+
+class StateManager;
+
+#include <juce_core/juce_core.h>
+
+#include "../Util/MpscQueue.h"
+#include "../Util/SpscQueue.h"
+#include "ParameterDefines.h"
+
+//==============================================================================
+// AutomationEvent
+// a single parameter change on its way from the UI or the host to the audio thread
+// ticks is the juce::Time::getHighResolutionTicks() time of the change. changes
+// from the message thread are placed in the block by it. host automation (from
+// AutomationEventQueue), which JUCE delivers on the audio thread right before
+// processBlock, is always applied at the start of the next block, and its
+// ticks only order it against parameter sets
+//
+// type says how the audio thread applies it:
+//   PARAMETER  at the sample it was made, smoothed as usual
+//   PROPERTY   at the start of the block it arrives in, so a mode switch never
+//              lands in the middle of a block
+//   SNAP       at the sample it was made, with the smoothing jumping straight to
+//              the new value
+//   PARAMETER_SET
+//              every value at once, from StateManager::parameter_sets, at the
+//              start of the block. param_id and value are unused
+//==============================================================================
+struct AutomationEvent {
+  enum class Type : std::uint8_t { PARAMETER, PROPERTY, SNAP, PARAMETER_SET };
+
+  juce::int64 ticks;
+  size_t param_id;
+  float value;
+  Type type{Type::PARAMETER};
+};
+
+//==============================================================================
+// AutomationEventQueue
+// bounded, lock-free, multi-producer single-consumer queue (see
+// ../Util/MpscQueue.h). parameter listeners can be called from any thread, but
+// only the audio thread pops. push() and pop() never lock or allocate
+//==============================================================================
+class AutomationEventQueue {
+public:
+  static constexpr size_t CAPACITY = 1024; // must be a power of 2
+
+  AutomationEventQueue() = default;
+  // called from any thread, returns false (and notes the overflow) if full
+  bool push(const AutomationEvent &event);
+  // called from the audio thread only
+  bool pop(AutomationEvent &event);
+  // true if any event was dropped since the last call
+  bool exchange_overflowed() { return overflowed.exchange(false); }
+
+private:
+  nthn_utils::MpscQueue<AutomationEvent, CAPACITY> events;
+  std::atomic<bool> overflowed{false};
+
+  JUCE_DECLARE_NON_COPYABLE(AutomationEventQueue)
+};
+
+//==============================================================================
+// AutomationCommandQueue
+// bounded, lock-free, single-producer single-consumer queue from the message
+// thread (the UI, preset loads) to the audio thread.
+// every change made on the message thread goes through here, so a fast gesture
+// reaches the audio thread one value at a time instead of as whatever the
+// atomics hold when the block starts. with one producer, a push is a plain
+// store and a release, with no compare-exchange loop (see ../Util/SpscQueue.h)
+//==============================================================================
+class AutomationCommandQueue {
+public:
+  static constexpr size_t CAPACITY = 1024; // must be a power of 2
+
+  AutomationCommandQueue() = default;
+  // called from the message thread only, returns false (and notes the overflow) if full
+  bool push(const AutomationEvent &event);
+  // called from the audio thread only
+  bool pop(AutomationEvent &event);
+  // true if any event was dropped since the last call
+  bool exchange_overflowed() { return overflowed.exchange(false); }
+
+private:
+  nthn_utils::SpscQueue<AutomationEvent, CAPACITY> events;
+  std::atomic<bool> overflowed{false};
+
+  JUCE_DECLARE_NON_COPYABLE(AutomationCommandQueue)
+};
+
+//==============================================================================
+// ParameterSetMailbox
+// hands a whole set of values (one per PARAM) from the message thread to the
+// audio thread, for changes that must be picked up all at once. a triple
+// buffer: the writer fills its own buffer and swaps it into the middle, the
+// reader swaps the middle out only if something new was published. neither
+// side ever waits, and the reader always gets the latest complete set
+//==============================================================================
+class ParameterSetMailbox {
+public:
+  using Values = std::array<float, TOTAL_NUMBER_PARAMETERS>;
+
+  ParameterSetMailbox() = default;
+  // called from the message thread only: fill write_buffer(), then publish()
+  Values &write_buffer() { return buffers[size_t(write_index)]; }
+  void publish() {
+    const int previous = middle.exchange(write_index | NEW_DATA, std::memory_order_acq_rel);
+    write_index = previous & INDEX_MASK;
+  }
+  // called from the audio thread only, the last published set
+  const Values &latest() {
+    if ((middle.load(std::memory_order_relaxed) & NEW_DATA) != 0)
+      read_index = middle.exchange(read_index, std::memory_order_acq_rel) & INDEX_MASK;
+    return buffers[size_t(read_index)];
+  }
+
+private:
+  static constexpr int INDEX_MASK = 3;
+  static constexpr int NEW_DATA = 4;
+  std::array<Values, 3> buffers{};
+  // producer side
+  alignas(64) int write_index{0};
+  // the buffer between the two, with NEW_DATA set until the reader takes it
+  alignas(64) std::atomic<int> middle{1};
+  // consumer side
+  alignas(64) int read_index{2};
+
+  JUCE_DECLARE_NON_COPYABLE(ParameterSetMailbox)
+};
+
+//==============================================================================
+// BlockAutomation
+// audio thread side of the automation pipeline.
+// begin_block() drains both queues (host automation first, then the message
+// thread's commands) and converts each event's timestamp into a
+// sample offset in the current block (the same way juce::MidiMessageCollector
+// places live midi). process_sub_blocks() then splits the block at every change
+// point, so processors see each new value at the sample it was set.
+//
+// property changes are applied at the start of the block instead, and snaps
+// also tell the smoothing to jump (see snapped()). a parameter set replaces
+// every change made before it (by ticks), and is applied at the start of the
+// block. host changes made after the set was published stay on top of it.
+//
+// offsets are rounded down to a multiple of min_sub_block_size so that no
+// sub-block is shorter than that (except the tail of a block), and sub-blocks
+// are never longer than max_sub_block_size, so processors can size their
+// buffers in prepareToPlay even if the host sends a bigger block than promised.
+// with no pending events, process_sub_blocks() is a single call over the whole
+// block
+//==============================================================================
+class BlockAutomation {
+public:
+  static constexpr int MAX_EVENTS_PER_BLOCK = 256;
+
+  BlockAutomation() = default;
+  // called from prepareToPlay
+  void prepare(double sample_rate, int min_sub_block_size_, int max_sub_block_size_);
+  // called from the audio thread
+  void set_min_sub_block_size(int min_sub_block_size_);
+  void begin_block(StateManager &state, int numSamples);
+  // drop pending events and jump all values to the current state
+  void reset(StateManager &state);
+
+  // the value of a parameter at the start of the current sub-block
+  float value(size_t param_id) const { return values[param_id]; }
+  // true if a snap command set the parameter at the start of the current
+  // sub-block, so smoothers should jump to value() instead of ramping to it
+  bool snapped(size_t param_id) const { return snapped_flags[param_id]; }
+
+  // process(start_sample, num_samples) is called once per sub-block
+  template <typename ProcessFn> void process_sub_blocks(int numSamples, ProcessFn &&process) {
+    int start = 0;
+    for (int e = 0; e < num_events;) {
+      const int offset = events[size_t(e)].sample_offset;
+      process_span(start, offset, process);
+      clear_snapped();
+      start = offset;
+      // apply every change at this offset before processing on
+      for (; e < num_events && events[size_t(e)].sample_offset == offset; ++e) {
+        const auto &event = events[size_t(e)];
+        values[event.param_id] = event.value;
+        if (event.snap) {
+          snapped_flags[event.param_id] = true;
+          any_snapped = true;
+        }
+      }
+    }
+    process_span(start, numSamples, process);
+    clear_snapped();
+    num_events = 0;
+  }
+
+private:
+  struct BlockEvent {
+    int sample_offset;
+    juce::int64 ticks;
+    size_t param_id;
+    float value;
+    bool snap;
+  };
+  void add_event(int sample_offset, const AutomationEvent &event);
+  // drops the events made before the set and takes its values
+  void apply_parameter_set(StateManager &state, juce::int64 set_ticks);
+  void clear_snapped() {
+    if (any_snapped) {
+      snapped_flags.fill(false);
+      any_snapped = false;
+    }
+  }
+
+  template <typename ProcessFn> void process_span(int start, int end, ProcessFn &process) {
+    for (; start < end; start += max_sub_block_size)
+      process(start, std::min(max_sub_block_size, end - start));
+  }
+
+  std::array<BlockEvent, MAX_EVENTS_PER_BLOCK> events;
+  int num_events{0};
+  std::array<float, TOTAL_NUMBER_PARAMETERS> values{};
+  std::array<bool, TOTAL_NUMBER_PARAMETERS> snapped_flags{};
+  bool any_snapped{false};
+  // the latest host change of each parameter, which a parameter set published
+  // before it must not undo, even if the set arrives a block later
+  std::array<juce::int64, TOTAL_NUMBER_PARAMETERS> host_ticks{};
+  std::array<float, TOTAL_NUMBER_PARAMETERS> host_values{};
+
+  double samples_per_tick{0.0};
+  int min_sub_block_size{1};
+  int max_sub_block_size{std::numeric_limits<int>::max()};
+  juce::int64 last_block_ticks{0};
+
+  JUCE_DECLARE_NON_COPYABLE(BlockAutomation)
+};
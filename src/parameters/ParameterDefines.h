@@ -1,33 +1,82 @@
 #pragma once
-#include <juce_core/juce_core.h>
+// generated from parameters.csv by create_parameters.cpp, don't edit
+#include <array>
+#include <cstddef>
+#include <string_view>
 enum PARAM {
 	GAIN,
+	OVERSAMPLING,
+	OVERSAMPLING_QUALITY,
 	TOTAL_NUMBER_PARAMETERS
 };
-static const std::array<juce::Identifier, PARAM::TOTAL_NUMBER_PARAMETERS> PARAMETER_IDS{
-	"GAIN",
+// the arguments of juce::NormalisableRange<float>
+struct ParameterRange {
+	float start;
+	float end;
+	float interval;
+	float skew;
+};
+// the TO_STRING_ARR entries of one parameter, in PARAMETER_TO_STRING_VALUES
+struct ParameterStringList {
+	const std::string_view *first;
+	std::size_t count;
+	constexpr std::size_t size() const { return count; }
+	constexpr bool empty() const { return count == 0; }
+	constexpr const std::string_view &operator[](std::size_t i) const { return first[i]; }
+	constexpr const std::string_view *begin() const { return first; }
+	constexpr const std::string_view *end() const { return first + count; }
 };
-static const std::array<juce::String, PARAM::TOTAL_NUMBER_PARAMETERS> PARAMETER_NAMES{
+inline constexpr std::array<std::string_view, PARAM::TOTAL_NUMBER_PARAMETERS> PARAMETER_NAMES {
 	"GAIN",
+	"OVERSAMPLING",
+	"OVERSAMPLING_QUALITY",
 };
-static const std::array<juce::NormalisableRange<float>, PARAM::TOTAL_NUMBER_PARAMETERS> PARAMETER_RANGES {
-	juce::NormalisableRange<float>(0.0f, 100.0f, 0.0f, 1.0f),
+inline constexpr std::array<ParameterRange, PARAM::TOTAL_NUMBER_PARAMETERS> PARAMETER_RANGES {
+	ParameterRange{0.0f, 100.0f, 0.0f, 1.0f},
+	ParameterRange{0.0f, 3.0f, 1.0f, 1.0f},
+	ParameterRange{0.0f, 2.0f, 1.0f, 1.0f},
 };
-static const std::array<float, PARAM::TOTAL_NUMBER_PARAMETERS> PARAMETER_DEFAULTS {
+inline constexpr std::array<float, PARAM::TOTAL_NUMBER_PARAMETERS> PARAMETER_DEFAULTS {
 	50.0f,
+	0.0f,
+	1.0f,
 };
-static const std::array<bool, PARAM::TOTAL_NUMBER_PARAMETERS> PARAMETER_AUTOMATABLE {
+inline constexpr std::array<bool, PARAM::TOTAL_NUMBER_PARAMETERS> PARAMETER_AUTOMATABLE {
 	true,
+	false,
+	false,
 };
-static const std::array<juce::String, PARAM::TOTAL_NUMBER_PARAMETERS> PARAMETER_NICKNAMES{
+inline constexpr std::array<std::string_view, PARAM::TOTAL_NUMBER_PARAMETERS> PARAMETER_NICKNAMES {
 	"Gain",
+	"Oversampling",
+	"Quality",
 };
-static const std::array<juce::String, PARAM::TOTAL_NUMBER_PARAMETERS> PARAMETER_SUFFIXES {
+inline constexpr std::array<std::string_view, PARAM::TOTAL_NUMBER_PARAMETERS> PARAMETER_SUFFIXES {
 	"%",
+	"",
+	"",
 };
-static const std::array<juce::String, PARAM::TOTAL_NUMBER_PARAMETERS> PARAMETER_TOOLTIPS {
+inline constexpr std::array<std::string_view, PARAM::TOTAL_NUMBER_PARAMETERS> PARAMETER_TOOLTIPS {
 	"Loudness Parameter",
+	"Oversampling factor for the nonlinear stages",
+	"Oversampling filter quality (higher quality adds latency)",
+};
+inline constexpr std::array<float, PARAM::TOTAL_NUMBER_PARAMETERS> PARAMETER_SMOOTHING {
+	0.05f,
+	0.0f,
+	0.0f,
+};
+inline constexpr std::array<std::string_view, 7> PARAMETER_TO_STRING_VALUES {
+	"1x",
+	"2x",
+	"4x",
+	"8x",
+	"Low",
+	"Normal",
+	"High",
 };
-static const std::array<std::vector<juce::String>, PARAM::TOTAL_NUMBER_PARAMETERS> PARAMETER_TO_STRING_ARRS {
-	std::vector<juce::String>{},
+inline constexpr std::array<ParameterStringList, PARAM::TOTAL_NUMBER_PARAMETERS> PARAMETER_TO_STRING_ARRS {
+	ParameterStringList{nullptr, 0},
+	ParameterStringList{PARAMETER_TO_STRING_VALUES.data() + 0, 4},
+	ParameterStringList{PARAMETER_TO_STRING_VALUES.data() + 4, 3},
 };
@@ -0,0 +1,65 @@
+#include "ParameterObjects.h"
+
+namespace parameter_objects {
+namespace {
+juce::String to_juce_string(std::string_view text) {
+  return juce::String::fromUTF8(text.data(), int(text.size()));
+}
+
+struct Objects {
+  Objects() {
+    for (size_t p_id = 0; p_id < TOTAL_NUMBER_PARAMETERS; ++p_id) {
+      names[p_id] = to_juce_string(PARAMETER_NAMES[p_id]);
+      identifiers[p_id] = juce::Identifier(names[p_id]);
+      nicknames[p_id] = to_juce_string(PARAMETER_NICKNAMES[p_id]);
+      suffixes[p_id] = to_juce_string(PARAMETER_SUFFIXES[p_id]);
+      tooltips[p_id] = to_juce_string(PARAMETER_TOOLTIPS[p_id]);
+      const auto &r = PARAMETER_RANGES[p_id];
+      ranges[p_id] = juce::NormalisableRange<float>(r.start, r.end, r.interval, r.skew);
+    }
+  }
+  std::array<juce::Identifier, TOTAL_NUMBER_PARAMETERS> identifiers;
+  std::array<juce::String, TOTAL_NUMBER_PARAMETERS> names;
+  std::array<juce::String, TOTAL_NUMBER_PARAMETERS> nicknames;
+  std::array<juce::String, TOTAL_NUMBER_PARAMETERS> suffixes;
+  std::array<juce::String, TOTAL_NUMBER_PARAMETERS> tooltips;
+  std::array<juce::NormalisableRange<float>, TOTAL_NUMBER_PARAMETERS> ranges;
+};
+
+// built on first use, thread safe
+const Objects &objects() {
+  static const Objects instance;
+  return instance;
+}
+} // namespace
+
+const juce::Identifier &identifier(size_t param_id) {
+  jassert(param_id < TOTAL_NUMBER_PARAMETERS);
+  return objects().identifiers[param_id];
+}
+
+const juce::String &name(size_t param_id) {
+  jassert(param_id < TOTAL_NUMBER_PARAMETERS);
+  return objects().names[param_id];
+}
+
+const juce::String &nickname(size_t param_id) {
+  jassert(param_id < TOTAL_NUMBER_PARAMETERS);
+  return objects().nicknames[param_id];
+}
+
+const juce::String &suffix(size_t param_id) {
+  jassert(param_id < TOTAL_NUMBER_PARAMETERS);
+  return objects().suffixes[param_id];
+}
+
+const juce::String &tooltip(size_t param_id) {
+  jassert(param_id < TOTAL_NUMBER_PARAMETERS);
+  return objects().tooltips[param_id];
+}
+
+const juce::NormalisableRange<float> &range(size_t param_id) {
+  jassert(param_id < TOTAL_NUMBER_PARAMETERS);
+  return objects().ranges[param_id];
+}
+} // namespace parameter_objects
@@ -0,0 +1,23 @@
+#pragma once
+
+#include <juce_core/juce_core.h>
+
+#include "ParameterDefines.h"
+
+//==============================================================================
+// ParameterObjects
+// the juce objects made from the constexpr tables in ParameterDefines.h, for
+// the apis that need them (the APVTS, value trees, components)
+//
+// they are all created together the first time any of them is asked for,
+// which is when the StateManager is built, rather than when the plugin is
+// loaded. after that each call is a guard check and an index
+//==============================================================================
+namespace parameter_objects {
+const juce::Identifier &identifier(size_t param_id);
+const juce::String &name(size_t param_id);
+const juce::String &nickname(size_t param_id);
+const juce::String &suffix(size_t param_id);
+const juce::String &tooltip(size_t param_id);
+const juce::NormalisableRange<float> &range(size_t param_id);
+} // namespace parameter_objects
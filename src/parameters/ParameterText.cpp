@@ -0,0 +1,202 @@
+#include "ParameterText.h"
+#include "ParameterObjects.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+
+namespace {
+constexpr double pow10(int exponent) { return exponent == 0 ? 1.0 : 10.0 * pow10(exponent - 1); }
+
+// a float has 24 significant bits, and 10^DECIMALS is 5^DECIMALS (at most 28
+// bits up to 12 decimals) times a power of two, so their product is exact in
+// a double. rounding it to an integer then rounds like printf("%.2f") does
+static_assert(ParameterText::DECIMALS >= 1 && ParameterText::DECIMALS <= 12);
+constexpr double DECIMAL_SCALE = pow10(ParameterText::DECIMALS);
+
+// the same text as std::fixed and std::setprecision(DECIMALS), returns its length
+int write_fixed(float value, char *buffer, int buffer_size) {
+  const double scaled = double(value) * DECIMAL_SCALE;
+  if (!(std::abs(scaled) < 1.0e15)) {
+    // inf, nan and huge values
+    const int length = std::snprintf(buffer, size_t(buffer_size), "%.*f",
+                                     ParameterText::DECIMALS, double(value));
+    return juce::jlimit(0, buffer_size - 1, length);
+  }
+  // least significant digit first, with at least one digit before the point
+  char digits[24];
+  int num_digits = 0;
+  auto integer = static_cast<long long>(std::nearbyint(std::abs(scaled)));
+  do {
+    digits[num_digits++] = char('0' + integer % 10);
+    integer /= 10;
+  } while (integer > 0 || num_digits <= ParameterText::DECIMALS);
+
+  if (num_digits + 2 > buffer_size)
+    return 0;
+  int length = 0;
+  if (std::signbit(value))
+    buffer[length++] = '-';
+  for (int i = num_digits - 1; i >= 0; --i) {
+    if (i == ParameterText::DECIMALS - 1)
+      buffer[length++] = '.';
+    buffer[length++] = digits[i];
+  }
+  return length;
+}
+
+// appends as many bytes as fit, without splitting a utf8 character
+int append(char *buffer, int length, int buffer_size, const char *bytes, size_t num_bytes) {
+  auto count = std::min(num_bytes, size_t(std::max(0, buffer_size - length)));
+  if (count < num_bytes)
+    while (count > 0 && (static_cast<unsigned char>(bytes[count]) & 0xc0) == 0x80)
+      --count;
+  std::memcpy(buffer + length, bytes, count);
+  return length + int(count);
+}
+
+bool same_value(float a, float b) {
+  std::uint32_t a_bits, b_bits;
+  std::memcpy(&a_bits, &a, sizeof(a));
+  std::memcpy(&b_bits, &b, sizeof(b));
+  return a_bits == b_bits;
+}
+
+char to_lower_ascii(char c) { return c >= 'A' && c <= 'Z' ? char(c - 'A' + 'a') : c; }
+
+// where " <suffix>" first starts in the text, ignoring case, or num_bytes
+size_t find_suffix(const char *bytes, size_t num_bytes, const char *suffix, size_t suffix_bytes) {
+  for (size_t start = 0; start + suffix_bytes < num_bytes; ++start) {
+    if (bytes[start] != ' ')
+      continue;
+    size_t i = 0;
+    while (i < suffix_bytes && to_lower_ascii(bytes[start + 1 + i]) == to_lower_ascii(suffix[i]))
+      ++i;
+    if (i == suffix_bytes)
+      return start;
+  }
+  return num_bytes;
+}
+} // namespace
+
+//==============================================================================
+ParameterText::ParameterText() : steps(step_table()) {}
+
+const ParameterText::StepTable &ParameterText::step_table() {
+  // the texts only depend on ParameterDefines.h, so every instance of the
+  // plugin shares them. juce::String is immutable and its reference count
+  // atomic, so copies can be handed out on any thread
+  static const StepTable table = [] {
+    StepTable steps;
+    for (size_t p_id = 0; p_id < TOTAL_NUMBER_PARAMETERS; ++p_id) {
+      auto add_step = [&](float value) {
+        char buffer[MAX_TEXT_BYTES];
+        auto text = juce::String::fromUTF8(buffer, format(p_id, value, buffer, MAX_TEXT_BYTES));
+        const int length = text.length();
+        steps[p_id].push_back({value, std::move(text), length});
+      };
+
+      const auto &names = PARAMETER_TO_STRING_ARRS[p_id];
+      const auto &range = PARAMETER_RANGES[p_id];
+      if (!names.empty()) {
+        for (size_t i = 0; i < names.size(); ++i)
+          add_step(float(i));
+      } else if (range.interval > 0.0f) {
+        const int num_steps =
+            int(std::floor((range.end - range.start) / range.interval + 0.5f)) + 1;
+        // the same values the host gets from convertFrom0to1()
+        const auto &legal_values = parameter_objects::range(p_id);
+        if (num_steps <= MAX_PRECOMPUTED_STEPS)
+          for (int i = 0; i < num_steps; ++i)
+            add_step(legal_values.snapToLegalValue(range.start + range.interval * float(i)));
+      }
+    }
+    return steps;
+  }();
+  return table;
+}
+
+juce::String ParameterText::to_text(size_t param_id, float value, int maximum_length) {
+  jassert(param_id < TOTAL_NUMBER_PARAMETERS);
+  if (auto *step = find_step(param_id, value))
+    return cut(*step, maximum_length);
+
+  auto &cache = caches[param_id];
+  const juce::SpinLock::ScopedTryLockType lock(cache.lock);
+  if (lock.isLocked())
+    for (int i = 0; i < cache.num_recent; ++i)
+      if (same_value(cache.recent[size_t(i)].value, value))
+        return cut(cache.recent[size_t(i)], maximum_length);
+
+  char buffer[MAX_TEXT_BYTES];
+  Entry entry;
+  entry.value = value;
+  entry.text = juce::String::fromUTF8(buffer, format(param_id, value, buffer, MAX_TEXT_BYTES));
+  entry.length = entry.text.length();
+  if (lock.isLocked()) {
+    cache.recent[size_t(cache.next_recent)] = entry;
+    cache.next_recent = (cache.next_recent + 1) % RECENT_VALUES;
+    cache.num_recent = std::min(cache.num_recent + 1, RECENT_VALUES);
+  }
+  return cut(entry, maximum_length);
+}
+
+float ParameterText::to_value(size_t param_id, const juce::String &text) const {
+  jassert(param_id < TOTAL_NUMBER_PARAMETERS);
+  const auto &names = PARAMETER_TO_STRING_ARRS[param_id];
+  if (!names.empty()) {
+    // the name is everything before " <suffix>"
+    const char *bytes = text.toRawUTF8();
+    const auto &suffix = PARAMETER_SUFFIXES[param_id];
+    const size_t name_bytes =
+        find_suffix(bytes, text.getNumBytesAsUTF8(), suffix.data(), suffix.size());
+    for (size_t i = 0; i < names.size(); ++i)
+      if (names[i].size() == name_bytes && std::memcmp(names[i].data(), bytes, name_bytes) == 0)
+        return float(i);
+    DBG("ERROR: Could not find text in PARAMETER_TO_STRING_ARRS");
+  }
+  // stops at the first character that isn't part of the number, like the suffix
+  return float(juce::CharacterFunctions::getDoubleValue(text.getCharPointer()));
+}
+
+int ParameterText::format(size_t param_id, float value, char *buffer, int buffer_size) {
+  jassert(param_id < TOTAL_NUMBER_PARAMETERS);
+  int length = 0;
+  const auto &names = PARAMETER_TO_STRING_ARRS[param_id];
+  if (!names.empty() && value >= 0.0f && value < float(names.size())) {
+    const auto &name = names[size_t(value)];
+    length = append(buffer, length, buffer_size, name.data(), name.size());
+  } else {
+    length = write_fixed(value, buffer, buffer_size);
+  }
+  const auto &suffix = PARAMETER_SUFFIXES[param_id];
+  length = append(buffer, length, buffer_size, " ", 1);
+  return append(buffer, length, buffer_size, suffix.data(), suffix.size());
+}
+
+const ParameterText::Entry *ParameterText::find_step(size_t param_id, float value) const {
+  const auto &param_steps = steps[param_id];
+  if (param_steps.empty())
+    return nullptr;
+  if (!PARAMETER_TO_STRING_ARRS[param_id].empty()) {
+    // any value from i up to i + 1 shows the name of entry i
+    if (value >= 0.0f && value < float(param_steps.size()))
+      return &param_steps[size_t(value)];
+    return nullptr;
+  }
+  const auto &range = PARAMETER_RANGES[param_id];
+  const float index = std::floor((value - range.start) / range.interval + 0.5f);
+  // false for nan too
+  if (!(index >= 0.0f && index < float(param_steps.size())))
+    return nullptr;
+  const auto &step = param_steps[size_t(index)];
+  return same_value(step.value, value) ? &step : nullptr;
+}
+
+juce::String ParameterText::cut(const Entry &entry, int maximum_length) {
+  // only a cut text allocates
+  if (maximum_length > 0 && entry.length > maximum_length)
+    return entry.text.substring(0, maximum_length);
+  return entry.text;
+}
@@ -0,0 +1,75 @@
+#pragma once
+
+#include <array>
+#include <vector>
+
+#include <juce_core/juce_core.h>
+
+#include "ParameterDefines.h"
+
+//==============================================================================
+// ParameterText
+// converts parameter values to the text shown by hosts and the editor, like
+// "50.00 %" or "2x ", and back. hosts ask for this text all the time to draw
+// automation lanes and generic editors, so it is built without streams or
+// string concatenation:
+//
+//   - every TO_STRING_ARR entry, and every value on a grain (up to
+//     MAX_PRECOMPUTED_STEPS of them), is formatted once, when the first
+//     ParameterText is built, into a table every instance shares
+//   - other values are written into a stack buffer, and the last
+//     RECENT_VALUES texts of each parameter are kept, so asking for the same
+//     value again only copies a juce::String (a reference count increment)
+//
+// to_value() parses the text in place, without allocating
+// both can be called from any thread, but never from the audio thread
+//==============================================================================
+class ParameterText {
+public:
+  ParameterText();
+
+  // the text of a plain (not normalised) value. if maximum_length is above 0,
+  // the text is cut to that many characters
+  juce::String to_text(size_t param_id, float value, int maximum_length = 0);
+  // the plain value of a text from to_text() or typed by the user
+  float to_value(size_t param_id, const juce::String &text) const;
+  // writes the text of a value into buffer (not null terminated) and returns its
+  // length in bytes. never allocates
+  static int format(size_t param_id, float value, char *buffer, int buffer_size);
+
+  // digits after the decimal point of numbers
+  static constexpr int DECIMALS = 2;
+  // longest text format() writes, in bytes
+  static constexpr int MAX_TEXT_BYTES = 64;
+  static constexpr int RECENT_VALUES = 8;
+  // parameters with more values on their grain are formatted on demand
+  static constexpr int MAX_PRECOMPUTED_STEPS = 1024;
+
+private:
+  struct Entry {
+    float value{0.0f};
+    juce::String text;
+    int length{0}; // in characters
+  };
+  // per parameter, one entry per TO_STRING_ARR entry, or per value on the grain
+  using StepTable = std::array<std::vector<Entry>, TOTAL_NUMBER_PARAMETERS>;
+  // built on the first call, then only read (from any thread)
+  static const StepTable &step_table();
+
+  struct ParameterCache {
+    // the last texts built by to_text(), replaced round robin
+    std::array<Entry, RECENT_VALUES> recent;
+    int num_recent{0};
+    int next_recent{0};
+    // only ever tried, a thread that doesn't get it formats without the cache
+    juce::SpinLock lock;
+  };
+  // the precomputed text of a value, or nullptr
+  const Entry *find_step(size_t param_id, float value) const;
+  static juce::String cut(const Entry &entry, int maximum_length);
+
+  const StepTable &steps;
+  std::array<ParameterCache, TOTAL_NUMBER_PARAMETERS> caches;
+
+  JUCE_DECLARE_NON_COPYABLE(ParameterText)
+};
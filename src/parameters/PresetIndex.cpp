@@ -0,0 +1,166 @@
+#include "PresetIndex.h"
+#include "StateFormat.h"
+#include "StateManager.h"
+
+namespace {
+constexpr juce::uint32 CACHE_MAGIC = 0x4958504e; // "NPXI"
+constexpr juce::uint32 CACHE_VERSION = 1;
+
+bool name_less(const PresetIndex::Entry &a, const PresetIndex::Entry &b) {
+  return a.name.compareNatural(b.name) < 0;
+}
+} // namespace
+
+PresetIndex::PresetIndex(const juce::File &presets_dir_, const juce::String &preset_extension_)
+    : juce::Thread("Preset Index"), presets_dir(presets_dir_),
+      preset_extension(preset_extension_), entries(std::make_shared<const Entries>()) {
+  for (size_t p_id = 0; p_id < TOTAL_NUMBER_PARAMETERS; ++p_id)
+    param_ids_by_name[parameter_objects::name(p_id)] = p_id;
+}
+
+PresetIndex::~PresetIndex() { stopThread(4000); }
+
+// called from the message thread
+void PresetIndex::start() {
+  if (!isThreadRunning()) startThread(juce::Thread::Priority::background);
+}
+
+// called from any thread
+void PresetIndex::refresh() { notify(); }
+
+// called from any thread
+std::shared_ptr<const PresetIndex::Entries> PresetIndex::get_entries() const {
+  std::lock_guard<std::mutex> lock(entries_mutex);
+  return entries;
+}
+
+std::vector<size_t> PresetIndex::search(const Entries &entries_, const juce::String &query,
+                                        bool prefix_only) {
+  std::vector<size_t> result;
+  for (size_t i = 0; i < entries_.size(); ++i) {
+    const auto &name = entries_[i].name;
+    if (prefix_only ? name.startsWithIgnoreCase(query) : name.containsIgnoreCase(query))
+      result.push_back(i);
+  }
+  return result;
+}
+
+void PresetIndex::run() {
+  load_cache();
+  scan();
+  while (!threadShouldExit()) {
+    // true when woken by refresh()
+    const bool refreshed = wait(POLL_INTERVAL_MS);
+    if (threadShouldExit()) return;
+    // one stat of the directory, instead of listing every preset
+    if (refreshed ||
+        presets_dir.getLastModificationTime().toMilliseconds() != scanned_directory_time)
+      scan();
+  }
+}
+
+void PresetIndex::scan() {
+  // taken before listing, so a change made during the scan triggers another one
+  scanned_directory_time = presets_dir.getLastModificationTime().toMilliseconds();
+  auto new_entries = std::make_shared<Entries>();
+  std::unordered_map<juce::String, Entry> still_present;
+  bool changed = false;
+
+  for (const auto &child : juce::RangedDirectoryIterator(
+           presets_dir, false, "*" + preset_extension, juce::File::findFiles)) {
+    if (threadShouldExit()) return;
+    const auto file = child.getFile();
+    const auto path = file.getFullPathName();
+    const auto modification_time = child.getModificationTime().toMilliseconds();
+
+    auto known = known_entries.find(path);
+    if (known != known_entries.end() && known->second.modification_time == modification_time) {
+      // unchanged since the cache or last scan, don't read it again
+      new_entries->push_back(known->second);
+    } else {
+      Entry entry;
+      entry.modification_time = modification_time;
+      if (!read_entry(file, entry)) continue;
+      new_entries->push_back(entry);
+      changed = true;
+    }
+    still_present.emplace(path, new_entries->back());
+  }
+
+  // anything left in known_entries was deleted
+  changed = changed || still_present.size() != known_entries.size();
+  known_entries = std::move(still_present);
+
+  if (changed || version.load() == 0) {
+    std::sort(new_entries->begin(), new_entries->end(), name_less);
+    save_cache(*new_entries);
+    publish(std::move(new_entries));
+  }
+}
+
+bool PresetIndex::read_entry(const juce::File &file, Entry &entry) const {
+  juce::MemoryBlock data;
+  if (!file.loadFileAsData(data)) return false;
+  auto state = state_format::read(data.getData(), data.getSize());
+  if (!state.isValid()) return false;
+
+  entry.name = file.getFileNameWithoutExtension();
+  entry.file = file;
+  // parameters missing from the preset keep their defaults
+  std::copy(PARAMETER_DEFAULTS.begin(), PARAMETER_DEFAULTS.end(), entry.values.begin());
+  for (const auto &param : state.getChildWithName(StateManager::PARAMETERS_ID)) {
+    auto it = param_ids_by_name.find(param.getProperty("id").toString());
+    if (it != param_ids_by_name.end()) entry.values[it->second] = float(param.getProperty("value"));
+  }
+  const auto properties = state.getChildWithName(StateManager::PROPERTIES_ID);
+  for (int i = 0; i < properties.getNumProperties(); ++i) {
+    const auto name = properties.getPropertyName(i);
+    auto it = param_ids_by_name.find(name.toString());
+    if (it != param_ids_by_name.end()) entry.values[it->second] = float(properties[name]);
+  }
+  return true;
+}
+
+void PresetIndex::load_cache() {
+  juce::FileInputStream input(presets_dir.getChildFile(CACHE_FILE_NAME));
+  if (!input.openedOk()) return;
+  if (juce::uint32(input.readInt()) != CACHE_MAGIC) return;
+  if (juce::uint32(input.readInt()) != CACHE_VERSION) return;
+  // a cache written for a different parameter list is useless
+  if (input.readInt() != int(TOTAL_NUMBER_PARAMETERS)) return;
+
+  const int count = input.readInt();
+  for (int i = 0; i < count && !input.isExhausted(); ++i) {
+    Entry entry;
+    entry.file = juce::File(input.readString());
+    entry.name = entry.file.getFileNameWithoutExtension();
+    entry.modification_time = input.readInt64();
+    for (auto &value : entry.values)
+      value = input.readFloat();
+    known_entries.emplace(entry.file.getFullPathName(), entry);
+  }
+}
+
+void PresetIndex::save_cache(const Entries &entries_) const {
+  if (!presets_dir.isDirectory()) return;
+  juce::MemoryOutputStream output;
+  output.writeInt(int(CACHE_MAGIC));
+  output.writeInt(int(CACHE_VERSION));
+  output.writeInt(int(TOTAL_NUMBER_PARAMETERS));
+  output.writeInt(int(entries_.size()));
+  for (const auto &entry : entries_) {
+    output.writeString(entry.file.getFullPathName());
+    output.writeInt64(entry.modification_time);
+    for (auto value : entry.values)
+      output.writeFloat(value);
+  }
+  presets_dir.getChildFile(CACHE_FILE_NAME).replaceWithData(output.getData(), output.getDataSize());
+}
+
+void PresetIndex::publish(std::shared_ptr<const Entries> new_entries) {
+  {
+    std::lock_guard<std::mutex> lock(entries_mutex);
+    entries = std::move(new_entries);
+  }
+  ++version;
+}
@@ -0,0 +1,84 @@
+#pragma once
+
+#include <juce_core/juce_core.h>
+
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+
+#include "ParameterDefines.h"
+
+//==============================================================================
+// PresetIndex
+// an index of every preset file in a presets directory, for preset browsers
+//
+// a background thread scans the directory and reads each preset once. The
+// result is cached in a file in the same directory, and entries whose file
+// modification time hasn't changed are reused from the cache, so reopening
+// the plugin never re-reads the whole library. After the first scan the
+// thread only checks the directory's own modification time, which changes
+// when a preset is added, removed or renamed, and rescans (re-reading only
+// the files that were added or changed) when it moves or on refresh().
+//
+// readers get an immutable, name-sorted snapshot of the index, and can poll
+// get_version() to find out when there is a new one
+//==============================================================================
+class PresetIndex : private juce::Thread {
+public:
+  struct Entry {
+    juce::String name;
+    juce::File file;
+    juce::int64 modification_time;
+    // unnormalized value of every parameter, indexed by PARAM
+    std::array<float, TOTAL_NUMBER_PARAMETERS> values;
+  };
+  using Entries = std::vector<Entry>;
+
+  PresetIndex(const juce::File &presets_dir_, const juce::String &preset_extension_);
+  ~PresetIndex() override;
+
+  // starts the background scan, called from the message thread
+  void start();
+  // rescan now, e.g. after saving a preset or when a preset browser is shown.
+  // this also picks up presets edited in place, which the directory's
+  // modification time doesn't show
+  void refresh();
+
+  // the latest snapshot, sorted by name. Never null
+  std::shared_ptr<const Entries> get_entries() const;
+  // incremented every time a new snapshot is published
+  int get_version() const { return version.load(); }
+
+  // indices into entries of the presets whose name contains query (ignoring
+  // case), or starts with it if prefix_only is set. An empty query matches all
+  static std::vector<size_t> search(const Entries &entries, const juce::String &query,
+                                    bool prefix_only = false);
+
+  static inline const juce::String CACHE_FILE_NAME{".preset_index"};
+
+private:
+  void run() override;
+  void scan();
+  bool read_entry(const juce::File &file, Entry &entry) const;
+  void load_cache();
+  void save_cache(const Entries &entries) const;
+  void publish(std::shared_ptr<const Entries> new_entries);
+
+  const juce::File presets_dir;
+  const juce::String preset_extension;
+  // how often the directory's modification time is checked
+  static constexpr int POLL_INTERVAL_MS = 2000;
+  // the directory's modification time when the last scan started, scanning thread only
+  juce::int64 scanned_directory_time{0};
+
+  std::unordered_map<juce::String, size_t> param_ids_by_name;
+  // entries from the cache file or the previous scan, by full path. Only
+  // touched by the scanning thread
+  std::unordered_map<juce::String, Entry> known_entries;
+
+  mutable std::mutex entries_mutex;
+  std::shared_ptr<const Entries> entries;
+  std::atomic<int> version{0};
+
+  JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(PresetIndex)
+};
@@ -0,0 +1,91 @@
+#include "PresetLoader.h"
+#include "StateFormat.h"
+#include "StateManager.h"
+
+PresetLoader::PresetLoader(StateManager &state_) : state(state_) {}
+
+PresetLoader::~PresetLoader() { worker.removeAllJobs(true, 4000); }
+
+// called from the message thread
+void PresetLoader::load_async(std::shared_ptr<const PresetIndex::Entries> order, size_t index) {
+  if (order == nullptr || index >= order->size()) return;
+  const auto &entry = (*order)[index];
+  request(entry.file, entry.modification_time, true);
+
+  // the neighbours are queued after the requested preset, so they never delay it
+  if (index > 0) request((*order)[index - 1].file, (*order)[index - 1].modification_time, false);
+  if (index + 1 < order->size())
+    request((*order)[index + 1].file, (*order)[index + 1].modification_time, false);
+}
+
+// called from the message thread
+void PresetLoader::load_async(const juce::File &file) { request(file, 0, true); }
+
+void PresetLoader::request(const juce::File &file, juce::int64 modification_time,
+                           bool should_apply) {
+  const int request_id = should_apply ? ++latest_request : 0;
+  // the prefetches and loads still queued were for the previous preset, drop
+  // them so this one (and its neighbours) don't wait behind them. a job that
+  // is already running finishes, and apply() skips it if it was a load
+  if (should_apply) worker.removeAllJobs(false, 0);
+
+  if (modification_time != 0) {
+    auto cached = find_cached(file, modification_time);
+    if (cached.isValid()) {
+      // already decoded, no need to touch the disk
+      if (should_apply) apply(cached, request_id);
+      return;
+    }
+  }
+
+  juce::WeakReference<PresetLoader> weak_this(this);
+  worker.addJob([this, weak_this, file, modification_time, should_apply, request_id]() {
+    // skip loads that a newer request has already replaced
+    if (should_apply && request_id != latest_request.load()) return;
+
+    // cached under the index's time when there is one, which is what request()
+    // looks up on the message thread, or the file's own time otherwise
+    const auto cache_time = modification_time != 0
+                                ? modification_time
+                                : file.getLastModificationTime().toMilliseconds();
+    auto decoded_state = find_cached(file, cache_time);
+    if (!decoded_state.isValid()) {
+      juce::MemoryBlock data;
+      if (!file.loadFileAsData(data)) return;
+      decoded_state = state_format::read(data.getData(), data.getSize());
+      if (!decoded_state.isValid()) return;
+      add_to_cache({file, cache_time, decoded_state});
+    }
+
+    if (should_apply) {
+      juce::MessageManager::callAsync([weak_this, decoded_state, request_id]() {
+        if (auto *loader = weak_this.get()) loader->apply(decoded_state, request_id);
+      });
+    }
+  });
+}
+
+juce::ValueTree PresetLoader::find_cached(const juce::File &file, juce::int64 modification_time) {
+  std::lock_guard<std::mutex> lock(cache_mutex);
+  for (auto it = cache.begin(); it != cache.end(); ++it) {
+    if (it->file == file && it->modification_time == modification_time) {
+      cache.splice(cache.begin(), cache, it);
+      return cache.front().state;
+    }
+  }
+  return {};
+}
+
+void PresetLoader::add_to_cache(const Decoded &decoded) {
+  std::lock_guard<std::mutex> lock(cache_mutex);
+  cache.remove_if([&](const Decoded &d) { return d.file == decoded.file; });
+  cache.push_front(decoded);
+  if (cache.size() > CACHE_SIZE) cache.pop_back();
+}
+
+// called from the message thread
+void PresetLoader::apply(const juce::ValueTree &decoded_state, int request_id) {
+  if (request_id != latest_request.load()) return; // a newer preset was requested
+  // the cached tree is shared, and the APVTS keeps the tree it is given
+  state.load_from(decoded_state.createCopy());
+}
@@ -0,0 +1,63 @@
+#pragma once
+
+class StateManager;
+
+#include <juce_events/juce_events.h>
+
+#include <list>
+#include <mutex>
+
+#include "PresetIndex.h"
+
+//==============================================================================
+// PresetLoader
+// loads presets without blocking the message thread.
+// file I/O and parsing happen on a worker thread, then the decoded state is
+// applied on the message thread in one step (StateManager::load_from)
+//
+// when loading from a preset browser, the presets before and after the loaded
+// one (in the browser's order) are decoded ahead of time into a small LRU
+// cache, so stepping through presets with the arrow keys never waits on disk
+//
+// only the latest request is applied, so stepping quickly through slow files
+// never applies stale presets out of order, and a new request drops the loads
+// and prefetches still queued for the previous ones
+//==============================================================================
+class PresetLoader {
+public:
+  explicit PresetLoader(StateManager &state_);
+  ~PresetLoader();
+
+  // called from the message thread
+  // load order[index], and prefetch order[index - 1] and order[index + 1]
+  void load_async(std::shared_ptr<const PresetIndex::Entries> order, size_t index);
+  // load a preset file that might not be in the index
+  void load_async(const juce::File &file);
+
+  // number of decoded presets kept around
+  static constexpr size_t CACHE_SIZE = 8;
+
+private:
+  struct Decoded {
+    juce::File file;
+    juce::int64 modification_time;
+    juce::ValueTree state;
+  };
+
+  // modification_time is 0 if unknown, which always reads the file
+  void request(const juce::File &file, juce::int64 modification_time, bool apply);
+  juce::ValueTree find_cached(const juce::File &file, juce::int64 modification_time);
+  void add_to_cache(const Decoded &decoded);
+  void apply(const juce::ValueTree &decoded_state, int request_id);
+
+  StateManager &state;
+  juce::ThreadPool worker{1};
+
+  std::mutex cache_mutex;
+  std::list<Decoded> cache; // most recently used first
+
+  std::atomic<int> latest_request{0};
+
+  JUCE_DECLARE_WEAK_REFERENCEABLE(PresetLoader)
+  JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(PresetLoader)
+};
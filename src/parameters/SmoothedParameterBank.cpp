@@ -0,0 +1,80 @@
+#include "SmoothedParameterBank.h"
+#include "../Util/Util.h"
+#include "AutomationEvents.h"
+
+SmoothedParameterBank::SmoothedParameterBank() {
+  for (size_t p_id = 0; p_id < TOTAL_NUMBER_PARAMETERS; ++p_id) {
+    if (PARAMETER_SMOOTHING[p_id] > 0.0f) {
+      const auto &range = PARAMETER_RANGES[p_id];
+      converged_thresholds[num_smoothed] = 1e-6f * (range.end - range.start);
+      smoothed_states[num_smoothed] = double(PARAMETER_DEFAULTS[p_id]);
+      smoothed_ids[num_smoothed++] = p_id;
+    }
+    values[p_id] = PARAMETER_DEFAULTS[p_id];
+  }
+}
+
+// called from prepareToPlay
+void SmoothedParameterBank::prepare(double sample_rate, int max_block_size_) {
+  max_block_size = std::max(1, max_block_size_);
+  const auto row = size_t(max_block_size);
+  ramp_buffer.assign(num_smoothed * row, 0.0f);
+  pole_powers.assign(num_smoothed * row, 0.0f);
+
+  for (size_t k = 0; k < num_smoothed; ++k) {
+    const float pole = nthn_utils::tau2pole(PARAMETER_SMOOTHING[smoothed_ids[k]], float(sample_rate));
+    // accumulate in double, so long blocks don't drift
+    double power = 1.0;
+    for (size_t i = 0; i < row; ++i) {
+      power *= double(pole);
+      pole_powers[k * row + i] = float(power);
+    }
+  }
+  ramps.fill(nullptr);
+}
+
+// called from the audio thread
+void SmoothedParameterBank::snap(const BlockAutomation &automation) {
+  for (size_t p_id = 0; p_id < TOTAL_NUMBER_PARAMETERS; ++p_id)
+    values[p_id] = automation.value(p_id);
+  for (size_t k = 0; k < num_smoothed; ++k)
+    smoothed_states[k] = double(values[smoothed_ids[k]]);
+  ramps.fill(nullptr);
+}
+
+// called from the audio thread
+void SmoothedParameterBank::process(const BlockAutomation &automation, int numSamples) {
+  jassert(numSamples > 0 && numSamples <= max_block_size);
+  const auto row = size_t(max_block_size);
+
+  // unsmoothed parameters follow their target directly. This is a handful of
+  // copies, cheaper than branching on which parameters are smoothed
+  for (size_t p_id = 0; p_id < TOTAL_NUMBER_PARAMETERS; ++p_id)
+    values[p_id] = automation.value(p_id);
+  ramps.fill(nullptr);
+
+  for (size_t k = 0; k < num_smoothed; ++k) {
+    const auto p_id = smoothed_ids[k];
+    const float target = values[p_id];
+    // a snap command jumps straight to the target
+    if (automation.snapped(p_id)) smoothed_states[k] = double(target);
+    const double delta = smoothed_states[k] - double(target);
+    if (std::abs(delta) <= double(converged_thresholds[k])) {
+      // converged, skip
+      smoothed_states[k] = double(target);
+      continue;
+    }
+
+    float *ramp = ramp_buffer.data() + k * row;
+    const float *powers = pole_powers.data() + k * row;
+    const float delta_f = float(delta);
+    for (int i = 0; i < numSamples; ++i)
+      ramp[i] = target + delta_f * powers[i];
+
+    // the state is kept in double, so tiny steps near the target don't round
+    // away and stall the smoother short of its threshold
+    smoothed_states[k] = double(target) + delta * double(powers[numSamples - 1]);
+    values[p_id] = ramp[numSamples - 1];
+    ramps[p_id] = ramp;
+  }
+}
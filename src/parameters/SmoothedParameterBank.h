@@ -0,0 +1,58 @@
+#pragma once
+
+class BlockAutomation;
+
+#include <juce_core/juce_core.h>
+
+#include "ParameterDefines.h"
+
+//==============================================================================
+// SmoothedParameterBank
+// smooths every parameter with a SMOOTHING time in parameters.csv, so
+// processors don't each need their own per-sample IIR.
+//
+// process() is called once per (sub-)block and writes one contiguous ramp per
+// smoothed parameter. Each smoother is a one-pole IIR towards a constant
+// target, so the ramp has the closed form
+//     ramp[i] = target + (start - target) * pole^(i + 1)
+// with the powers of each pole precomputed in prepare(). That makes every ramp
+// a single vectorisable pass instead of a serial recursion.
+// parameters that have converged to their target are skipped entirely, and
+// parameters set by a snap command (see AutomationEvents.h) jump to their target.
+//==============================================================================
+class SmoothedParameterBank {
+public:
+  SmoothedParameterBank();
+  // called from prepareToPlay, allocates the ramp buffers
+  void prepare(double sample_rate, int max_block_size_);
+
+  // called from the audio thread
+  // jump every smoother to its target, e.g. when should_snap_smoothed_params is set
+  void snap(const BlockAutomation &automation);
+  // advance every smoother towards its target, numSamples <= max_block_size
+  void process(const BlockAutomation &automation, int numSamples);
+
+  // the ramp for the last process() call, or nullptr if the parameter was
+  // constant over that block (not smoothed, or converged). Use value() then
+  const float *ramp(size_t param_id) const { return ramps[param_id]; }
+  // the value at the end of the last process() call
+  float value(size_t param_id) const { return values[param_id]; }
+
+private:
+  std::array<size_t, TOTAL_NUMBER_PARAMETERS> smoothed_ids{};
+  size_t num_smoothed{0};
+  int max_block_size{0};
+
+  // num_smoothed * max_block_size, one contiguous row per smoothed parameter
+  std::vector<float> ramp_buffer;
+  std::vector<float> pole_powers;
+  // smoother outputs, indexed like smoothed_ids
+  std::array<double, TOTAL_NUMBER_PARAMETERS> smoothed_states{};
+  // below this distance to the target, a smoother snaps to it, indexed like smoothed_ids
+  std::array<float, TOTAL_NUMBER_PARAMETERS> converged_thresholds{};
+
+  std::array<const float *, TOTAL_NUMBER_PARAMETERS> ramps{};
+  std::array<float, TOTAL_NUMBER_PARAMETERS> values{};
+
+  JUCE_DECLARE_NON_COPYABLE(SmoothedParameterBank)
+};
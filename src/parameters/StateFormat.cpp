@@ -0,0 +1,153 @@
+#include "StateFormat.h"
+#include "StateManager.h"
+
+namespace state_format {
+namespace {
+const juce::Identifier PARAM_TYPE{"PARAM"};
+const juce::Identifier PARAM_ID_PROPERTY{"id"};
+const juce::Identifier PARAM_VALUE_PROPERTY{"value"};
+
+void write_section(juce::OutputStream &output, Section section,
+                   const juce::MemoryOutputStream &payload) {
+  output.writeInt(int(section));
+  output.writeInt(int(payload.getDataSize()));
+  output.write(payload.getData(), payload.getDataSize());
+}
+
+void write_values(juce::MemoryOutputStream &payload,
+                  const std::array<float, TOTAL_NUMBER_PARAMETERS> &values, bool automatable) {
+  juce::uint32 count = 0;
+  for (size_t p_id = 0; p_id < TOTAL_NUMBER_PARAMETERS; ++p_id)
+    count += PARAMETER_AUTOMATABLE[p_id] == automatable ? 1 : 0;
+  payload.writeInt(int(count));
+  for (size_t p_id = 0; p_id < TOTAL_NUMBER_PARAMETERS; ++p_id) {
+    if (PARAMETER_AUTOMATABLE[p_id] != automatable) continue;
+    const auto name = PARAMETER_NAMES[p_id];
+    const auto name_size = std::min(name.size(), size_t(255));
+    payload.writeByte(char(name_size));
+    payload.write(name.data(), name_size);
+    payload.writeFloat(values[p_id]);
+  }
+}
+
+// reads "u8 size, utf8" style strings, returns false on truncated data
+bool read_string(juce::MemoryInputStream &input, size_t size, juce::String &result) {
+  if (input.getNumBytesRemaining() < juce::int64(size)) return false;
+  auto start = static_cast<const char *>(input.getData()) + input.getPosition();
+  result = juce::String::fromUTF8(start, int(size));
+  input.skipNextBytes(juce::int64(size));
+  return true;
+}
+
+bool read_values(juce::MemoryInputStream &input, juce::ValueTree &parameters,
+                 juce::ValueTree &properties, bool automatable) {
+  const auto count = juce::uint32(input.readInt());
+  juce::String name;
+  for (juce::uint32 i = 0; i < count; ++i) {
+    if (input.getNumBytesRemaining() < 1) return false;
+    if (!read_string(input, size_t(juce::uint8(input.readByte())), name)) return false;
+    if (input.getNumBytesRemaining() < 4) return false;
+    const float value = input.readFloat();
+    if (automatable) {
+      juce::ValueTree param(PARAM_TYPE);
+      param.setProperty(PARAM_ID_PROPERTY, name, nullptr);
+      param.setProperty(PARAM_VALUE_PROPERTY, value, nullptr);
+      parameters.appendChild(param, nullptr);
+    } else {
+      properties.setProperty(juce::Identifier(name), value, nullptr);
+    }
+  }
+  return true;
+}
+
+juce::ValueTree read_binary(const void *data, size_t size_in_bytes) {
+  juce::MemoryInputStream input(data, size_in_bytes, false);
+  input.readInt(); // magic
+  const auto version = juce::uint32(input.readInt());
+  if (version > VERSION) DBG("state_format: reading a newer version, skipping unknown sections");
+
+  juce::ValueTree parameters(StateManager::PARAMETERS_ID);
+  juce::ValueTree properties(StateManager::PROPERTIES_ID);
+  juce::ValueTree preset(StateManager::PRESET_ID);
+
+  while (input.getNumBytesRemaining() >= 8) {
+    const auto section = juce::uint32(input.readInt());
+    const auto section_size = juce::int64(juce::uint32(input.readInt()));
+    if (input.getNumBytesRemaining() < section_size) return {};
+    const auto section_end = input.getPosition() + section_size;
+
+    bool ok = true;
+    switch (section) {
+    case PARAMETERS:
+      ok = read_values(input, parameters, properties, true);
+      break;
+    case PROPERTIES:
+      ok = read_values(input, parameters, properties, false);
+      break;
+    case PRESET: {
+      juce::String name;
+      ok = input.getNumBytesRemaining() >= 2 &&
+           read_string(input, size_t(juce::uint16(input.readShort())), name) &&
+           input.getNumBytesRemaining() >= 1;
+      if (ok) {
+        preset.setProperty(StateManager::PRESET_NAME_ID, name, nullptr);
+        preset.setProperty(StateManager::PRESET_MODIFIED_ID, input.readByte() != 0, nullptr);
+      }
+      break;
+    }
+    default:
+      break; // unknown section, from a newer version
+    }
+    if (!ok || input.getPosition() > section_end) return {};
+    input.setPosition(section_end);
+  }
+
+  juce::ValueTree state(StateManager::STATE_ID);
+  state.appendChild(parameters, nullptr);
+  state.appendChild(properties, nullptr);
+  state.appendChild(preset, nullptr);
+  return state;
+}
+} // namespace
+
+void write(juce::OutputStream &output, const std::array<float, TOTAL_NUMBER_PARAMETERS> &values,
+           const juce::String &preset_name, bool preset_modified) {
+  output.writeInt(int(MAGIC));
+  output.writeInt(int(VERSION));
+
+  juce::MemoryOutputStream payload;
+  write_values(payload, values, true);
+  write_section(output, PARAMETERS, payload);
+
+  payload.reset();
+  write_values(payload, values, false);
+  write_section(output, PROPERTIES, payload);
+
+  payload.reset();
+  const auto name = preset_name.toRawUTF8();
+  const auto name_size = std::min(std::strlen(name), size_t(65535));
+  payload.writeShort(short(name_size));
+  payload.write(name, name_size);
+  payload.writeByte(preset_modified ? 1 : 0);
+  write_section(output, PRESET, payload);
+}
+
+bool is_binary(const void *data, size_t size_in_bytes) {
+  return size_in_bytes >= 8 &&
+         juce::ByteOrder::littleEndianInt(data) == MAGIC;
+}
+
+juce::ValueTree read(const void *data, size_t size_in_bytes) {
+  if (data == nullptr || size_in_bytes == 0) return {};
+  if (is_binary(data, size_in_bytes)) return read_binary(data, size_in_bytes);
+
+  // older formats are XML, either from copyXmlToBinary or plain text
+  std::unique_ptr<juce::XmlElement> xml(
+      juce::AudioProcessor::getXmlFromBinary(data, int(size_in_bytes)));
+  if (xml == nullptr)
+    xml = juce::parseXML(juce::String::fromUTF8(static_cast<const char *>(data),
+                                                int(size_in_bytes)));
+  if (xml == nullptr || !xml->hasTagName(StateManager::STATE_ID)) return {};
+  return juce::ValueTree::fromXml(*xml);
+}
+} // namespace state_format
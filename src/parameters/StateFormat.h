@@ -0,0 +1,43 @@
+#pragma once
+
+#include <juce_audio_processors/juce_audio_processors.h>
+#include <juce_core/juce_core.h>
+
+#include "ParameterDefines.h"
+
+//==============================================================================
+// StateFormat
+// compact, versioned binary format for plugin state and presets
+//
+//   u32 magic, u32 version
+//   then any number of sections: u32 section id, u32 payload size, payload
+//
+//   PARAMETERS / PROPERTIES payload:
+//       u32 count, then per entry: u8 name size, name (utf8), f32 value
+//   PRESET payload:
+//       u16 name size, name (utf8), u8 modified
+//
+// all integers and floats are little endian. Readers skip sections they don't
+// know, so later versions can add sections without breaking old builds.
+//
+// read() also accepts the older formats, XML from copyXmlToBinary (host state)
+// and XML text (preset files), and always returns a STATE ValueTree shaped like
+// StateManager::get_state(), so loading never goes through an XmlElement for
+// binary data
+//==============================================================================
+namespace state_format {
+constexpr juce::uint32 MAGIC = 0x5348544e; // "NTHS"
+constexpr juce::uint32 VERSION = 1;
+
+enum Section : juce::uint32 { PARAMETERS = 1, PROPERTIES = 2, PRESET = 3 };
+
+// values holds one (unnormalized) value per PARAM
+void write(juce::OutputStream &output,
+           const std::array<float, TOTAL_NUMBER_PARAMETERS> &values,
+           const juce::String &preset_name, bool preset_modified);
+
+bool is_binary(const void *data, size_t size_in_bytes);
+
+// returns an invalid ValueTree if data is not a state in any known format
+juce::ValueTree read(const void *data, size_t size_in_bytes);
+} // namespace state_format
@@ -1,6 +1,9 @@
 // Nathan Blair January 2023
 
 #include "StateManager.h"
+#include "PresetIndex.h"
+#include "PresetLoader.h"
+#include "StateFormat.h"
 #include "../plugin/PluginProcessor.h"
 #include "../plugin/ProjectInfo.h"
 #include <cassert>
@@ -21,55 +24,37 @@ StateManager::StateManager(PluginProcessor *proc)
   for (size_t p_id = 0; p_id < PARAM::TOTAL_NUMBER_PARAMETERS; ++p_id) {
     if (PARAMETER_AUTOMATABLE[p_id]) {
       params.push_back(std::make_unique<juce::AudioParameterFloat>(
-          juce::ParameterID{PARAMETER_NAMES[p_id], ProjectInfo::versionNumber}, // parameter ID
-          PARAMETER_NICKNAMES[p_id],                                            // parameter name
-          PARAMETER_RANGES[p_id],                                               // range
-          PARAMETER_DEFAULTS[p_id],                                             // default value
+          // parameter ID
+          juce::ParameterID{parameter_objects::name(p_id), ProjectInfo::versionNumber},
+          parameter_objects::nickname(p_id), // parameter name
+          parameter_objects::range(p_id),    // range
+          PARAMETER_DEFAULTS[p_id],          // default value
           "", // parameter label (description?)
           juce::AudioProcessorParameter::Category::genericParameter,
-          [p_id](float value,
-                 int maximumStringLength) { // Float to String Precision 2 Digits
-            auto to_string_size = PARAMETER_TO_STRING_ARRS[p_id].size();
-            juce::String res;
-            if (to_string_size > 0 && (unsigned int)value < to_string_size) {
-              res = PARAMETER_TO_STRING_ARRS[p_id][(unsigned long)(value)];
-            } else {
-              std::stringstream ss;
-              ss << std::fixed << std::setprecision(2) << value;
-              res = juce::String(ss.str());
-            }
-            auto output = (res + " " + PARAMETER_SUFFIXES[p_id]);
-            return maximumStringLength > 0 ? output.substring(0, maximumStringLength) : output;
+          [this, p_id](float value, int maximumStringLength) {
+            return parameter_text.to_text(p_id, value, maximumStringLength);
           },
-          [p_id](juce::String text) {
-            text = text.upToFirstOccurrenceOf(" " + PARAMETER_SUFFIXES[p_id], false, true);
-            auto to_string_size = PARAMETER_TO_STRING_ARRS[p_id].size();
-            if (to_string_size > 0) {
-              auto beg = PARAMETER_TO_STRING_ARRS[p_id].begin();
-              auto end = PARAMETER_TO_STRING_ARRS[p_id].end();
-              auto it = std::find(beg, end, text);
-              if (it == end) {
-                DBG("ERROR: Could not find text in PARAMETER_TO_STRING_ARRS");
-                return text.getFloatValue();
-              }
-              return float(it - beg);
-            }
-            return text.getFloatValue(); // Convert Back to Value
-          }));
+          [this, p_id](const juce::String &text) { return parameter_text.to_value(p_id, text); }));
     } else {
-      property_tree.setProperty(PARAMETER_IDS[p_id], PARAMETER_DEFAULTS[p_id], nullptr);
-      property_atomics[PARAMETER_NAMES[p_id]].store(PARAMETER_DEFAULTS[p_id]);
+      property_tree.setProperty(parameter_objects::identifier(p_id), PARAMETER_DEFAULTS[p_id],
+                              nullptr);
     }
-    parameter_modified_flags[PARAMETER_NAMES[p_id]].store(false);
+    param_values[p_id].store(PARAMETER_DEFAULTS[p_id]);
+    param_ids_by_name[parameter_objects::name(p_id)] = p_id;
   }
 
   param_tree_ptr.reset(new juce::AudioProcessorValueTreeState(*proc, &undo_manager, PARAMETERS_ID,
                                                               {params.begin(), params.end()}));
   property_tree.addListener(this);
 
+  // the parameters' changes are mirrored into param_values by parameterValueChanged
   for (size_t p_id = 0; p_id < PARAM::TOTAL_NUMBER_PARAMETERS; ++p_id) {
     if (PARAMETER_AUTOMATABLE[p_id]) {
-      param_tree_ptr->addParameterListener(PARAMETER_NAMES[p_id], this);
+      auto parameter = get_parameter(p_id);
+      param_ids_by_host_index[size_t(parameter->getParameterIndex())] = p_id;
+      parameter->addListener(this);
+      // the same value as the APVTS's raw value
+      param_values[p_id].store(parameter->convertFrom0to1(parameter->getValue()));
     }
   }
 
@@ -78,35 +63,71 @@ StateManager::StateManager(PluginProcessor *proc)
   //==============================================================================
   preset_tree = juce::ValueTree(PRESET_ID);
   preset_tree.setProperty(PRESET_NAME_ID, DEFAULT_PRESET, nullptr);
+  // listen to preset edits (and their undo/redo), to know when the state snapshot is stale
+  preset_tree.addListener(this);
 }
 
 StateManager::~StateManager() {
   property_tree.removeListener(this);
+  preset_tree.removeListener(this);
   for (size_t p_id = 0; p_id < PARAM::TOTAL_NUMBER_PARAMETERS; ++p_id) {
     if (PARAMETER_AUTOMATABLE[p_id]) {
-      param_tree_ptr->removeParameterListener(PARAMETER_NAMES[p_id], this);
+      get_parameter(p_id)->removeListener(this);
     }
   }
 }
 
-// called from any thread
-float StateManager::param_value(size_t param_id) {
-  // returns the parameter value of a certain ID in a thread safe way
-  if (PARAMETER_AUTOMATABLE[param_id]) {
-    return param_tree_ptr->getRawParameterValue(PARAMETER_NAMES[param_id])->load();
-  } else {
-    return property_atomics[PARAMETER_NAMES[param_id]].load();
+// called from non-realtime thread
+juce::ValueTree StateManager::get_state() {
+  // a copy, so callers are free to modify it
+  return get_state_snapshot()->tree.createCopy();
+}
+
+// called from non-realtime thread
+void StateManager::write_state(juce::MemoryBlock &dest_data) {
+  dest_data = get_state_snapshot()->binary;
+}
+
+// called from non-realtime thread
+std::shared_ptr<const StateManager::StateSnapshot> StateManager::get_state_snapshot() {
+  if (!state_dirty.load()) {
+    const juce::SpinLock::ScopedLockType lock(snapshot_lock);
+    if (state_snapshot != nullptr) return state_snapshot;
+  }
+
+  std::lock_guard<decltype(snapshot_rebuild_mutex)> rebuild_lock(snapshot_rebuild_mutex);
+  // clear the flag before reading, so edits made during the rebuild mark the
+  // new snapshot as dirty again
+  if (state_dirty.exchange(false) || state_snapshot == nullptr) {
+    auto snapshot = std::make_shared<StateSnapshot>();
+    serialize_state(snapshot->binary);
+    // the tree is decoded from the blob, so both always describe the same state
+    snapshot->tree = state_format::read(snapshot->binary.getData(), snapshot->binary.getSize());
+
+    const juce::SpinLock::ScopedLockType lock(snapshot_lock);
+    state_snapshot = std::move(snapshot);
   }
+  const juce::SpinLock::ScopedLockType lock(snapshot_lock);
+  return state_snapshot;
 }
 
 // called from non-realtime thread
-juce::ValueTree StateManager::get_state() {
-  std::unique_lock<std::shared_mutex> lock(state_mutex);
-  state_tree = juce::ValueTree(STATE_ID);
-  state_tree.appendChild(param_tree_ptr->copyState(), nullptr);
-  state_tree.appendChild(property_tree.createCopy(), nullptr);
-  state_tree.appendChild(preset_tree.createCopy(), nullptr);
-  return state_tree;
+void StateManager::serialize_state(juce::MemoryBlock &dest_data) {
+  // read straight from the parameter store, no ValueTree or XML in between
+  std::array<float, TOTAL_NUMBER_PARAMETERS> values;
+  for (size_t p_id = 0; p_id < TOTAL_NUMBER_PARAMETERS; ++p_id)
+    values[p_id] = param_value(p_id);
+
+  juce::String preset_name;
+  bool is_preset_modified;
+  {
+    std::shared_lock<StateMutex> lock(state_mutex);
+    preset_name = preset_tree.getProperty(PRESET_NAME_ID).toString();
+    is_preset_modified = bool(preset_tree.getProperty(PRESET_MODIFIED_ID));
+  }
+
+  juce::MemoryOutputStream output(dest_data, false);
+  state_format::write(output, values, preset_name, is_preset_modified);
 }
 
 // called from message thread
@@ -126,38 +147,73 @@ void StateManager::save_preset(juce::String preset_name) {
     file.create();
   }
 
-  auto plugin_state = get_state();
+  juce::MemoryBlock plugin_state;
+  write_state(plugin_state);
 
-  std::unique_ptr<juce::XmlElement> xml(plugin_state.createXml());
   auto temp = juce::File::createTempFile("preset_temp");
-  xml->writeTo(temp);
+  temp.replaceWithData(plugin_state.getData(), plugin_state.getSize());
   temp.replaceFileIn(file);
+
+  if (preset_index != nullptr) preset_index->refresh();
 }
 
 // called from message thread (technically any non-realtime thread)
 void StateManager::load_preset(juce::String preset_name) {
   auto file = PRESETS_DIR.getChildFile(preset_name).withFileExtension(PRESET_EXTENSION);
-  if (file.existsAsFile()) {
-    std::unique_ptr<juce::XmlElement> xmlState = juce::XmlDocument::parse(file);
-    load_from(xmlState.get());
+  juce::MemoryBlock data;
+  if (file.existsAsFile() && file.loadFileAsData(data)) {
+    // binary and XML preset files are both accepted
+    load_from(data.getData(), data.getSize());
   }
 }
 
+// called from message thread
+void StateManager::load_preset_async(juce::String preset_name) {
+  get_preset_loader().load_async(
+      PRESETS_DIR.getChildFile(preset_name).withFileExtension(PRESET_EXTENSION));
+}
+
 // called from non-realtime thread
 void StateManager::load_from(juce::XmlElement *xml) {
+  if (xml != nullptr && xml->hasTagName(STATE_ID)) {
+    load_from(juce::ValueTree::fromXml(*xml));
+  }
+}
 
-  if (xml != nullptr) {
-    if (xml->hasTagName(STATE_ID)) {
-      auto new_tree = juce::ValueTree::fromXml(*xml);
-      param_tree_ptr->replaceState(new_tree.getChildWithName(PARAMETERS_ID));
-      std::unique_lock<std::shared_mutex> lock(state_mutex);
-      property_tree.copyPropertiesFrom(new_tree.getChildWithName(PROPERTIES_ID), &undo_manager);
-      preset_tree.copyPropertiesFrom(new_tree.getChildWithName(PRESET_ID), &undo_manager);
-      preset_modified.store(false);
-    }
+// called from non-realtime thread
+void StateManager::load_from(const void *data, size_t size_in_bytes) {
+  auto new_tree = state_format::read(data, size_in_bytes);
+  if (new_tree.isValid()) {
+    load_from(new_tree);
   }
 }
 
+// called from non-realtime thread
+void StateManager::load_from(const juce::ValueTree &new_tree) {
+  if (new_tree.hasType(STATE_ID)) {
+    param_tree_ptr->replaceState(new_tree.getChildWithName(PARAMETERS_ID));
+    std::unique_lock<StateMutex> lock(state_mutex);
+    property_tree.copyPropertiesFrom(new_tree.getChildWithName(PROPERTIES_ID), &undo_manager);
+    preset_tree.copyPropertiesFrom(new_tree.getChildWithName(PRESET_ID), &undo_manager);
+    preset_modified.store(false);
+  }
+}
+
+// called from message thread
+PresetIndex &StateManager::get_preset_index() {
+  if (preset_index == nullptr) {
+    preset_index = std::make_unique<PresetIndex>(PRESETS_DIR, PRESET_EXTENSION);
+    preset_index->start();
+  }
+  return *preset_index;
+}
+
+// called from message thread
+PresetLoader &StateManager::get_preset_loader() {
+  if (preset_loader == nullptr) preset_loader = std::make_unique<PresetLoader>(*this);
+  return *preset_loader;
+}
+
 // called from message thread
 void StateManager::set_preset_name(juce::String preset_name) {
   thread_safe_set_value_tree_property(preset_tree, PRESET_NAME_ID, preset_name, &undo_manager);
@@ -165,7 +221,7 @@ void StateManager::set_preset_name(juce::String preset_name) {
 
 // called from message thread
 juce::String StateManager::get_preset_name() {
-  std::shared_lock<std::shared_mutex> lock(state_mutex);
+  std::shared_lock<StateMutex> lock(state_mutex);
   if (bool(preset_tree.getProperty(PRESET_MODIFIED_ID))) {
     return preset_tree.getProperty(PRESET_NAME_ID).toString() + "*";
   } else {
@@ -184,7 +240,17 @@ void StateManager::update_preset_modified() {
 
 // called from any thread
 bool StateManager::get_parameter_modified(size_t param_id, bool exchange_value) {
-  return parameter_modified_flags[PARAMETER_NAMES[param_id]].exchange(exchange_value);
+  const auto bit = std::uint64_t(1) << (param_id % 64);
+  auto &word = parameter_modified_flags[param_id / 64];
+  const auto previous = exchange_value ? word.fetch_or(bit) : word.fetch_and(~bit);
+  return (previous & bit) != 0;
+}
+
+// called from any thread
+void StateManager::mark_parameter_modified(size_t param_id) {
+  parameter_modified_flags[param_id / 64].fetch_or(std::uint64_t(1) << (param_id % 64));
+  // set after the flag, so the UI never sees any_parameter_changed without it
+  any_parameter_changed.store(true);
 }
 
 // called from message thread
@@ -196,7 +262,7 @@ void StateManager::redo() { undo_manager.redo(); }
 // called from the message thread
 juce::RangedAudioParameter *StateManager::get_parameter(size_t param_id) {
   assert(PARAMETER_AUTOMATABLE[param_id]);
-  return param_tree_ptr->getParameter(PARAMETER_NAMES[param_id]);
+  return param_tree_ptr->getParameter(parameter_objects::name(param_id));
 }
 
 // called from the message thread
@@ -219,12 +285,12 @@ void StateManager::end_change_gesture(size_t param_id) {
 // called from the message thread
 void StateManager::set_parameter(size_t param_id, float value) {
   if (PARAMETER_AUTOMATABLE[param_id]) {
-    auto range = PARAMETER_RANGES[param_id];
+    const auto &range = parameter_objects::range(param_id);
     auto normalized_value = range.convertTo0to1(range.snapToLegalValue(value));
     set_parameter_normalized(param_id, normalized_value);
   } else {
-    thread_safe_set_value_tree_property(property_tree, PARAMETER_IDS[param_id], value,
-                                        &undo_manager);
+    thread_safe_set_value_tree_property(property_tree, parameter_objects::identifier(param_id),
+                                        value, &undo_manager);
   }
 }
 
@@ -235,10 +301,20 @@ void StateManager::set_parameter_normalized(size_t param_id, float normalized_va
     auto parameter = get_parameter(param_id);
     parameter->setValueNotifyingHost(normalized_value);
   } else {
-    auto unnormalized_value = PARAMETER_RANGES[param_id].convertFrom0to1(normalized_value);
+    auto unnormalized_value = parameter_objects::range(param_id).convertFrom0to1(normalized_value);
     set_parameter(param_id, unnormalized_value);
   }
 }
+
+// called from the message thread
+void StateManager::snap_parameter(size_t param_id, float value) {
+  JUCE_ASSERT_MESSAGE_THREAD
+  // the change reaches push_automation_event() before set_parameter() returns
+  snapping = true;
+  set_parameter(param_id, value);
+  snapping = false;
+}
+
 // called from the message thread
 void StateManager::randomize_parameter(size_t param_id, float min, float max) {
   // min, max between 0 and 1
@@ -247,10 +323,69 @@ void StateManager::randomize_parameter(size_t param_id, float min, float max) {
   set_parameter_normalized(param_id, value);
 }
 
+// called from the message thread
+void StateManager::set_parameters(const std::array<float, TOTAL_NUMBER_PARAMETERS> &values,
+                                  const juce::String &transaction_name) {
+  JUCE_ASSERT_MESSAGE_THREAD
+  // only the parameters that change are touched
+  std::array<float, TOTAL_NUMBER_PARAMETERS> targets;
+  std::array<juce::RangedAudioParameter *, TOTAL_NUMBER_PARAMETERS> changed_parameters{};
+  std::array<bool, TOTAL_NUMBER_PARAMETERS> changed{};
+  bool any_changed = false;
+  for (size_t p_id = 0; p_id < TOTAL_NUMBER_PARAMETERS; ++p_id) {
+    const auto &range = parameter_objects::range(p_id);
+    targets[p_id] = range.snapToLegalValue(juce::jlimit(range.start, range.end, values[p_id]));
+    changed[p_id] = targets[p_id] != param_value(p_id);
+    any_changed = any_changed || changed[p_id];
+    if (changed[p_id] && PARAMETER_AUTOMATABLE[p_id])
+      changed_parameters[p_id] = get_parameter(p_id);
+  }
+  if (!any_changed) return;
+
+  undo_manager.beginNewTransaction(transaction_name);
+  // the host hears about every change inside one gesture
+  for (auto *parameter : changed_parameters)
+    if (parameter != nullptr) parameter->beginChangeGesture();
+  applying_parameter_set = true;
+  for (size_t p_id = 0; p_id < TOTAL_NUMBER_PARAMETERS; ++p_id) {
+    if (!changed[p_id]) continue;
+    if (auto *parameter = changed_parameters[p_id]) {
+      parameter->setValueNotifyingHost(
+          parameter_objects::range(p_id).convertTo0to1(targets[p_id]));
+    } else {
+      thread_safe_set_value_tree_property(property_tree, parameter_objects::identifier(p_id),
+                                          targets[p_id], &undo_manager);
+    }
+  }
+  applying_parameter_set = false;
+  for (auto *parameter : changed_parameters)
+    if (parameter != nullptr) parameter->endChangeGesture();
+
+  // the audio thread takes the whole set at once, at the start of a block.
+  // timestamped before the values are read: host changes stamped earlier are
+  // already in the set, the ones stamped later are applied on top of it
+  const auto set_ticks = juce::Time::getHighResolutionTicks();
+  auto &set = parameter_sets.write_buffer();
+  for (size_t p_id = 0; p_id < TOTAL_NUMBER_PARAMETERS; ++p_id)
+    set[p_id] = param_value(p_id);
+  parameter_sets.publish();
+  automation_commands.push({set_ticks, 0, 0.0f, AutomationEvent::Type::PARAMETER_SET});
+}
+
+// called from the message thread
+void StateManager::set_parameters_normalized(
+    const std::array<float, TOTAL_NUMBER_PARAMETERS> &normalized_values,
+    const juce::String &transaction_name) {
+  std::array<float, TOTAL_NUMBER_PARAMETERS> values;
+  for (size_t p_id = 0; p_id < TOTAL_NUMBER_PARAMETERS; ++p_id)
+    values[p_id] = parameter_objects::range(p_id).convertFrom0to1(
+        std::clamp(normalized_values[p_id], 0.0f, 1.0f));
+  set_parameters(values, transaction_name);
+}
+
 // called from the message thread
 juce::String StateManager::get_parameter_text(size_t param_id) {
-  return get_parameter(param_id)->getText(
-      PARAMETER_RANGES[param_id].convertTo0to1(param_value(param_id)), 20);
+  return parameter_text.to_text(param_id, param_value(param_id), 20);
 }
 
 // called from the message thread
@@ -260,9 +395,7 @@ void StateManager::reset_parameter(size_t param_id) {
 
 // called from the message thread
 void StateManager::init() {
-  for (size_t i = 0; i < PARAM::TOTAL_NUMBER_PARAMETERS; ++i) {
-    reset_parameter(i);
-  }
+  set_parameters(PARAMETER_DEFAULTS, "Init");
 
   // reset value trees
   set_preset_name(DEFAULT_PRESET);
@@ -270,40 +403,77 @@ void StateManager::init() {
   preset_modified.store(false);
 }
 
+// called from the message thread
 void StateManager::randomize_parameters() {
-
-  for (size_t i = 0; i < PARAM::TOTAL_NUMBER_PARAMETERS; ++i) {
-    randomize_parameter(i);
-  }
+  std::array<float, TOTAL_NUMBER_PARAMETERS> normalized_values;
+  for (auto &value : normalized_values)
+    value = rng.nextFloat();
+  set_parameters_normalized(normalized_values, "Randomize");
 }
 
 juce::UndoManager *StateManager::get_undo_manager() { return &undo_manager; }
 
 void StateManager::valueTreePropertyChanged(juce::ValueTree &treeWhosePropertyHasChanged,
                                             const juce::Identifier &property) {
-  // this will be polled by UI to update when UI changes
   if (treeWhosePropertyHasChanged != preset_tree) {
     preset_modified.store(true);
-    any_parameter_changed.store(true);
     if (treeWhosePropertyHasChanged == property_tree) {
       float changed_property_value;
       {
-        std::shared_lock<std::shared_mutex> lock(state_mutex);
+        std::shared_lock<StateMutex> lock(state_mutex);
         changed_property_value = float(property_tree.getProperty(property));
       }
-      property_atomics[property.toString()].store(changed_property_value);
-      parameter_modified_flags[property.toString()].store(true);
+      auto it = param_ids_by_name.find(property.toString());
+      if (it != param_ids_by_name.end()) {
+        param_values[it->second].store(changed_property_value);
+        push_automation_event(it->second, changed_property_value,
+                              AutomationEvent::Type::PROPERTY);
+        mark_parameter_modified(it->second);
+      }
     }
   }
+  // after the new value is stored, so a snapshot rebuilt as soon as this is
+  // seen reads the new value. polled by the snapshot and the UI
+  state_dirty.store(true);
 }
 
-void StateManager::parameterChanged(const juce::String &parameterID, float newValue) {
+void StateManager::parameterValueChanged(int parameterIndex, float newValue) {
   // parameter changed, note as modified
   // might be called from audio thread, so must be thread safe
+  const auto p_id = param_ids_by_host_index[size_t(parameterIndex)];
+  // newValue is normalized. snapped like the APVTS's raw value
+  const auto &range = parameter_objects::range(p_id);
+  const float value = range.snapToLegalValue(range.convertFrom0to1(newValue));
+  param_values[p_id].store(value);
+  state_dirty.store(true);
   preset_modified.store(true);
-  any_parameter_changed.store(true);
-  parameter_modified_flags[parameterID].store(true);
-  juce::ignoreUnused(newValue);
+  mark_parameter_modified(p_id);
+  push_automation_event(p_id, value, AutomationEvent::Type::PARAMETER);
+}
+
+void StateManager::parameterGestureChanged(int parameterIndex, bool gestureIsStarting) {
+  juce::ignoreUnused(parameterIndex, gestureIsStarting);
+}
+
+// called from any thread
+void StateManager::push_automation_event(size_t param_id, float value,
+                                         AutomationEvent::Type type) {
+  // changes made on the message thread (the UI, preset loads) are timestamped,
+  // so they keep their timing relative to each other when the audio thread
+  // applies them. the message thread is the only producer of automation_commands.
+  // changes from any other thread (host automation) are applied at the start
+  // of the next block: juce's wrappers call the listeners right before
+  // processBlock without the host's sample offset, so there is no timing to keep.
+  // they are still timestamped, to order them against parameter sets
+  const auto ticks = juce::Time::getHighResolutionTicks();
+  if (juce::MessageManager::existsAndIsCurrentThread()) {
+    // the whole set follows as one command
+    if (applying_parameter_set) return;
+    if (snapping) type = AutomationEvent::Type::SNAP;
+    automation_commands.push({ticks, param_id, value, type});
+  } else {
+    automation_events.push({ticks, param_id, value, type});
+  }
 }
 
 void StateManager::register_component(size_t param_id, juce::Component *component,
@@ -329,6 +499,6 @@ void StateManager::thread_safe_set_value_tree_property(juce::ValueTree tree,
                                                        const juce::Identifier &name,
                                                        const juce::var &new_value,
                                                        juce::UndoManager *undo_manager_) {
-  std::shared_lock<std::shared_mutex> lock(state_mutex);
+  std::shared_lock<StateMutex> lock(state_mutex);
   tree.setProperty(name, new_value, undo_manager_);
 }
\ No newline at end of file
@@ -3,13 +3,21 @@
 #pragma once
 
 class PluginProcessor;
+class PresetIndex;
+class PresetLoader;
 
+#include <mutex>
 #include <shared_mutex>
 
 #include <juce_audio_processors/juce_audio_processors.h>
 #include <juce_core/juce_core.h>
 
+#include "../Util/RealtimeSafety.h"
+#include "../Util/Util.h"
+#include "AutomationEvents.h"
 #include "ParameterDefines.h"
+#include "ParameterObjects.h"
+#include "ParameterText.h"
 
 /*
 StateManager manages Parameters, Properties, Presets
@@ -31,7 +39,7 @@ PRESET_NAME_ID
 */
 
 class StateManager : public juce::ValueTree::Listener,
-                     public juce::AudioProcessorValueTreeState::Listener {
+                     public juce::AudioProcessorParameter::Listener {
 public:
   StateManager(PluginProcessor *proc);
   ~StateManager() override;
@@ -44,9 +52,13 @@ public:
   // files that include the state manager
 
   // param_value is a thread safe/realtime safe method to be called on any
-  // thread
+  // thread. It is a single indexed atomic load from one contiguous table, so
+  // its cost does not depend on the number of parameters
   //--------------------------------------------------------------------------------
-  float param_value(size_t param_id);
+  float param_value(size_t param_id) const {
+    jassert(param_id < TOTAL_NUMBER_PARAMETERS);
+    return param_values[param_id].load();
+  }
 
   //--------------------------------------------------------------------------------
   // You can also use these methods from the UI thread to access parameters
@@ -62,7 +74,19 @@ public:
   void end_change_gesture(size_t param_id);
   void set_parameter(size_t param_id, float value);
   void set_parameter_normalized(size_t param_id, float normalized_value);
+  // like set_parameter, but the audio thread jumps straight to the new value
+  // instead of smoothing towards it
+  void snap_parameter(size_t param_id, float value);
   void randomize_parameter(size_t param_id, float min = 0.0f, float max = 1.0f);
+  // set every parameter and property at once, from one value per PARAM, as a
+  // single undo transaction. only the parameters that change are sent to the
+  // host, all inside one gesture, and the audio thread picks up the whole set
+  // at the start of one block instead of one change at a time
+  void set_parameters(const std::array<float, TOTAL_NUMBER_PARAMETERS> &values,
+                      const juce::String &transaction_name = {});
+  void set_parameters_normalized(
+      const std::array<float, TOTAL_NUMBER_PARAMETERS> &normalized_values,
+      const juce::String &transaction_name = {});
   void reset_parameter(size_t param_id);
   void init();
   void randomize_parameters();
@@ -76,6 +100,25 @@ public:
   //--------------------------------------------------------------------------------
   juce::ValueTree get_state();
 
+  //--------------------------------------------------------------------------------
+  // The same state in the compact binary format from StateFormat.h
+  // used for getStateInformation and preset files, called from any non-realtime thread
+  //--------------------------------------------------------------------------------
+  void write_state(juce::MemoryBlock &dest_data);
+
+  //--------------------------------------------------------------------------------
+  // get_state() and write_state() both read from an immutable snapshot of the
+  // state, which is only rebuilt after a parameter, property or preset edit.
+  // Grabbing the snapshot never blocks the threads making edits, and repeated
+  // saves with no edits in between reuse the same serialized blob
+  // don't modify the tree in a snapshot, it is shared
+  //--------------------------------------------------------------------------------
+  struct StateSnapshot {
+    juce::MemoryBlock binary;
+    juce::ValueTree tree;
+  };
+  std::shared_ptr<const StateSnapshot> get_state_snapshot();
+
   //----------------------------------------x----------------------------------------
   // Saving and Loading Presets, called from UI thread
   // preset_modified is true when any parameter has been changed, after loading
@@ -83,11 +126,38 @@ public:
   //--------------------------------------------------------------------------------
   void save_preset(juce::String preset_name);
   void load_preset(juce::String preset_name);
+  // reads and parses on a worker thread, then applies on the message thread
+  // use get_preset_loader() to load from a preset browser with prefetching
+  void load_preset_async(juce::String preset_name);
   void load_from(juce::XmlElement *xml);
+  // binary state, or XML from older versions (detected automatically)
+  void load_from(const void *data, size_t size_in_bytes);
+  // a STATE tree, as returned by get_state()
+  void load_from(const juce::ValueTree &new_tree);
   void set_preset_name(juce::String preset_name);
   juce::String get_preset_name();
   void update_preset_modified();
   bool get_parameter_modified(size_t param_id, bool exchange_value = false);
+  // calls fn(param_id) for every parameter modified since the last call, and
+  // clears those flags. Costs one atomic exchange per 64 parameters plus one
+  // iteration per modified parameter, called from the message thread
+  template <typename Fn> void for_each_modified_parameter(Fn &&fn) {
+    for (size_t word = 0; word < MODIFIED_FLAG_WORDS; ++word) {
+      auto bits = parameter_modified_flags[word].exchange(0);
+      while (bits != 0) {
+        fn(word * 64 + size_t(nthn_utils::count_trailing_zeros(bits)));
+        bits &= bits - 1; // clear lowest set bit
+      }
+    }
+  }
+
+  //--------------------------------------------------------------------------------
+  // index of every preset in PRESETS_DIR, scanned on a background thread
+  // use this for preset browsers instead of walking PRESETS_DIR yourself
+  // the scan starts on the first call, called from the message thread
+  //--------------------------------------------------------------------------------
+  PresetIndex &get_preset_index();
+  PresetLoader &get_preset_loader();
 
   //--------------------------------------------------------------------------------
   // a single UndoManager is shared by all ValueTrees
@@ -101,7 +171,8 @@ public:
   //--------------------------------------------------------------------------------
   void valueTreePropertyChanged(juce::ValueTree &treeWhosePropertyHasChanged,
                                 const juce::Identifier &property) override;
-  void parameterChanged(const juce::String &parameterID, float newValue) override;
+  void parameterValueChanged(int parameterIndex, float newValue) override;
+  void parameterGestureChanged(int parameterIndex, bool gestureIsStarting) override;
 
   //--------------------------------------------------------------------------------
   // each component registers itself with the state manager
@@ -148,20 +219,62 @@ public:
   std::atomic<bool> any_parameter_changed{false};
   std::atomic<bool> preset_modified{true};
 
+  //--------------------------------------------------------------------------------
+  // every parameter and property change is also pushed to one of these, so the
+  // audio thread can apply it at the right sample (see AutomationEvents.h).
+  // changes made on the message thread go to automation_commands, with a
+  // timestamp. changes from any other thread (host automation, state loaded
+  // off the message thread) go to automation_events
+  //--------------------------------------------------------------------------------
+  AutomationEventQueue automation_events;
+  AutomationCommandQueue automation_commands;
+  // the values of the last set_parameters(), picked up by the audio thread when
+  // it reaches the PARAMETER_SET command that follows them
+  ParameterSetMailbox parameter_sets;
+
 private:
   void thread_safe_set_value_tree_property(juce::ValueTree tree, const juce::Identifier &name,
                                            const juce::var &new_value,
                                            juce::UndoManager *undo_manager_);
+  void push_automation_event(size_t param_id, float value, AutomationEvent::Type type);
+  // set while snap_parameter() makes its change, message thread only
+  bool snapping{false};
+  // set while set_parameters() makes its changes, which reach the audio thread
+  // as one PARAMETER_SET command instead, message thread only
+  bool applying_parameter_set{false};
+  void serialize_state(juce::MemoryBlock &dest_data);
   // state
-  juce::ValueTree state_tree;
+  // the latest snapshot, swapped under snapshot_lock (readers only copy the pointer)
+  std::shared_ptr<const StateSnapshot> state_snapshot;
+  juce::SpinLock snapshot_lock;
+  // only one thread rebuilds the snapshot at a time, others wait for its result
+  rt_safety::CheckedMutex<std::mutex> snapshot_rebuild_mutex;
+  // set by every edit, cleared when the snapshot is rebuilt
+  std::atomic<bool> state_dirty{true};
+  // value to text and back for the host and the editor, used by the parameters' lambdas
+  ParameterText parameter_text;
   std::unique_ptr<juce::AudioProcessorValueTreeState> param_tree_ptr;
   juce::ValueTree property_tree;
-  std::unordered_map<juce::String, std::atomic<float>> property_atomics;
-  std::unordered_map<juce::String, std::atomic<bool>> parameter_modified_flags;
+
+  // enum-indexed parameter store, read by param_value()
+  // one value per PARAM, parameters and properties alike. the listeners
+  // (parameterValueChanged, valueTreePropertyChanged) store each change here
+  // before anything else hears about it
+  alignas(64) std::array<std::atomic<float>, TOTAL_NUMBER_PARAMETERS> param_values{};
+  // maps parameter names back to PARAM enums, only used off the audio thread
+  std::unordered_map<juce::String, size_t> param_ids_by_name;
+  // maps host parameter indices back to PARAM enums
+  std::array<size_t, TOTAL_NUMBER_PARAMETERS> param_ids_by_host_index{};
+  // one bit per PARAM, set when the parameter changes
+  void mark_parameter_modified(size_t param_id);
+  static constexpr size_t MODIFIED_FLAG_WORDS = (TOTAL_NUMBER_PARAMETERS + 63) / 64;
+  alignas(64) std::array<std::atomic<std::uint64_t>, MODIFIED_FLAG_WORDS> parameter_modified_flags{};
   std::unordered_map<juce::Component *, std::function<void()>>
       param_to_callback[TOTAL_NUMBER_PARAMETERS] = {};
 
   juce::ValueTree preset_tree;
+  std::unique_ptr<PresetIndex> preset_index;
+  std::unique_ptr<PresetLoader> preset_loader;
 
   // random number generator for randomizing parameters
   juce::Random rng;
@@ -169,7 +282,10 @@ private:
   // Undo Manager
   juce::UndoManager undo_manager;
 
-  std::shared_mutex state_mutex; // protect all the value trees.
+  // protect all the value trees. never locked on the audio thread
+  // (reported as a violation in RT_SAFETY_CHECKS builds, see ../Util/RealtimeSafety.h)
+  using StateMutex = rt_safety::CheckedMutex<std::shared_mutex>;
+  StateMutex state_mutex;
 
   JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(StateManager)
 };
\ No newline at end of file
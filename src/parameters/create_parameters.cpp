@@ -16,6 +16,7 @@ struct Parameter {
   std::string name;
   std::string suffix;
   std::string tooltip;
+  std::string smoothing;
   std::vector<std::string> toStringArr;
 };
 
@@ -55,8 +56,8 @@ int main() {
       trim(token);
       tokens.push_back(token);
     }
-    // Pad with empty strings if fewer than 11 tokens.
-    if (tokens.size() < 11) tokens.resize(11, "");
+    // Pad with empty strings if fewer than 12 tokens.
+    if (tokens.size() < 12) tokens.resize(12, "");
 
     Parameter p;
     p.param = tokens[0];
@@ -69,9 +70,11 @@ int main() {
     p.name = tokens[7];
     p.suffix = tokens[8];
     p.tooltip = tokens[9];
+    // Smoothing time in seconds, empty means no smoothing.
+    p.smoothing = processFloatLiteral(tokens[10].empty() ? "0" : tokens[10]);
 
     // For the last field, split on whitespace.
-    std::istringstream arrStream(tokens[10]);
+    std::istringstream arrStream(tokens[11]);
     std::string arrToken;
     while (arrStream >> arrToken) {
       // Remove surrounding quotes if present.
@@ -89,7 +92,13 @@ int main() {
     return 1;
   }
 
-  headerFile << "#pragma once\n#include <juce_core/juce_core.h>\n";
+  // every table is a constexpr array of plain values with a single definition
+  // (inline constexpr), so including the header costs no static initialisation
+  // in any translation unit. the juce objects built from them are created on
+  // first use, see ParameterObjects.h
+  headerFile << "#pragma once\n"
+                "// generated from parameters.csv by create_parameters.cpp, don't edit\n"
+                "#include <array>\n#include <cstddef>\n#include <string_view>\n";
 
   // Write enum.
   headerFile << "enum PARAM {\n";
@@ -97,64 +106,82 @@ int main() {
     headerFile << "\t" << p.param << ",\n";
   headerFile << "\tTOTAL_NUMBER_PARAMETERS\n};\n";
 
-  // Write arrays.
-  headerFile << "static const std::array<juce::Identifier, PARAM::TOTAL_NUMBER_PARAMETERS> "
-                "PARAMETER_IDS{\n";
-  for (const auto &p : params)
-    headerFile << "\t\"" << p.param << "\",\n";
-  headerFile << "};\n";
-
-  headerFile
-      << "static const std::array<juce::String, PARAM::TOTAL_NUMBER_PARAMETERS> PARAMETER_NAMES{\n";
-  for (const auto &p : params)
-    headerFile << "\t\"" << p.param << "\",\n";
-  headerFile << "};\n";
+  // Write types.
+  headerFile << "// the arguments of juce::NormalisableRange<float>\n"
+                "struct ParameterRange {\n"
+                "\tfloat start;\n\tfloat end;\n\tfloat interval;\n\tfloat skew;\n};\n";
+  headerFile << "// the TO_STRING_ARR entries of one parameter, in PARAMETER_TO_STRING_VALUES\n"
+                "struct ParameterStringList {\n"
+                "\tconst std::string_view *first;\n"
+                "\tstd::size_t count;\n"
+                "\tconstexpr std::size_t size() const { return count; }\n"
+                "\tconstexpr bool empty() const { return count == 0; }\n"
+                "\tconstexpr const std::string_view &operator[](std::size_t i) const "
+                "{ return first[i]; }\n"
+                "\tconstexpr const std::string_view *begin() const { return first; }\n"
+                "\tconstexpr const std::string_view *end() const { return first + count; }\n"
+                "};\n";
 
-  headerFile << "static const std::array<juce::NormalisableRange<float>, "
-                "PARAM::TOTAL_NUMBER_PARAMETERS> PARAMETER_RANGES {\n";
+  // Write arrays.
+  auto writeStrings = [&](const char *name, std::string Parameter::*field) {
+    headerFile << "inline constexpr std::array<std::string_view, PARAM::TOTAL_NUMBER_PARAMETERS> "
+               << name << " {\n";
+    for (const auto &p : params)
+      headerFile << "\t\"" << p.*field << "\",\n";
+    headerFile << "};\n";
+  };
+  auto writeFloats = [&](const char *name, std::string Parameter::*field) {
+    headerFile << "inline constexpr std::array<float, PARAM::TOTAL_NUMBER_PARAMETERS> " << name
+               << " {\n";
+    for (const auto &p : params)
+      headerFile << "\t" << p.*field << ",\n";
+    headerFile << "};\n";
+  };
+
+  writeStrings("PARAMETER_NAMES", &Parameter::param);
+
+  headerFile << "inline constexpr std::array<ParameterRange, PARAM::TOTAL_NUMBER_PARAMETERS> "
+                "PARAMETER_RANGES {\n";
   for (const auto &p : params)
-    headerFile << "\tjuce::NormalisableRange<float>(" << p.min << ", " << p.max << ", " << p.grain
-               << ", " << p.exp << "),\n";
+    headerFile << "\tParameterRange{" << p.min << ", " << p.max << ", " << p.grain << ", " << p.exp
+               << "},\n";
   headerFile << "};\n";
 
-  headerFile
-      << "static const std::array<float, PARAM::TOTAL_NUMBER_PARAMETERS> PARAMETER_DEFAULTS {\n";
-  for (const auto &p : params)
-    headerFile << "\t" << p.defaultVal << ",\n";
-  headerFile << "};\n";
+  writeFloats("PARAMETER_DEFAULTS", &Parameter::defaultVal);
 
-  headerFile
-      << "static const std::array<bool, PARAM::TOTAL_NUMBER_PARAMETERS> PARAMETER_AUTOMATABLE {\n";
+  headerFile << "inline constexpr std::array<bool, PARAM::TOTAL_NUMBER_PARAMETERS> "
+                "PARAMETER_AUTOMATABLE {\n";
   for (const auto &p : params)
     headerFile << "\t" << (p.automatable == "1" ? "true" : "false") << ",\n";
   headerFile << "};\n";
 
-  headerFile << "static const std::array<juce::String, PARAM::TOTAL_NUMBER_PARAMETERS> "
-                "PARAMETER_NICKNAMES{\n";
-  for (const auto &p : params)
-    headerFile << "\t\"" << p.name << "\",\n";
-  headerFile << "};\n";
+  writeStrings("PARAMETER_NICKNAMES", &Parameter::name);
+  writeStrings("PARAMETER_SUFFIXES", &Parameter::suffix);
+  writeStrings("PARAMETER_TOOLTIPS", &Parameter::tooltip);
+  writeFloats("PARAMETER_SMOOTHING", &Parameter::smoothing);
 
-  headerFile << "static const std::array<juce::String, PARAM::TOTAL_NUMBER_PARAMETERS> "
-                "PARAMETER_SUFFIXES {\n";
+  // all TO_STRING_ARR entries in one array, and each parameter's slice of it
+  size_t numStrings = 0;
   for (const auto &p : params)
-    headerFile << "\t\"" << p.suffix << "\",\n";
-  headerFile << "};\n";
-
-  headerFile << "static const std::array<juce::String, PARAM::TOTAL_NUMBER_PARAMETERS> "
-                "PARAMETER_TOOLTIPS {\n";
+    numStrings += p.toStringArr.size();
+  headerFile << "inline constexpr std::array<std::string_view, " << numStrings
+             << "> PARAMETER_TO_STRING_VALUES {\n";
   for (const auto &p : params)
-    headerFile << "\t\"" << p.tooltip << "\",\n";
+    for (const auto &s : p.toStringArr)
+      headerFile << "\t\"" << s << "\",\n";
   headerFile << "};\n";
 
-  headerFile
-      << "static const std::array<std::vector<juce::String>, PARAM::TOTAL_NUMBER_PARAMETERS> "
-         "PARAMETER_TO_STRING_ARRS {\n";
+  headerFile << "inline constexpr std::array<ParameterStringList, PARAM::TOTAL_NUMBER_PARAMETERS> "
+                "PARAMETER_TO_STRING_ARRS {\n";
+  size_t first = 0;
   for (const auto &p : params) {
-    headerFile << "\tstd::vector<juce::String>{";
-    for (const auto &s : p.toStringArr)
-      headerFile << "\"" << s << "\", ";
-    headerFile << "},\n";
+    if (p.toStringArr.empty()) {
+      headerFile << "\tParameterStringList{nullptr, 0},\n";
+    } else {
+      headerFile << "\tParameterStringList{PARAMETER_TO_STRING_VALUES.data() + " << first << ", "
+                 << p.toStringArr.size() << "},\n";
+    }
+    first += p.toStringArr.size();
   }
   headerFile << "};\n";
 
@@ -1,8 +1,11 @@
 // Nathan Blair January 2023
 
 #include "PluginEditor.h"
+#include "../interface/LevelMeterDisplay.h"
+#include "../interface/LoadMeterDisplay.h"
 #include "../interface/ParameterSlider.h"
 #include "../parameters/StateManager.h"
+#include "../Util/RealtimeSafety.h"
 
 //==============================================================================
 AudioPluginAudioProcessorEditor::AudioPluginAudioProcessorEditor(PluginProcessor &p)
@@ -12,6 +15,16 @@ AudioPluginAudioProcessorEditor::AudioPluginAudioProcessorEditor(PluginProcessor
   // add slider BEFORE setting size
   gain_slider = std::make_unique<ParameterSlider>(state, PARAM::GAIN);
   addAndMakeVisible(*gain_slider);
+  oversampling_slider = std::make_unique<ParameterSlider>(state, PARAM::OVERSAMPLING);
+  addAndMakeVisible(*oversampling_slider);
+  oversampling_quality_slider =
+      std::make_unique<ParameterSlider>(state, PARAM::OVERSAMPLING_QUALITY);
+  addAndMakeVisible(*oversampling_quality_slider);
+
+  load_meter_display = std::make_unique<LoadMeterDisplay>(*processorRef.load_meter);
+  addAndMakeVisible(*load_meter_display);
+  level_meter_display = std::make_unique<LevelMeterDisplay>(*processorRef.audio_meter);
+  addAndMakeVisible(*level_meter_display);
 
   // some settings about UI
   setOpaque(true);
@@ -48,19 +61,30 @@ void AudioPluginAudioProcessorEditor::resized() {
   int slider_x = proportionOfWidth(0.5f) - (slider_size / 2);
   int slider_y = proportionOfHeight(0.5f) - (slider_size / 2);
   gain_slider->setBounds(slider_x, slider_y, slider_size, slider_size);
+  oversampling_slider->setBounds(slider_x - 2 * slider_size, slider_y, slider_size, slider_size);
+  oversampling_quality_slider->setBounds(slider_x + 2 * slider_size, slider_y, slider_size,
+                                         slider_size);
+  load_meter_display->setBounds(getLocalBounds().removeFromBottom(proportionOfHeight(0.08f)).reduced(4));
+  level_meter_display->setBounds(getLocalBounds().removeFromTop(proportionOfHeight(0.25f)).reduced(4));
 }
 
 void AudioPluginAudioProcessorEditor::windowReadyToPaint() {
   // repaint UI and note that we have updated ui, if parameter values have
   // changed
+  // only the parameters that actually changed are visited
   if (state->any_parameter_changed.exchange(false)) {
-    for (size_t param_id{0}; param_id < TOTAL_NUMBER_PARAMETERS; ++param_id) {
-      if (state->get_parameter_modified(param_id)) {
-        for (const auto &[component, callback_fn] : state->get_callbacks(param_id))
-          callback_fn();
-      }
-    }
+    state->for_each_modified_parameter([this](size_t param_id) {
+      for (const auto &[component, callback_fn] : state->get_callbacks(param_id))
+        callback_fn();
+    });
   }
 
   state->update_preset_modified();
+
+  load_meter_display->update();
+  // drains the output meter, and repaints only the meters that moved a pixel
+  level_meter_display->update();
+
+  // print any allocations or locks caught on the audio thread (RT_SAFETY_CHECKS builds only)
+  rt_safety::dump_violations();
 }
\ No newline at end of file
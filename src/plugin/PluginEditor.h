@@ -4,6 +4,8 @@
 
 class StateManager;
 class ParameterSlider;
+class LoadMeterDisplay;
+class LevelMeterDisplay;
 
 #include "PluginProcessor.h"
 
@@ -46,6 +48,13 @@ private:
 
   // A single slider
   std::unique_ptr<ParameterSlider> gain_slider;
+  std::unique_ptr<ParameterSlider> oversampling_slider;
+  std::unique_ptr<ParameterSlider> oversampling_quality_slider;
+
+  // DSP load readout, timing is only measured while the editor is open
+  std::unique_ptr<LoadMeterDisplay> load_meter_display;
+  // output levels and waveform, metering is only done while the editor is open
+  std::unique_ptr<LevelMeterDisplay> level_meter_display;
 
   // VBlank Attachment for handling state before repainting
   std::unique_ptr<juce::VBlankAttachment> repaint_callback_handler;
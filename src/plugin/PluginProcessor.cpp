@@ -1,15 +1,41 @@
 // Nathan Blair June 2023
 
 #include "PluginProcessor.h"
+#include "../audio/AudioMeter.h"
+#include "../audio/ChannelGroupPool.h"
+#include "../audio/DspLoadMeter.h"
 #include "../audio/Gain.h"
+#include "../audio/Oversampler.h"
+#include "../audio/ProcessorChain.h"
+#include "../audio/SilenceKernels.h"
+#include "../parameters/AutomationEvents.h"
+#include "../parameters/SmoothedParameterBank.h"
 #include "../parameters/StateManager.h"
+#include "../Util/RealtimeSafety.h"
 #include "PluginEditor.h"
 
 //==============================================================================
-PluginProcessor::PluginProcessor() { state = std::make_unique<StateManager>(this); }
+PluginProcessor::PluginProcessor() {
+  state = std::make_unique<StateManager>(this);
+  automation = std::make_unique<BlockAutomation>();
+  smoothed_params = std::make_unique<SmoothedParameterBank>();
+  load_meter = std::make_unique<DspLoadMeter>();
+  audio_meter = std::make_unique<AudioMeter>();
+  channel_groups = std::make_unique<ChannelGroupPool>();
+  // gain goes from 0 to 100 (see: ../parameters/parameters.csv)
+  // so we scale it to 0 to 1
+  // the chains are created once here rather than in prepareToPlay, where they
+  // could be swapped out from under the audio thread
+  float_path.chain = std::make_unique<HostRateChain<float>>(Gain<float>(0.01f));
+  float_path.oversampler = std::make_unique<Oversampler<float>>();
+  double_path.chain = std::make_unique<HostRateChain<double>>(Gain<double>(0.01f));
+  double_path.oversampler = std::make_unique<Oversampler<double>>();
+  startTimerHz(HOST_DISPLAY_POLL_HZ);
+}
 
 PluginProcessor::~PluginProcessor() {
   // stop any threads, delete any raw pointers, remove any listeners, etc
+  stopTimer();
 }
 
 //==============================================================================
@@ -18,26 +44,79 @@ void PluginProcessor::prepareToPlay(double sampleRate, int samplesPerBlock) {
   // Use this to allocate up any resources you need, and to reset any
   // variables that depend on sample rate or block size
 
-  gain = std::make_unique<Gain>(float(sampleRate), samplesPerBlock, getTotalNumOutputChannels(),
-                                PARAMETER_DEFAULTS[PARAM::GAIN] / 100.0f);
+  // sub-blocks never exceed samplesPerBlock, so the smoothing ramps fit
+  automation->prepare(sampleRate, MIN_SUB_BLOCK_SIZE, samplesPerBlock);
+  smoothed_params->prepare(sampleRate, samplesPerBlock);
+  load_meter->prepare(sampleRate);
+  audio_meter->prepare(sampleRate);
+  const int numChannels = std::max(getTotalNumInputChannels(), getTotalNumOutputChannels());
+  // the host picks the precision before calling prepareToPlay, and only the
+  // matching processBlock gets called until the next one
+  if (isUsingDoublePrecision())
+    prepare_path(double_path, sampleRate, samplesPerBlock, numChannels);
+  else
+    prepare_path(float_path, sampleRate, samplesPerBlock, numChannels);
+  // one worker per channel group after the first, which the audio thread takes.
+  // stereo (one group) starts no threads
+  const int numGroups = (numChannels + CHANNELS_PER_GROUP - 1) / CHANNELS_PER_GROUP;
+  channel_groups->prepare(std::min(numGroups - 1, juce::SystemStats::getNumCpus() - 1),
+                          samplesPerBlock, sampleRate);
+  setLatencySamples(latency_samples.load());
+  silent_samples = 0;
+  skipping = false;
   should_snap_smoothed_params.store(true);
 }
 
+template <typename SampleType>
+void PluginProcessor::prepare_path(DspPath<SampleType> &path, double sampleRate,
+                                   int samplesPerBlock, int numChannels) {
+  path.chain->prepare(sampleRate, samplesPerBlock, numChannels);
+  // sized for 8x at the highest quality, so changing either never allocates
+  path.oversampler->prepare(samplesPerBlock, numChannels);
+  path.oversampler->configure(int(state->param_value(PARAM::OVERSAMPLING)),
+                              typename Oversampler<SampleType>::Quality(
+                                  int(state->param_value(PARAM::OVERSAMPLING_QUALITY))));
+  latency_samples.store(juce::roundToInt(path.oversampler->get_latency()));
+  tail_samples.store(path.oversampler->get_tail_samples());
+}
+
 void PluginProcessor::processBlock(juce::AudioBuffer<float> &buffer,
                                    juce::MidiBuffer &midiMessages) {
+  process_block(float_path, buffer, midiMessages);
+}
+
+void PluginProcessor::processBlock(juce::AudioBuffer<double> &buffer,
+                                   juce::MidiBuffer &midiMessages) {
+  process_block(double_path, buffer, midiMessages);
+}
+
+template <typename SampleType>
+void PluginProcessor::process_block(DspPath<SampleType> &path,
+                                    juce::AudioBuffer<SampleType> &buffer,
+                                    juce::MidiBuffer &midiMessages) {
   juce::ScopedNoDenormals noDenormals;
+  // no allocations or locks from here on (checked in RT_SAFETY_CHECKS builds)
+  rt_safety::ScopedAudioThread audio_thread_scope;
 
   // get audio buffer references outside of JUCE, so we can pass to non-juce processors
-  float *const *bufferPtrs = buffer.getArrayOfWritePointers();
+  SampleType *const *bufferPtrs = buffer.getArrayOfWritePointers();
   const int numSamples = buffer.getNumSamples();
   const int numChannels = buffer.getNumChannels();
+  // the processors for this sample type
+  auto &chain = *path.chain;
+  auto &oversampler = *path.oversampler;
 
-  //--------------------------------------------------------------------------------
-  // read in some parameter values here, if you want
-  // in this case, gain goes from 0 to 100 (see: ../parameters/parameters.csv)
-  // so we normalize it to 0 to 1
-  //--------------------------------------------------------------------------------
-  auto requested_gain = state->param_value(PARAM::GAIN) / 100.0f;
+  // times each stage below, when the load meter is enabled (see ../audio/DspLoadMeter.h)
+  DspLoadMeter::BlockTimer timer(*load_meter, numSamples);
+
+  // clear the tails, asked for by reset()
+  if (should_reset_processors.exchange(false)) {
+    // both precisions, the host may switch before the next prepareToPlay
+    float_path.chain->reset();
+    float_path.oversampler->reset();
+    double_path.chain->reset();
+    double_path.oversampler->reset();
+  }
 
   //--------
   // Tell all of our processors to force their parameters to update
@@ -46,17 +125,101 @@ void PluginProcessor::processBlock(juce::AudioBuffer<float> &buffer,
   // render this should also get called when the plugin needs to clear tails, in reset()
   //----
   if (should_snap_smoothed_params.exchange(false)) {
+    // jump to the current state, dropping any pending automation
+    automation->reset(*state);
     // force state, to end any internal smoothing
-    gain->setState(state->param_value(PARAM::GAIN) / 100.0f);
+    smoothed_params->snap(*automation);
+  } else {
+    // collect the parameter changes since the last block, with their sample offsets
+    automation->begin_block(*state, numSamples);
+  }
+  // the oversampling factor and quality only change between blocks.
+  // a change clears the filters and changes the latency and the tail, which the
+  // host has to hear about from the message thread
+  if (oversampler.configure(int(automation->value(PARAM::OVERSAMPLING)),
+                            typename Oversampler<SampleType>::Quality(
+                                int(automation->value(PARAM::OVERSAMPLING_QUALITY))))) {
+    latency_samples.store(juce::roundToInt(oversampler.get_latency()));
+    tail_samples.store(oversampler.get_tail_samples());
+    host_display_changed.store(true, std::memory_order_release);
   }
 
+  //--------------------------------------------------------------------------------
+  // skip the dsp while the input is silent and the tails of the last sound
+  // have played out. a synth has no input to go by, so it never skips.
+  // the first block with signal is processed in full, from a reset state, which
+  // is what the processors would have decayed to: the output is the same as if
+  // nothing was skipped, to within SILENCE_THRESHOLD
+  //--------------------------------------------------------------------------------
+  const int numInputChannels = std::min(getTotalNumInputChannels(), numChannels);
+  bool input_silent = !JucePlugin_IsSynth && numInputChannels > 0;
+  const auto &silence = silence_kernels::best<SampleType>();
+  for (int ch = 0; input_silent && ch < numInputChannels; ++ch)
+    input_silent = silence.is_silent(bufferPtrs[ch], SampleType(SILENCE_THRESHOLD), numSamples);
+  const bool skip = input_silent && silent_samples >= tail_samples.load(std::memory_order_relaxed);
+  silent_samples = input_silent ? std::min(silent_samples + numSamples, 1 << 30) : 0;
+  if (skip && !skipping) {
+    chain.reset();
+    oversampler.reset();
+  }
+  skipping = skip;
+  timer.lap(DspLoadMeter::AUTOMATION);
+
   //--------------------------------------------------------------------------------
   // process samples below.
   // for an audio effect, buffer is filled with input samples, and you should fill it with output
   // samples for a synth, buffer is filled with zeros, and you should fill it with output samples
   // see: https://docs.juce.com/master/classAudioBuffer.html
+  //
+  // the block is split wherever a parameter changes, so read parameter values
+  // inside the sub-block from smoothed_params (or automation->value() for
+  // unsmoothed parameters), not from state->param_value().
+  // with no changes, this is one call over the whole block
   //--------------------------------------------------------------------------------
-  gain->process(bufferPtrs, numSamples, numChannels, requested_gain);
+  automation->process_sub_blocks(numSamples, [&](int start, int length) {
+    // fill the smoothing ramps for this sub-block
+    smoothed_params->process(*automation, length);
+    timer.lap(DspLoadMeter::SMOOTHING);
+    // the smoothing keeps running while skipping, so the ramps are in the
+    // right place when the signal comes back
+    if (skip)
+      return;
+
+    // set each stage's parameters for this sub-block, then run them all in one pass
+    chain.template get<Gain<SampleType>>().set_block(smoothed_params->ramp(PARAM::GAIN),
+                                                     smoothed_params->value(PARAM::GAIN));
+    chain.begin_block(numChannels, length);
+
+    // everything below only touches its own channels, so each group of channels
+    // can run on a different thread. the split depends only on the block size and
+    // channel count, and the result is the same on any number of threads
+    const int numGroups = (numChannels + CHANNELS_PER_GROUP - 1) / CHANNELS_PER_GROUP;
+    const bool parallel = parallel_channel_groups.load(std::memory_order_relaxed) &&
+                          length * numChannels >= MIN_PARALLEL_SAMPLES;
+    channel_groups->run(numGroups, parallel, [&](int group) {
+      const int first = group * CHANNELS_PER_GROUP;
+      const int count = std::min(CHANNELS_PER_GROUP, numChannels - first);
+      chain.process_channels(bufferPtrs, start, length, first, count);
+
+      // anything nonlinear (saturation, distortion...) aliases at the host rate,
+      // so it goes in here, at oversampler.get_factor() times the sample rate
+      oversampler.process_channels(bufferPtrs, start, length, first, count,
+                                   [&](SampleType *const *oversampled, int oversampledLength) {
+                                     juce::ignoreUnused(oversampled, oversampledLength);
+                                   });
+    });
+    timer.lap(DspLoadMeter::CHANNELS);
+  });
+  if (skip) {
+    buffer.clear();
+    timer.set_skipped();
+  }
+  // levels and waveform of the output for the editor, only while it shows them
+  if (skip)
+    audio_meter->process_silence(numChannels, numSamples);
+  else
+    audio_meter->process(bufferPtrs, numChannels, numSamples);
+  timer.lap(DspLoadMeter::METERING);
   //--------------------------------------------------------------------------------
   // you can use midiMessages to read midi if you need.
   // since we are not using midi yet, we clear the buffer.
@@ -69,6 +232,19 @@ void PluginProcessor::reset() {
 
   // cutoff smooth here – smoothed params are kinda like tails
   should_snap_smoothed_params.store(true);
+  // the host can call this from any thread, while processBlock runs, so the
+  // filters are cleared by the audio thread at the start of the next block
+  should_reset_processors.store(true);
+}
+
+void PluginProcessor::audioWorkgroupContextChanged(const juce::AudioWorkgroup &workgroup) {
+  channel_groups->set_workgroup(workgroup);
+}
+
+//==============================================================================
+double PluginProcessor::getTailLengthSeconds() const {
+  const double sampleRate = getSampleRate();
+  return sampleRate > 0.0 ? double(tail_samples.load()) / sampleRate : 0.0;
 }
 
 //==============================================================================
@@ -78,9 +254,8 @@ void PluginProcessor::getStateInformation(juce::MemoryBlock &destData) {
   // as intermediaries to make it easy to save and load complex data.
 
   // We will just store our parameter state, for now
-  auto plugin_state = state->get_state();
-  std::unique_ptr<juce::XmlElement> xml(plugin_state.createXml());
-  copyXmlToBinary(*xml, destData);
+  // in the compact binary format (see: ../parameters/StateFormat.h)
+  state->write_state(destData);
 }
 
 void PluginProcessor::setStateInformation(const void *data, int sizeInBytes) {
@@ -88,13 +263,27 @@ void PluginProcessor::setStateInformation(const void *data, int sizeInBytes) {
   // whose contents will have been created by the getStateInformation() call.
 
   // Restore our parameters from file
-  std::unique_ptr<juce::XmlElement> xmlState(getXmlFromBinary(data, sizeInBytes));
-  state->load_from(xmlState.get());
+  // older sessions saved XML, load_from detects which format this is
+  state->load_from(data, size_t(std::max(sizeInBytes, 0)));
 
   // this is like a plugin state starting point. no need to smooth to it
   should_snap_smoothed_params.store(true);
 }
 
+void PluginProcessor::timerCallback() {
+  // the oversampling factor or quality changed on the audio thread
+  if (!host_display_changed.exchange(false, std::memory_order_acquire))
+    return;
+  const int latency = latency_samples.load();
+  if (latency != getLatencySamples()) {
+    // tells the host, which reads getTailLengthSeconds() again too
+    setLatencySamples(latency);
+  } else {
+    // only the tail changed, which setLatencySamples() would not report
+    updateHostDisplay(ChangeDetails().withLatencyChanged(true));
+  }
+}
+
 juce::AudioProcessorEditor *PluginProcessor::createEditor() {
   return new AudioPluginAudioProcessorEditor(*this);
 }
@@ -3,7 +3,14 @@
 #pragma once
 
 class StateManager;
-class Gain;
+template <typename SampleType> class Gain;
+template <typename... Stages> class ProcessorChain;
+class BlockAutomation;
+class SmoothedParameterBank;
+class DspLoadMeter;
+class AudioMeter;
+template <typename SampleType> class Oversampler;
+class ChannelGroupPool;
 
 #include <juce_audio_basics/juce_audio_basics.h>
 
@@ -11,7 +18,7 @@ class Gain;
 #include <atomic>
 
 //==============================================================================
-class PluginProcessor : public PluginProcessorBase {
+class PluginProcessor : public PluginProcessorBase, private juce::Timer {
 public:
   //==============================================================================
   PluginProcessor();
@@ -19,7 +26,14 @@ public:
   //==============================================================================
   void prepareToPlay(double sampleRate, int samplesPerBlock) override;
   void processBlock(juce::AudioBuffer<float> &, juce::MidiBuffer &) override;
+  // hosts with a 64-bit mix engine call this one, with no conversion to float
+  void processBlock(juce::AudioBuffer<double> &, juce::MidiBuffer &) override;
+  bool supportsDoublePrecisionProcessing() const override { return true; }
   void reset() override;
+  // the channel group workers join the host's audio workgroup
+  void audioWorkgroupContextChanged(const juce::AudioWorkgroup &workgroup) override;
+  // the tail of the active processors (the oversampling filters)
+  double getTailLengthSeconds() const override;
   //==============================================================================
   void getStateInformation(juce::MemoryBlock &destData) override;
   void setStateInformation(const void *data, int sizeInBytes) override;
@@ -29,11 +43,73 @@ public:
   // state
   //==============================================================================
   std::unique_ptr<StateManager> state;
+  // per-stage timing of processBlock, shown in the editor
+  std::unique_ptr<DspLoadMeter> load_meter;
+  // output levels and waveform, shown in the editor
+  std::unique_ptr<AudioMeter> audio_meter;
+  // wide layouts process groups of channels on worker threads, set false to
+  // keep everything on the audio thread
+  std::atomic<bool> parallel_channel_groups{true};
 
 private:
-  std::unique_ptr<Gain> gain;
+  // the stages that run at the host rate, fused into one pass per channel
+  // add stages here, and set their block parameters in processBlock
+  template <typename SampleType> using HostRateChain = ProcessorChain<Gain<SampleType>>;
+
+  // the processors that hold samples, once per sample type. only the one for
+  // getProcessingPrecision() is prepared
+  template <typename SampleType> struct DspPath {
+    std::unique_ptr<HostRateChain<SampleType>> chain;
+    // runs the nonlinear stages at a higher rate, set by the OVERSAMPLING properties
+    std::unique_ptr<Oversampler<SampleType>> oversampler;
+  };
+  DspPath<float> float_path;
+  DspPath<double> double_path;
+  template <typename SampleType>
+  void prepare_path(DspPath<SampleType> &path, double sampleRate, int samplesPerBlock,
+                    int numChannels);
+  // both processBlock overloads run this
+  template <typename SampleType>
+  void process_block(DspPath<SampleType> &path, juce::AudioBuffer<SampleType> &buffer,
+                     juce::MidiBuffer &midiMessages);
+
+  // sample accurate parameter changes, see ../parameters/AutomationEvents.h
+  std::unique_ptr<BlockAutomation> automation;
+  // blocks are never split into sub-blocks shorter than this
+  static constexpr int MIN_SUB_BLOCK_SIZE = 16;
+
+  // ramps for every parameter with a SMOOTHING time in parameters.csv
+  std::unique_ptr<SmoothedParameterBank> smoothed_params;
 
   std::atomic<bool> should_snap_smoothed_params{true};
+  // set by reset(), the audio thread then clears the chains and oversamplers
+  std::atomic<bool> should_reset_processors{false};
+
+  // the oversampler's latency, passed on to the host from the message thread
+  std::atomic<int> latency_samples{0};
+  // set by the audio thread when the latency or the tail changed, and polled by
+  // the timer, which tells the host. the audio thread only stores a flag
+  std::atomic<bool> host_display_changed{false};
+  static constexpr int HOST_DISPLAY_POLL_HZ = 20;
+  void timerCallback() override;
+
+  // the chain and the oversampler run on groups of CHANNELS_PER_GROUP channels,
+  // in parallel when the block has at least MIN_PARALLEL_SAMPLES samples in total
+  // (numSamples * numChannels). smaller blocks cost more to hand out than they save,
+  // and run on the audio thread
+  std::unique_ptr<ChannelGroupPool> channel_groups;
+  static constexpr int CHANNELS_PER_GROUP = 4;
+  static constexpr int MIN_PARALLEL_SAMPLES = 4096;
+
+  // the dsp is skipped while the input is silent (no sample above
+  // SILENCE_THRESHOLD, -160 dB) and the tails of the last sound have played out
+  static constexpr float SILENCE_THRESHOLD = 1.0e-8f;
+  // how long the output keeps ringing after the input goes silent
+  std::atomic<int> tail_samples{0};
+  // audio thread only: silent input samples since the last sound, and whether
+  // the last block was skipped
+  int silent_samples{0};
+  bool skipping{false};
 
   //==============================================================================
   JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(PluginProcessor)
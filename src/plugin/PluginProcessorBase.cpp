@@ -83,11 +83,10 @@ bool PluginProcessorBase::isBusesLayoutSupported(const BusesLayout &layouts) con
   return true;
 #else
   // This is the place where you check if the layout is supported.
-  // In this template code we only support mono or stereo.
+  // The processing is per channel, so any layout up to MAX_CHANNELS works.
   // Some plugin hosts, such as certain GarageBand versions, will only
-  // load plugins that support stereo bus layouts.
-  if (layouts.getMainOutputChannelSet() != juce::AudioChannelSet::mono() &&
-      layouts.getMainOutputChannelSet() != juce::AudioChannelSet::stereo())
+  // load plugins that support stereo bus layouts, which is still the default.
+  if (!isChannelSetSupported(layouts.getMainOutputChannelSet()))
     return false;
 
   // This checks if the input layout matches the output layout
@@ -117,6 +116,24 @@ bool PluginProcessorBase::isBusesLayoutSupported(const BusesLayout &layouts) con
 #endif
 }
 
+bool PluginProcessorBase::isChannelSetSupported(const juce::AudioChannelSet &set) {
+  if (set.isDisabled() || set.size() > MAX_CHANNELS)
+    return false;
+  if (set == juce::AudioChannelSet::mono() || set == juce::AudioChannelSet::stereo())
+    return true;
+  // ambisonics: complete orders only, (order + 1)^2 channels. a set with
+  // ambisonic channels that is not a full order (mixed or partial orders) is
+  // not supported
+  const int order = set.getAmbisonicOrder();
+  if (order >= 0)
+    return order <= MAX_AMBISONIC_ORDER && set.size() == (order + 1) * (order + 1);
+  if (set.getChannelIndexForType(juce::AudioChannelSet::ambisonicACN0) >= 0)
+    return false;
+  // the named surround and immersive layouts, and plain discrete channels
+  return set.isDiscreteLayout() ||
+         juce::AudioChannelSet::channelSetsWithNumberOfChannels(set.size()).contains(set);
+}
+
 //==============================================================================
 bool PluginProcessorBase::hasEditor() const {
   return true; // (change this to false if you choose to not supply an editor)
@@ -31,5 +31,12 @@ public:
   const juce::String getProgramName(int index) override;
   void changeProgramName(int index, const juce::String &newName) override;
   //==============================================================================
+  // widest bus the plugin accepts: 64 channels is 7th order ambisonics
+  static constexpr int MAX_CHANNELS = 64;
+  static constexpr int MAX_AMBISONIC_ORDER = 7;
+  // mono, stereo, any surround or immersive layout (5.1, 7.1.4, 9.1.6...),
+  // ambisonics up to 7th order, or up to MAX_CHANNELS discrete channels
+  static bool isChannelSetSupported(const juce::AudioChannelSet &set);
+  //==============================================================================
 private:
 };
\ No newline at end of file